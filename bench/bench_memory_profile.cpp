@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Throughput and peak RSS of the default vs. low-memory profile: MD5 verification of a
+// .tar.md5 followed by a flash of its payload to in-memory Odin devices.
+//
+//   bench_memory_profile [--size-mib N] [--devices N] [--usb-mbps N] [--profile default|low|both]
+//
+// Each profile runs in a forked child so ru_maxrss is per profile.
+
+#include "app/engine.hpp"
+#include "app/md5_verify.hpp"
+#include "fake_odin.hpp"
+#include "protocol/odin/flash.hpp"
+#include "protocol/odin/group_flasher.hpp"
+#include "third_party/md5/md5.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+struct Args {
+  std::uint64_t size_mib = 256;
+  std::size_t devices = 1;
+  std::uint64_t usb_mbps = 0;
+  std::string profile = "both";
+};
+
+void ustar_header(char (&h)[512], const std::string& name, std::uint64_t size) {
+  std::memset(h, 0, sizeof(h));
+  std::snprintf(h, 100, "%s", name.c_str());
+  std::snprintf(h + 100, 8, "%07o", 0644u);
+  std::snprintf(h + 108, 8, "%07o", 0u);
+  std::snprintf(h + 116, 8, "%07o", 0u);
+  std::snprintf(h + 124, 12, "%011llo", static_cast<unsigned long long>(size));
+  std::snprintf(h + 136, 12, "%011o", 0u);
+  h[156] = '0';
+  std::memcpy(h + 257, "ustar", 6);
+  std::memcpy(h + 263, "00", 2);
+
+  std::memset(h + 148, ' ', 8);
+  unsigned sum = 0;
+  for (unsigned char c : h) sum += c;
+  std::snprintf(h + 148, 8, "%06o", sum);
+  h[155] = ' ';
+}
+
+// AP.tar.md5 holding one pseudo-random system.img.
+bool write_package(const fs::path& out, std::uint64_t size) {
+  std::ofstream f(out, std::ios::binary | std::ios::trunc);
+  if (!f) return false;
+
+  MD5_CTX md5;
+  md5_init(&md5);
+  auto put = [&](const void* p, std::size_t n) {
+    f.write(static_cast<const char*>(p), static_cast<std::streamsize>(n));
+    md5_update(&md5, static_cast<const MD5_BYTE*>(p), n);
+  };
+
+  char h[512];
+  ustar_header(h, "system.img", size);
+  put(h, sizeof(h));
+
+  std::vector<std::uint32_t> chunk(1u << 18);
+  std::uint32_t x = 0x12345678u;
+  for (std::uint64_t left = size; left;) {
+    for (auto& w : chunk) {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      w = x;
+    }
+    const auto n = static_cast<std::size_t>(std::min<std::uint64_t>(left, chunk.size() * 4));
+    put(chunk.data(), n);
+    left -= n;
+  }
+
+  std::vector<char> pad((512 - size % 512) % 512 + 1024, 0);
+  put(pad.data(), pad.size());
+
+  MD5_BYTE digest[16];
+  md5_final(&md5, digest);
+  char hex[33];
+  for (int i = 0; i < 16; ++i) std::snprintf(hex + i * 2, 3, "%02x", digest[i]);
+  f << hex << "  AP.tar\n";
+  return static_cast<bool>(f);
+}
+
+double mib_per_s(std::uint64_t bytes, Clock::duration d) {
+  const double s = std::chrono::duration<double>(d).count();
+  return s > 0 ? (static_cast<double>(bytes) / (1024.0 * 1024.0)) / s : 0.0;
+}
+
+int run_profile(const Args& a, brokkr::app::MemoryProfile profile, const fs::path& pkg) {
+  const char* name = profile == brokkr::app::MemoryProfile::Low ? "low" : "default";
+  brokkr::app::init_memory_profile(profile);
+
+  // A private MD5/XXH3 cache per run, so both profiles hash the full MD5.
+  const fs::path cache = pkg.parent_path() / name;
+  ::setenv("XDG_CACHE_HOME", cache.c_str(), 1);
+
+  brokkr::odin::Ui ui;
+
+  auto jobs = brokkr::app::md5_jobs({pkg});
+  if (!jobs) return std::fprintf(stderr, "md5_jobs: %s\n", jobs.error().c_str()), 1;
+  const auto t0 = Clock::now();
+  if (auto st = brokkr::app::md5_verify(*jobs, ui, brokkr::app::hash_limits(profile)); !st)
+    return std::fprintf(stderr, "md5_verify: %s\n", st.error().c_str()), 1;
+  const auto t_hash = Clock::now() - t0;
+
+  auto specs = brokkr::odin::expand_inputs_tar_or_raw({pkg});
+  if (!specs) return std::fprintf(stderr, "expand: %s\n", specs.error().c_str()), 1;
+
+  const auto pit = brokkr::testing::make_pit("BENCH", {{.id = 1, .name = "SYSTEM", .file_name = "system.img"}});
+  std::vector<std::unique_ptr<brokkr::testing::FakeOdin>> fakes;
+  std::vector<brokkr::odin::Target> targets;
+  std::vector<brokkr::odin::Target*> ptrs;
+  targets.reserve(a.devices);
+  for (std::size_t i = 0; i < a.devices; ++i) {
+    fakes.push_back(std::make_unique<brokkr::testing::FakeOdin>(pit));
+    fakes.back()->usb_bytes_per_sec = a.usb_mbps * 1024 * 1024;
+    targets.push_back(brokkr::odin::Target{.id = "fake" + std::to_string(i), .link = fakes.back().get()});
+    ptrs.push_back(&targets.back());
+  }
+
+  brokkr::odin::Cfg cfg;
+  cfg.reboot_after = false;
+  brokkr::app::apply_memory_profile(profile, cfg);
+
+  const auto t1 = Clock::now();
+  if (auto st = brokkr::odin::flash(ptrs, *specs, nullptr, cfg, ui); !st)
+    return std::fprintf(stderr, "flash: %s\n", st.error().c_str()), 1;
+  const auto t_flash = Clock::now() - t1;
+
+  const std::uint64_t bytes = a.size_mib * 1024 * 1024;
+  for (const auto& f : fakes)
+    if (f->data_bytes < bytes) return std::fprintf(stderr, "flash: device saw %llu bytes\n",
+                                                   static_cast<unsigned long long>(f->data_bytes)), 1;
+  std::printf("%-8s hash %8.1f MiB/s   flash %8.1f MiB/s", name, mib_per_s(bytes, t_hash), mib_per_s(bytes, t_flash));
+  std::fflush(stdout);
+  return 0;
+}
+
+int fork_profile(const Args& a, brokkr::app::MemoryProfile profile, const fs::path& pkg) {
+  std::fflush(stdout);
+  const pid_t pid = ::fork();
+  if (pid < 0) return 1;
+  if (pid == 0) std::_Exit(run_profile(a, profile, pkg));
+
+  int status = 0;
+  rusage ru{};
+  if (::wait4(pid, &status, 0, &ru) < 0 || !WIFEXITED(status) || WEXITSTATUS(status)) {
+    std::printf("\n");
+    return 1;
+  }
+  std::printf("   peak RSS %6ld MiB\n", ru.ru_maxrss / 1024);
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string k = argv[i];
+    if (k == "--size-mib") a.size_mib = std::strtoull(argv[i + 1], nullptr, 10);
+    else if (k == "--devices") a.devices = std::strtoull(argv[i + 1], nullptr, 10);
+    else if (k == "--usb-mbps") a.usb_mbps = std::strtoull(argv[i + 1], nullptr, 10);
+    else if (k == "--profile") a.profile = argv[i + 1];
+  }
+  if (!a.size_mib || !a.devices) return 2;
+  spdlog::set_level(spdlog::level::warn);
+
+  const fs::path dir = fs::temp_directory_path() / ("brokkr-bench-" + std::to_string(::getpid()));
+  fs::create_directories(dir);
+
+  const fs::path pkg = dir / "AP.tar.md5";
+  if (!write_package(pkg, a.size_mib * 1024 * 1024)) return 1;
+  std::printf("%llu MiB payload, %zu device(s), usb %s\n", static_cast<unsigned long long>(a.size_mib), a.devices,
+              a.usb_mbps ? (std::to_string(a.usb_mbps) + " MiB/s").c_str() : "unthrottled");
+
+  int rc = 0;
+  if (a.profile != "low") rc |= fork_profile(a, brokkr::app::MemoryProfile::Default, pkg);
+  if (a.profile != "default") rc |= fork_profile(a, brokkr::app::MemoryProfile::Low, pkg);
+
+  std::error_code ec;
+  fs::remove_all(dir, ec);
+  return rc;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+// Cold-path startup cost of the executables: wall time and peak RSS of `<exe> --help`,
+// which parses arguments, prints the usage and exits without touching any device.
+//
+//   bench_startup [--runs N] <exe> [<exe>...]
+//
+// Pass both brokkr-cli and brokkr to see what loading Qt costs a scripted invocation.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Sample {
+  double ms = 0;
+  long maxrss_kib = 0;
+};
+
+bool run_once(const char* exe, Sample& out) {
+  const auto t0 = Clock::now();
+  const pid_t pid = ::fork();
+  if (pid < 0) return false;
+  if (pid == 0) {
+    const int null = ::open("/dev/null", O_WRONLY);
+    if (null >= 0) {
+      ::dup2(null, STDOUT_FILENO);
+      ::dup2(null, STDERR_FILENO);
+    }
+    ::execl(exe, exe, "--help", static_cast<char*>(nullptr));
+    std::_Exit(127);
+  }
+
+  int status = 0;
+  rusage ru{};
+  if (::wait4(pid, &status, 0, &ru) < 0 || !WIFEXITED(status) || WEXITSTATUS(status)) return false;
+  out.ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+  out.maxrss_kib = ru.ru_maxrss;
+  return true;
+}
+
+int bench(const char* exe, int runs) {
+  Sample warm;
+  if (!run_once(exe, warm)) return std::fprintf(stderr, "%s: failed to run '--help'\n", exe), 1;
+
+  std::vector<double> ms;
+  long rss = 0;
+  for (int i = 0; i < runs; ++i) {
+    Sample s;
+    if (!run_once(exe, s)) return std::fprintf(stderr, "%s: run %d failed\n", exe, i), 1;
+    ms.push_back(s.ms);
+    rss = std::max(rss, s.maxrss_kib);
+  }
+
+  std::sort(ms.begin(), ms.end());
+  double sum = 0;
+  for (double v : ms) sum += v;
+  std::printf("%-32s min %7.2f ms   median %7.2f ms   mean %7.2f ms   peak RSS %6ld KiB\n", exe, ms.front(),
+              ms[ms.size() / 2], sum / static_cast<double>(ms.size()), rss);
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  int runs = 50;
+  std::vector<const char*> exes;
+  for (int i = 1; i < argc; ++i) {
+    const std::string k = argv[i];
+    if (k == "--runs" && i + 1 < argc) runs = std::atoi(argv[++i]);
+    else exes.push_back(argv[i]);
+  }
+  if (exes.empty() || runs <= 0) {
+    std::fprintf(stderr, "usage: bench_startup [--runs N] <exe> [<exe>...]\n");
+    return 2;
+  }
+
+  std::printf("%d runs each (after one warm-up)\n", runs);
+  int rc = 0;
+  for (const char* exe : exes) rc |= bench(exe, runs);
+  return rc;
+}
@@ -0,0 +1,610 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Deterministic synthetic firmware for benchmarks and simulators: a tar, or a .tar.md5, in the shape
+// expand_inputs_tar_or_raw() consumes, so multi-GB packages can be made in CI without real firmware.
+//
+//   gen_package [--size SIZE] [--entries N] [--mix ZEROS:TEXT:RANDOM] [--lz4 N] [--sparse N] [--seed N]
+//               [--cpu-bl-id ID] [--no-pit] [--no-download-list] [--threads N] [--check] OUT
+//
+// SIZE is the logical payload and takes K/M/G suffixes. Image sizes fall off as 1/n, and images are
+// filled in 1 MiB blocks whose kind is drawn from the mix: zeros, text-like bytes (about 3x with LZ4)
+// or random bytes. The --sparse largest images are Android sparse images (zero runs become DONT_CARE
+// and FILL chunks), and the first --lz4 images are .lz4 frames with 1 MiB independent blocks and the
+// content size set. Unless disabled, <cpu-bl-id>.pit maps every image and meta-data/download-list.txt
+// lists them. OUT ending in .md5 gets the MD5 trailer. The same arguments always give the same bytes.
+
+#include "core/endian.hpp"
+#include "core/thread_pool.hpp"
+#include "io/lz4_compress.hpp"
+#include "protocol/odin/flash.hpp"
+#include "protocol/odin/pit.hpp"
+#include "third_party/md5/md5.h"
+#include "third_party/xxhash/xxhash_vendor.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kBlock = 1024 * 1024; // fill granularity and LZ4 block size
+constexpr std::size_t kPage = 4096;         // content generation unit and sparse block size
+constexpr std::uint64_t kMaxRawChunkPages = 64 * 1024;
+
+struct Args {
+  std::uint64_t size = 256ull << 20;
+  std::size_t entries = 8;
+  std::array<unsigned, 3> mix{2, 1, 1};
+  std::optional<std::size_t> lz4;
+  std::size_t sparse = 1;
+  std::uint64_t seed = 1;
+  std::string cpu_bl_id = "SYNTH";
+  bool pit = true;
+  bool download_list = true;
+  std::size_t threads = 0;
+  bool check = false;
+  fs::path out;
+};
+
+enum class Fill : std::uint8_t { Zero, Text, Random };
+
+std::uint64_t splitmix64(std::uint64_t x) noexcept {
+  x += 0x9E3779B97F4A7C15ull;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  return x ^ (x >> 31);
+}
+
+struct Xorshift {
+  std::uint64_t s;
+  explicit Xorshift(std::uint64_t seed) : s(splitmix64(seed) | 1) {}
+  std::uint64_t next() noexcept {
+    s ^= s >> 12;
+    s ^= s << 25;
+    s ^= s >> 27;
+    return s * 0x2545F4914F6CDD1Dull;
+  }
+};
+
+// 64 tokens from build.prop, kernel logs and manifests, picked 6 bits at a time.
+constexpr std::string_view kWords[64] = {
+    "ro.",       "product",   "vendor",   "system",   "build",    "version",  "=",        "\n",
+    "android",   "samsung",   "boot",     "kernel",   "0x",       "00000000", "ffffffff", " ",
+    "init",      "service",   "class",    "main",     "user",     "root",     "group",    "disabled",
+    "oneshot",   "on",        "property", "/dev/",    "block/",   "by-name/", "mount",    "ext4",
+    "f2fs",      "ro",        "rw",       "wait",     "check",    "avb",      "slotselect", "first_stage",
+    "[",         "]",         "I",        "W",        "E",        ":",        "1",        "2",
+    "3",         "4",         "5",        "6",        "7",        "8",        "9",        "0",
+    "selinux",   "context",   "u:object_r:", "_exec:s0", "<?xml",  "</",       ">",        "\"",
+};
+
+void fill_page(Fill f, std::uint64_t key, std::byte* out) noexcept {
+  switch (f) {
+    case Fill::Zero: std::memset(out, 0, kPage); return;
+    case Fill::Random: {
+      Xorshift r(key);
+      for (std::size_t i = 0; i < kPage; i += 8) {
+        const std::uint64_t v = r.next();
+        std::memcpy(out + i, &v, 8);
+      }
+      return;
+    }
+    case Fill::Text: {
+      Xorshift r(key);
+      std::size_t n = 0;
+      while (n < kPage) {
+        std::uint64_t v = r.next();
+        for (int k = 0; k < 10 && n < kPage; ++k, v >>= 6) {
+          const auto w = kWords[v & 63];
+          const std::size_t m = std::min(w.size(), kPage - n);
+          std::memcpy(out + n, w.data(), m);
+          n += m;
+        }
+      }
+      return;
+    }
+  }
+}
+
+// A member's bytes as a list of literal and generated segments, so any range can be produced on its own.
+struct Segment {
+  std::uint64_t off = 0;
+  std::uint64_t len = 0;
+  bool data = false;          // generated image content starting at `logical`
+  std::uint64_t logical = 0;
+  std::string bytes;          // literal otherwise
+};
+
+struct Image {
+  std::size_t index = 0;
+  std::string name; // as flashed, e.g. "super.img"
+  std::uint64_t size = 0;
+  bool lz4 = false;
+  bool sparse = false;
+  std::vector<Fill> blocks; // per 1 MiB of logical content
+  std::vector<Segment> layout;
+  std::uint64_t file_size = 0;
+
+  std::string member() const { return lz4 ? name + ".lz4" : name; }
+};
+
+template <class T>
+void put_le(std::string& s, T v) {
+  for (std::size_t i = 0; i < sizeof(T); ++i) s.push_back(static_cast<char>((static_cast<std::uint64_t>(v) >> (8 * i)) & 0xFF));
+}
+
+void add_literal(Image& img, std::string bytes) {
+  const auto n = bytes.size();
+  img.layout.push_back({.off = img.file_size, .len = n, .bytes = std::move(bytes)});
+  img.file_size += n;
+}
+
+void add_data(Image& img, std::uint64_t logical, std::uint64_t len) {
+  img.layout.push_back({.off = img.file_size, .len = len, .data = true, .logical = logical, .bytes = {}});
+  img.file_size += len;
+}
+
+std::string sparse_chunk(std::uint16_t type, std::uint32_t pages, std::uint32_t total) {
+  std::string s;
+  put_le<std::uint16_t>(s, type);
+  put_le<std::uint16_t>(s, 0);
+  put_le<std::uint32_t>(s, pages);
+  put_le<std::uint32_t>(s, total);
+  return s;
+}
+
+// Android sparse format v1.0: zero runs alternate between DONT_CARE and FILL chunks, the rest is RAW.
+void layout_sparse(Image& img) {
+  constexpr std::uint16_t kRaw = 0xCAC1, kFill = 0xCAC2, kDontCare = 0xCAC3;
+
+  struct Chunk { std::uint16_t type; std::uint64_t first; std::uint64_t pages; };
+  std::vector<Chunk> chunks;
+  const std::uint64_t total_pages = img.size / kPage;
+  constexpr std::uint64_t kPagesPerBlock = kBlock / kPage;
+  std::size_t zero_runs = 0;
+
+  for (std::uint64_t p = 0; p < total_pages;) {
+    const bool zero = img.blocks[p / kPagesPerBlock] == Fill::Zero;
+    std::uint64_t e = p;
+    while (e < total_pages && (img.blocks[e / kPagesPerBlock] == Fill::Zero) == zero &&
+           (zero || e - p < kMaxRawChunkPages))
+      e = std::min(total_pages, (e / kPagesPerBlock + 1) * kPagesPerBlock);
+    const std::uint16_t type = !zero ? kRaw : (zero_runs++ % 2 ? kFill : kDontCare);
+    chunks.push_back({type, p, e - p});
+    p = e;
+  }
+
+  std::string hdr;
+  put_le<std::uint32_t>(hdr, 0xED26FF3Au);
+  put_le<std::uint16_t>(hdr, 1);
+  put_le<std::uint16_t>(hdr, 0);
+  put_le<std::uint16_t>(hdr, 28);
+  put_le<std::uint16_t>(hdr, 12);
+  put_le<std::uint32_t>(hdr, static_cast<std::uint32_t>(kPage));
+  put_le<std::uint32_t>(hdr, static_cast<std::uint32_t>(total_pages));
+  put_le<std::uint32_t>(hdr, static_cast<std::uint32_t>(chunks.size()));
+  put_le<std::uint32_t>(hdr, 0);
+  add_literal(img, std::move(hdr));
+
+  for (const auto& c : chunks) {
+    const auto pages = static_cast<std::uint32_t>(c.pages);
+    switch (c.type) {
+      case kRaw:
+        add_literal(img, sparse_chunk(c.type, pages, static_cast<std::uint32_t>(12 + c.pages * kPage)));
+        add_data(img, c.first * kPage, c.pages * kPage);
+        break;
+      case kFill: add_literal(img, sparse_chunk(c.type, pages, 16) + std::string(4, '\0')); break;
+      default: add_literal(img, sparse_chunk(c.type, pages, 12)); break;
+    }
+  }
+}
+
+const char* const kNames[] = {"super.img",  "userdata.img", "vendor_boot.img", "boot.img",          "recovery.img",
+                              "dtbo.img",   "vbmeta.img",   "init_boot.img",   "prism.img",         "optics.img",
+                              "cache.img",  "persist.img",  "misc.bin",        "vbmeta_system.img", "keydata.img"};
+
+std::vector<Image> plan(const Args& a) {
+  std::vector<Image> imgs(a.entries);
+
+  double wsum = 0;
+  for (std::size_t i = 0; i < a.entries; ++i) wsum += 1.0 / static_cast<double>(i + 1);
+
+  std::uint64_t left = a.size / kPage;
+  for (std::size_t i = 0; i < a.entries; ++i) {
+    auto& img = imgs[i];
+    img.index = i;
+    img.name = i < std::size(kNames) ? kNames[i] : "synth" + std::to_string(i) + ".img";
+
+    auto pages = static_cast<std::uint64_t>(static_cast<double>(a.size / kPage) / (static_cast<double>(i + 1) * wsum));
+    pages = std::clamp<std::uint64_t>(pages, 1, std::max<std::uint64_t>(left, 1));
+    if (i + 1 == a.entries) pages = std::max<std::uint64_t>(left, 1);
+    left -= std::min(left, pages);
+    img.size = pages * kPage;
+
+    img.sparse = i < a.sparse;
+    img.lz4 = i < a.lz4.value_or(a.entries);
+
+    const unsigned total = a.mix[0] + a.mix[1] + a.mix[2];
+    img.blocks.resize((img.size + kBlock - 1) / kBlock);
+    for (std::size_t b = 0; b < img.blocks.size(); ++b) {
+      const auto r = splitmix64(a.seed ^ (static_cast<std::uint64_t>(i) << 40) ^ b) % total;
+      img.blocks[b] = r < a.mix[0] ? Fill::Zero : (r < a.mix[0] + a.mix[1] ? Fill::Text : Fill::Random);
+    }
+
+    if (img.sparse)
+      layout_sparse(img);
+    else
+      add_data(img, 0, img.size);
+  }
+  return imgs;
+}
+
+// Member bytes [off, off + out.size()).
+void produce(const Image& img, std::uint64_t seed, std::uint64_t off, std::span<std::byte> out) {
+  auto it = std::upper_bound(img.layout.begin(), img.layout.end(), off,
+                             [](std::uint64_t o, const Segment& s) { return o < s.off; });
+  --it;
+
+  std::array<std::byte, kPage> page;
+  std::size_t done = 0;
+  for (; done < out.size(); ++it) {
+    const std::uint64_t in_seg = off + done - it->off;
+    const auto n = static_cast<std::size_t>(std::min<std::uint64_t>(it->len - in_seg, out.size() - done));
+    if (!it->data) {
+      std::memcpy(out.data() + done, it->bytes.data() + in_seg, n);
+    } else {
+      for (std::size_t k = 0; k < n;) {
+        const std::uint64_t pos = it->logical + in_seg + k;
+        const std::uint64_t pno = pos / kPage;
+        const std::size_t at = static_cast<std::size_t>(pos % kPage);
+        const std::size_t m = std::min(kPage - at, n - k);
+        const std::uint64_t key = splitmix64(seed ^ (static_cast<std::uint64_t>(img.index) << 48) ^ pno);
+        fill_page(img.blocks[pno * kPage / kBlock], key, page.data());
+        std::memcpy(out.data() + done + k, page.data() + at, m);
+        k += m;
+      }
+    }
+    done += n;
+  }
+}
+
+std::vector<std::byte> make_pit(const Args& a, const std::vector<Image>& imgs) {
+  using namespace brokkr::odin::pit;
+  std::vector<std::byte> out(sizeof(PitHeaderWire) + imgs.size() * sizeof(PartitionInfoWire));
+
+  PitHeaderWire h{};
+  h.magic = brokkr::core::host_to_le(PIT_MAGIC);
+  h.count = brokkr::core::host_to_le(static_cast<std::int32_t>(imgs.size()));
+  std::memcpy(h.com_tar2, "COM_TAR2", 8);
+  std::memcpy(h.cpu_bl_id, a.cpu_bl_id.data(), std::min(a.cpu_bl_id.size(), sizeof(h.cpu_bl_id)));
+  std::memcpy(out.data(), &h, sizeof(h));
+
+  // UFS layout (4 KiB blocks) with 1 MiB of slack after every image.
+  std::int32_t begin = 0x2000;
+  for (std::size_t i = 0; i < imgs.size(); ++i) {
+    const auto blocks = static_cast<std::int32_t>(imgs[i].size / kPage + kBlock / kPage);
+    PartitionInfoWire w{};
+    w.devType = brokkr::core::host_to_le(std::int32_t{8});
+    w.id = brokkr::core::host_to_le(static_cast<std::int32_t>(i + 1));
+    w.offset = brokkr::core::host_to_le(begin);
+    w.blockLength = brokkr::core::host_to_le(blocks);
+    const auto pname = imgs[i].name.substr(0, imgs[i].name.find('.'));
+    std::string upper(pname);
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) { return std::toupper(c); });
+    std::memcpy(w.name, upper.data(), std::min(upper.size(), sizeof(w.name) - 1));
+    std::memcpy(w.fileName, imgs[i].name.data(), std::min(imgs[i].name.size(), sizeof(w.fileName) - 1));
+    std::memcpy(out.data() + sizeof(h) + i * sizeof(w), &w, sizeof(w));
+    begin += blocks;
+  }
+  return out;
+}
+
+void ustar_header(char (&h)[512], const std::string& name, std::uint64_t size) {
+  std::memset(h, 0, sizeof(h));
+  std::snprintf(h, 100, "%s", name.c_str());
+  std::snprintf(h + 100, 8, "%07o", 0644u);
+  std::snprintf(h + 108, 8, "%07o", 0u);
+  std::snprintf(h + 116, 8, "%07o", 0u);
+  if (size < (1ull << 33)) {
+    std::snprintf(h + 124, 12, "%011llo", static_cast<unsigned long long>(size));
+  } else {
+    h[124] = static_cast<char>(0x80); // GNU base-256
+    for (int i = 0; i < 8; ++i) h[135 - i] = static_cast<char>((size >> (8 * i)) & 0xFF);
+  }
+  std::snprintf(h + 136, 12, "%011o", 0u);
+  h[156] = '0';
+  std::memcpy(h + 257, "ustar", 6);
+  std::memcpy(h + 263, "00", 2);
+
+  std::memset(h + 148, ' ', 8);
+  unsigned sum = 0;
+  for (unsigned char c : h) sum += c;
+  std::snprintf(h + 148, 8, "%06o", sum);
+  h[155] = ' ';
+}
+
+class TarWriter {
+ public:
+  explicit TarWriter(std::FILE* f) : f_(f) {}
+
+  bool write(const void* p, std::size_t n) {
+    pos_ += n;
+    return std::fwrite(p, 1, n, f_) == n;
+  }
+
+  bool header(const std::string& name, std::uint64_t size) {
+    char h[512];
+    ustar_header(h, name, size);
+    return write(h, sizeof(h));
+  }
+
+  bool pad() {
+    static const char zeros[512]{};
+    return write(zeros, (512 - pos_ % 512) % 512);
+  }
+
+  bool member(const std::string& name, std::string_view bytes) {
+    return header(name, bytes.size()) && write(bytes.data(), bytes.size()) && pad();
+  }
+
+  // Rewrites the header at `at` once the member size is known.
+  bool patch_header(std::uint64_t at, const std::string& name, std::uint64_t size) {
+    char h[512];
+    ustar_header(h, name, size);
+    return fseeko(f_, static_cast<off_t>(at), SEEK_SET) == 0 && std::fwrite(h, 1, sizeof(h), f_) == sizeof(h) &&
+           fseeko(f_, 0, SEEK_END) == 0;
+  }
+
+  std::uint64_t pos() const noexcept { return pos_; }
+
+ private:
+  std::FILE* f_;
+  std::uint64_t pos_ = 0;
+};
+
+std::string lz4_frame_header(std::uint64_t content_size) {
+  std::string d;
+  d.push_back(static_cast<char>(0x68)); // version 1, independent blocks, content size
+  d.push_back(static_cast<char>(0x60)); // 1 MiB blocks
+  put_le<std::uint64_t>(d, content_size);
+  const auto hc = static_cast<char>((XXH32(d.data(), d.size(), 0) >> 8) & 0xFF);
+
+  std::string out;
+  put_le<std::uint32_t>(out, 0x184D2204u);
+  return out + d + hc;
+}
+
+// One image as a tar member; 1 MiB blocks are generated (and compressed) in parallel, written in order.
+bool write_image(TarWriter& tar, brokkr::core::ThreadPool& pool, std::size_t lanes, const Image& img,
+                 std::uint64_t seed) {
+  const std::uint64_t header_at = tar.pos();
+  if (!tar.header(img.member(), img.lz4 ? 0 : img.file_size)) return false;
+  if (img.lz4) {
+    const auto fh = lz4_frame_header(img.file_size);
+    if (!tar.write(fh.data(), fh.size())) return false;
+  }
+
+  const std::uint64_t nblocks = (img.file_size + kBlock - 1) / kBlock;
+  const std::size_t batch = lanes * 4;
+  std::vector<std::vector<std::byte>> raw(batch), enc(batch);
+
+  for (std::uint64_t base = 0; base < nblocks; base += batch) {
+    const auto n = static_cast<std::size_t>(std::min<std::uint64_t>(batch, nblocks - base));
+    for (std::size_t k = 0; k < n; ++k) {
+      const auto st = pool.submit([&, k]() -> brokkr::core::Status {
+        const std::uint64_t off = (base + k) * kBlock;
+        raw[k].resize(static_cast<std::size_t>(std::min<std::uint64_t>(kBlock, img.file_size - off)));
+        produce(img, seed, off, raw[k]);
+        if (img.lz4) {
+          enc[k].clear();
+          brokkr::io::lz4_append_frame_block(raw[k], enc[k]);
+        }
+        return {};
+      });
+      if (!st) return false;
+    }
+    if (!pool.wait()) return false;
+    for (std::size_t k = 0; k < n; ++k) {
+      const auto& b = img.lz4 ? enc[k] : raw[k];
+      if (!tar.write(b.data(), b.size())) return false;
+    }
+  }
+
+  if (img.lz4) {
+    static const char end_mark[4]{};
+    if (!tar.write(end_mark, sizeof(end_mark))) return false;
+    if (!tar.patch_header(header_at, img.member(), tar.pos() - header_at - 512)) return false;
+  }
+  return tar.pad();
+}
+
+bool append_md5_trailer(const fs::path& out) {
+  std::FILE* f = std::fopen(out.c_str(), "rb+");
+  if (!f) return false;
+
+  MD5_CTX md5;
+  md5_init(&md5);
+  std::vector<MD5_BYTE> buf(4 * kBlock);
+  for (std::size_t n; (n = std::fread(buf.data(), 1, buf.size(), f)) > 0;) md5_update(&md5, buf.data(), n);
+
+  MD5_BYTE digest[16];
+  md5_final(&md5, digest);
+  std::string line;
+  char hex[3];
+  for (auto b : digest) {
+    std::snprintf(hex, sizeof(hex), "%02x", b);
+    line += hex;
+  }
+  line += "  " + out.stem().string() + "\n";
+
+  const bool ok = fseeko(f, 0, SEEK_END) == 0 && std::fwrite(line.data(), 1, line.size(), f) == line.size();
+  return (std::fclose(f) == 0) && ok;
+}
+
+bool check_failed(const std::string& msg) {
+  std::fprintf(stderr, "check: %s\n", msg.c_str());
+  return false;
+}
+
+// Reads the package back the way a flash would and maps it onto its own PIT.
+bool check(const Args& a, const std::vector<Image>& imgs, const std::vector<std::byte>& pit_bytes) {
+  auto specs = brokkr::odin::expand_inputs_tar_or_raw({a.out});
+  if (!specs) return check_failed(specs.error());
+
+  std::size_t images = 0;
+  for (const auto& s : *specs) {
+    if (s.basename.ends_with(".pit")) continue;
+    const auto it = std::find_if(imgs.begin(), imgs.end(), [&](const Image& i) { return i.name == s.basename; });
+    if (it == imgs.end() || s.size != it->file_size || s.lz4 != it->lz4) return check_failed("unexpected " + s.basename);
+    ++images;
+  }
+  if (images != imgs.size()) return check_failed(std::to_string(images) + " of " + std::to_string(imgs.size()) + " images");
+
+  if (a.pit) {
+    auto table = brokkr::odin::pit::parse(pit_bytes);
+    if (!table) return check_failed(table.error());
+    auto items = brokkr::odin::map_to_pit(*table, *specs);
+    if (!items || items->size() != imgs.size()) return check_failed("PIT mapping incomplete");
+    for (const auto& it : *items)
+      if (it.part.file_size < it.spec.size) return check_failed(it.spec.basename + " does not fit its partition");
+  }
+  std::printf("check: %zu images expand and map\n", images);
+  return true;
+}
+
+std::optional<std::uint64_t> parse_size(std::string_view s) {
+  char* end = nullptr;
+  const std::string str(s);
+  const double v = std::strtod(str.c_str(), &end);
+  if (end == str.c_str() || v < 0) return std::nullopt;
+  std::uint64_t mul = 1;
+  switch (*end) {
+    case 'k': case 'K': mul = 1ull << 10; ++end; break;
+    case 'm': case 'M': mul = 1ull << 20; ++end; break;
+    case 'g': case 'G': mul = 1ull << 30; ++end; break;
+    case '\0': break;
+    default: return std::nullopt;
+  }
+  if (*end) return std::nullopt;
+  return static_cast<std::uint64_t>(v * static_cast<double>(mul));
+}
+
+int usage() {
+  std::fprintf(stderr,
+               "usage: gen_package [--size SIZE] [--entries N] [--mix ZEROS:TEXT:RANDOM] [--lz4 N] [--sparse N]\n"
+               "                   [--seed N] [--cpu-bl-id ID] [--no-pit] [--no-download-list] [--threads N]\n"
+               "                   [--check] OUT\n");
+  return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  Args a;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view k = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (k == "--no-pit") a.pit = false;
+    else if (k == "--no-download-list") a.download_list = false;
+    else if (k == "--check") a.check = true;
+    else if (!k.starts_with("--")) a.out = argv[i];
+    else if (!has_value) return usage();
+    else if (k == "--size") {
+      const auto s = parse_size(argv[++i]);
+      if (!s) return usage();
+      a.size = *s;
+    } else if (k == "--entries") a.entries = std::strtoull(argv[++i], nullptr, 10);
+    else if (k == "--lz4") a.lz4 = std::strtoull(argv[++i], nullptr, 10);
+    else if (k == "--sparse") a.sparse = std::strtoull(argv[++i], nullptr, 10);
+    else if (k == "--seed") a.seed = std::strtoull(argv[++i], nullptr, 0);
+    else if (k == "--cpu-bl-id") a.cpu_bl_id = argv[++i];
+    else if (k == "--threads") a.threads = std::strtoull(argv[++i], nullptr, 10);
+    else if (k == "--mix") {
+      if (std::sscanf(argv[++i], "%u:%u:%u", &a.mix[0], &a.mix[1], &a.mix[2]) != 3) return usage();
+    } else return usage();
+  }
+  if (a.out.empty() || !a.entries || a.size < a.entries * kPage || a.mix[0] + a.mix[1] + a.mix[2] == 0) return usage();
+  if (a.cpu_bl_id.empty() || a.cpu_bl_id.size() > 8) {
+    std::fprintf(stderr, "--cpu-bl-id takes 1 to 8 characters\n");
+    return 2;
+  }
+  spdlog::set_level(spdlog::level::warn);
+
+  const auto t0 = Clock::now();
+  const auto imgs = plan(a);
+  const auto pit = make_pit(a, imgs);
+
+  std::FILE* f = std::fopen(a.out.c_str(), "wb");
+  if (!f) {
+    std::fprintf(stderr, "cannot create %s\n", a.out.c_str());
+    return 1;
+  }
+  std::vector<char> iobuf(4 * kBlock);
+  std::setvbuf(f, iobuf.data(), _IOFBF, iobuf.size());
+
+  const std::size_t lanes = a.threads ? a.threads : std::max(1u, std::thread::hardware_concurrency());
+  brokkr::core::ThreadPool pool(lanes);
+  TarWriter tar(f);
+
+  bool ok = true;
+  for (const auto& img : imgs) ok = ok && write_image(tar, pool, lanes, img, a.seed);
+  if (a.pit) ok = ok && tar.member(a.cpu_bl_id + ".pit", {reinterpret_cast<const char*>(pit.data()), pit.size()});
+  if (a.download_list) {
+    std::string dl;
+    for (const auto& img : imgs) dl += img.name + "\n";
+    ok = ok && tar.member("meta-data/download-list.txt", dl);
+  }
+  static const char eof[1024]{};
+  ok = ok && tar.write(eof, sizeof(eof));
+  ok = (std::fclose(f) == 0) && ok;
+  pool.stop();
+
+  if (ok && a.out.extension() == ".md5") ok = append_md5_trailer(a.out);
+  if (!ok) {
+    std::fprintf(stderr, "failed writing %s\n", a.out.c_str());
+    return 1;
+  }
+
+  const double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+  const auto written = fs::file_size(a.out);
+  std::printf("%s: %zu images, %llu MiB logical, %llu MiB written in %.2f s\n", a.out.c_str(), imgs.size(),
+              static_cast<unsigned long long>(a.size >> 20), static_cast<unsigned long long>(written >> 20), secs);
+  for (const auto& img : imgs)
+    std::printf("  %-22s %10llu KiB%s%s\n", img.member().c_str(), static_cast<unsigned long long>(img.size >> 10),
+                img.sparse ? "  sparse" : "", img.lz4 ? "  lz4" : "");
+
+  if (a.check && !check(a, imgs, pit)) return 1;
+  return 0;
+}
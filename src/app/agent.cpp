@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app/agent.hpp"
+
+#include "app/engine.hpp"
+#include "platform/platform_all.hpp"
+#include "protocol/odin/group_flasher.hpp"
+#include "protocol/relay/relay_server.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace brokkr::app {
+
+namespace {
+
+constexpr int kIdleTimeoutMs = 60'000;
+
+std::vector<std::string> odin_device_lines() {
+  std::vector<std::string> out;
+  for (const auto& d : enumerate_samsung_targets())
+    if (is_odin_product(d.product)) out.push_back(d.devnode() + "\t" + d.sysname);
+  return out;
+}
+
+class Agent {
+ public:
+  int run(std::uint16_t port);
+
+ private:
+  brokkr::core::Result<std::shared_ptr<brokkr::core::IByteTransport>> open_(const std::string& devnode);
+  void release_(const std::string& devnode);
+
+ private:
+  std::atomic_bool stop_{false};
+  std::mutex busy_mtx_;
+  std::set<std::string> busy_;
+};
+
+brokkr::core::Result<std::shared_ptr<brokkr::core::IByteTransport>> Agent::open_(const std::string& devnode) {
+  const auto lines = odin_device_lines();
+  const bool known = std::any_of(lines.begin(), lines.end(), [&](const std::string& l) {
+    return l.compare(0, devnode.size() + 1, devnode + "\t") == 0;
+  });
+  if (!known) return brokkr::core::failf("{} is not an Odin device on this host", devnode);
+
+  {
+    std::lock_guard lk(busy_mtx_);
+    if (!busy_.insert(devnode).second) return brokkr::core::failf("{} is in use", devnode);
+  }
+
+  auto ut = std::shared_ptr<brokkr::odin::UsbTarget>(new brokkr::odin::UsbTarget(devnode),
+                                                     [this](brokkr::odin::UsbTarget* p) {
+                                                       release_(p->devnode);
+                                                       delete p;
+                                                     });
+  BRK_TRY(ut->dev.open_and_init());
+  BRK_TRY(ut->conn.open());
+  return std::shared_ptr<brokkr::core::IByteTransport>(ut, &ut->conn);
+}
+
+void Agent::release_(const std::string& devnode) {
+  std::lock_guard lk(busy_mtx_);
+  busy_.erase(devnode);
+}
+
+int Agent::run(std::uint16_t port) {
+  brokkr::platform::TcpListener listener;
+  if (auto st = listener.bind_and_listen("0.0.0.0", port, 16); !st) {
+    spdlog::error("{}", st.error());
+    return 1;
+  }
+
+  auto shield = brokkr::core::SignalShield::enable([this](const char* sig_desc, int) {
+    spdlog::info("{} received, stopping agent after active sessions", sig_desc);
+    stop_.store(true);
+  });
+  if (!shield) spdlog::warn("Failed to enable signal shielding; interrupts may cut off an active session.");
+
+  spdlog::info("Relay agent listening on port {}", port);
+  for (const auto& l : odin_device_lines()) spdlog::info("  {}", l);
+
+  const brokkr::relay::RelayHooks hooks{
+      .list = odin_device_lines,
+      .open = [this](const std::string& devnode) { return open_(devnode); },
+  };
+
+  std::vector<std::jthread> sessions;
+  while (!stop_.load()) {
+    auto ar = listener.accept_one();
+    if (!ar) {
+      if (ar.error() == "accept: timeout") continue;
+      spdlog::error("{}", ar.error());
+      return 1;
+    }
+
+    auto conn = std::make_shared<brokkr::platform::TcpConnection>(std::move(*ar));
+    conn->set_timeout_ms(kIdleTimeoutMs);
+    spdlog::info("Relay: controller {} connected", conn->peer_label());
+
+    sessions.emplace_back([conn, &hooks] {
+      if (auto st = brokkr::relay::serve_relay_session(*conn, hooks); !st)
+        spdlog::warn("Relay {}: {}", conn->peer_label(), st.error());
+      spdlog::info("Relay: controller {} disconnected", conn->peer_label());
+    });
+  }
+
+  return 0;
+}
+
+} // namespace
+
+int run_agent(std::uint16_t port) {
+  auto lock = brokkr::platform::SingleInstanceLock::try_acquire("brokkr-engine");
+  if (!lock) {
+    spdlog::error("Another instance is already running.");
+    return 2;
+  }
+
+  Agent agent;
+  return agent.run(port);
+}
+
+} // namespace brokkr::app
@@ -17,31 +17,36 @@
 
 #include "app/cli_mode.hpp"
 
-#include "app/md5_verify.hpp"
+#include "app/agent.hpp"
+#include "app/daemon.hpp"
+#include "app/engine.hpp"
+#include "app/experiment.hpp"
+#include "app/flush_fingerprint.hpp"
 #include "core/status.hpp"
-#include "core/str.hpp"
-#include "io/source.hpp"
 #include "platform/platform_all.hpp"
 #include "protocol/odin/flash.hpp"
 #include "protocol/odin/group_flasher.hpp"
+#include "protocol/odin/station.hpp"
+#include "protocol/relay/relay_wire.hpp"
 
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
 #include <atomic>
+#include <charconv>
 #include <chrono>
-#include <cctype>
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <random>
+#include <stop_token>
 #include <string>
 #include <string_view>
-#include <thread>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -50,18 +55,30 @@ namespace brokkr::app {
 
 namespace {
 
-constexpr std::uint16_t kSamsungVid = 0x04E8;
-constexpr std::uint16_t kOdinPids[] = {0x6601, 0x685D, 0x68C3};
-constexpr std::uint16_t kWirelessPort = 13579;
+// Phones take 10-20 s to drop off the bus and come back in Odin Mode.
+constexpr std::chrono::seconds kRebootDownloadWait{45};
 
 struct CliArgs {
   bool help = false;
   bool list = false;
   bool wireless = false;
   bool no_reboot = false;
-
+  bool serve = false;
+  bool no_daemon = false;
+  bool agent = false;
+  bool remote_lz4 = false;
+  bool low_memory = false;
+  bool reboot_download = false;
+  bool station = false;
+
+  std::uint16_t agent_port = brokkr::relay::kDefaultPort;
+  std::vector<std::string> remotes;
+
+  std::optional<std::string> socket;
   std::optional<std::string> target;
   std::optional<std::string> pit;
+  std::optional<std::string> experiment;
+  std::optional<std::string> experiment_report;
 
   std::optional<std::string> bl;
   std::optional<std::string> ap;
@@ -70,21 +87,13 @@ struct CliArgs {
   std::optional<std::string> userdata;
 };
 
-struct Provider {
-  std::vector<std::unique_ptr<brokkr::odin::UsbTarget>> usb;
-  std::vector<brokkr::odin::Target> owned;
-  std::vector<brokkr::odin::Target*> ptrs;
-  std::unique_ptr<brokkr::platform::TcpConnection> wireless_conn;
-};
-
-bool is_odin_product(std::uint16_t pid) {
-  return std::find(std::begin(kOdinPids), std::end(kOdinPids), pid) != std::end(kOdinPids);
-}
 
 bool is_cli_trigger(std::string_view arg) {
   static const std::unordered_set<std::string_view> kTriggers = {
       "-h", "--help", "--list", "--wireless", "--no-reboot", "--use-pit", "--target",
-      "-b", "-a", "-c", "-s", "-u",
+      "-b", "-a", "-c", "-s", "-u", "serve", "--socket", "--no-daemon", "agent",
+      "--remote", "--remote-lz4", "--low-memory", "--reboot-download", "--station",
+      "--experiment", "--experiment-report",
   };
   return kTriggers.contains(arg);
 }
@@ -104,7 +113,10 @@ void configure_cli_logger() {
 void print_usage() {
   std::cout
       << "Usage:\n"
-      << "  brokkr [CLI options]\n\n"
+      << "  brokkr [CLI options]\n"
+      << "  brokkr-cli [CLI options]     Headless build of the same CLI (no Qt)\n"
+      << "  brokkr serve [--socket <path>]\n"
+      << "  brokkr agent [--port <n>]    Expose local Odin devices to remote controllers\n\n"
       << "CLI options (any of these switches CLI mode):\n"
       << "  -h, --help                 Show this help\n"
       << "  --list                     List Samsung devices usable by --target\n"
@@ -116,11 +128,26 @@ void print_usage() {
       << "  --use-pit <path.pit>       Optional PIT file\n"
       << "  --no-reboot                Do not reboot at end\n"
       << "  --wireless                 Flash via wireless listener\n"
-      << "  --target <sysname>         Same target semantics as GUI\n\n"
+      << "  --target <sysname>         Same target semantics as GUI\n"
+      << "  --remote <host[:port],...> Flash devices attached to brokkr agents instead of local USB\n"
+      << "  --remote-lz4               LZ4-compress packets sent to agents (slow links)\n"
+      << "  --socket <path>            Daemon socket (default: " << default_daemon_socket().string() << ")\n"
+      << "  --no-daemon                Run in-process even if a daemon is listening\n"
+      << "  --low-memory               Small stream/hash buffers for low-RAM controllers (also BROKKR_LOW_MEMORY=1)\n"
+      << "  --reboot-download          Reboot Samsung devices in normal mode into Download Mode over USB serial\n"
+      << "  --station                  Keep running and flash every Odin device as it is plugged in\n"
+      << "  --experiment <cfg.json>    With --station: flash each device with a random Cfg variant and record it\n"
+      << "  --experiment-report <cfg.json>\n"
+      << "                             Per-variant throughput and failure rates recorded so far, with 95% CIs\n\n"
       << "Notes:\n"
       << "  - At least one file is required from: -b -a -c -s -u --use-pit\n"
-      << "  - --wireless cannot be used with --target\n"
-      << "  - If no valid CLI option is present, GUI mode is launched\n";
+      << "  - --wireless cannot be used with --target or --remote\n"
+      << "  - With --remote, --target selects a sysname reported by the agents\n"
+      << "  - --reboot-download waits for the devices to come back in Odin Mode; with files it then flashes them\n"
+      << "  - --station cannot be used with --target, --wireless or --remote; stop it with Ctrl+C\n"
+      << "  - Experiment results are kept in the cache directory, one file per experiment name\n"
+      << "  - If no valid CLI option is present, brokkr launches the GUI and brokkr-cli prints this help\n"
+      << "  - While 'brokkr serve' is running, CLI invocations are forwarded to it\n";
 }
 
 brokkr::core::Result<CliArgs> parse_cli_args(int argc, char* argv[]) {
@@ -151,6 +178,67 @@ brokkr::core::Result<CliArgs> parse_cli_args(int argc, char* argv[]) {
       out.no_reboot = true;
       continue;
     }
+    if (arg == "serve" && i == 1) {
+      out.serve = true;
+      continue;
+    }
+    if (arg == "agent" && i == 1) {
+      out.agent = true;
+      continue;
+    }
+    if (arg == "--port") {
+      BRK_TRYV(v, require_value(i, "--port"));
+      unsigned port = 0;
+      const auto [ptr, ec] = std::from_chars(v.data(), v.data() + v.size(), port);
+      if (ec != std::errc{} || ptr != v.data() + v.size() || port == 0 || port > 65535)
+        return brokkr::core::fail("Invalid port: " + v);
+      out.agent_port = static_cast<std::uint16_t>(port);
+      continue;
+    }
+    if (arg == "--remote") {
+      BRK_TRYV(v, require_value(i, "--remote"));
+      for (std::size_t pos = 0; pos <= v.size();) {
+        const auto comma = std::min(v.find(',', pos), v.size());
+        if (comma > pos) out.remotes.push_back(v.substr(pos, comma - pos));
+        pos = comma + 1;
+      }
+      continue;
+    }
+    if (arg == "--remote-lz4") {
+      out.remote_lz4 = true;
+      continue;
+    }
+    if (arg == "--low-memory") {
+      out.low_memory = true;
+      continue;
+    }
+    if (arg == "--reboot-download") {
+      out.reboot_download = true;
+      continue;
+    }
+    if (arg == "--station") {
+      out.station = true;
+      continue;
+    }
+    if (arg == "--experiment") {
+      BRK_TRYV(v, require_value(i, "--experiment"));
+      out.experiment = std::move(v);
+      continue;
+    }
+    if (arg == "--experiment-report") {
+      BRK_TRYV(v, require_value(i, "--experiment-report"));
+      out.experiment_report = std::move(v);
+      continue;
+    }
+    if (arg == "--no-daemon") {
+      out.no_daemon = true;
+      continue;
+    }
+    if (arg == "--socket") {
+      BRK_TRYV(v, require_value(i, "--socket"));
+      out.socket = std::move(v);
+      continue;
+    }
     if (arg == "--target") {
       BRK_TRYV(v, require_value(i, "--target"));
       out.target = std::move(v);
@@ -193,24 +281,6 @@ brokkr::core::Result<CliArgs> parse_cli_args(int argc, char* argv[]) {
   return out;
 }
 
-std::vector<brokkr::platform::UsbDeviceSysfsInfo> enumerate_samsung_targets() {
-  brokkr::platform::EnumerateFilter f{.vendor = kSamsungVid};
-  return brokkr::platform::enumerate_usb_devices_sysfs(f);
-}
-
-std::optional<brokkr::platform::UsbDeviceSysfsInfo> select_samsung_target(std::string_view sysname) {
-  if (sysname.empty()) return std::nullopt;
-  auto info = brokkr::platform::find_by_sysname(sysname);
-  if (!info || info->vendor != kSamsungVid) return std::nullopt;
-  return info;
-}
-
-std::optional<brokkr::platform::UsbDeviceSysfsInfo> select_odin_target(std::string_view sysname) {
-  auto info = select_samsung_target(sysname);
-  if (!info || !is_odin_product(info->product)) return std::nullopt;
-  return info;
-}
-
 std::vector<std::filesystem::path> collect_inputs_in_gui_order(const CliArgs& args) {
   std::vector<std::filesystem::path> out;
   if (args.bl) out.emplace_back(*args.bl);
@@ -226,93 +296,6 @@ bool has_any_file_selected(const CliArgs& args) {
          args.userdata.has_value() || args.pit.has_value();
 }
 
-std::shared_ptr<const std::vector<std::byte>> load_pit_if_needed(const CliArgs& args) {
-  if (!args.pit) return {};
-
-  const std::filesystem::path p = *args.pit;
-  std::error_code ec;
-  const auto sz = std::filesystem::file_size(p, ec);
-  if (ec) {
-    spdlog::error("Cannot stat PIT file.");
-    return {};
-  }
-
-  std::vector<std::byte> buf(static_cast<std::size_t>(sz));
-  std::ifstream in(p, std::ios::binary);
-  if (!in.is_open()) {
-    spdlog::error("Cannot open PIT file.");
-    return {};
-  }
-
-  if (!buf.empty()) {
-    in.read(reinterpret_cast<char*>(buf.data()), static_cast<std::streamsize>(buf.size()));
-    if (!in.good()) {
-      spdlog::error("Failed to read PIT file.");
-      return {};
-    }
-  }
-
-  return std::make_shared<const std::vector<std::byte>>(std::move(buf));
-}
-
-bool is_pit_name(std::string_view base) noexcept {
-  return brokkr::core::ends_with_ci(base, ".pit");
-}
-
-std::shared_ptr<const std::vector<std::byte>> pit_from_specs(
-    const std::vector<brokkr::odin::ImageSpec>& specs) {
-  const brokkr::odin::ImageSpec* pit = nullptr;
-  for (const auto& s : specs)
-    if (is_pit_name(s.basename)) pit = &s;
-  if (!pit) return {};
-
-  auto sr = pit->open();
-  if (!sr) {
-    spdlog::error("PIT open failed: {}", sr.error());
-    return {};
-  }
-  auto& src = **sr;
-
-  constexpr std::uint64_t kMaxPit = 256ull * 1024ull * 1024ull;
-  const auto sz64 = src.size();
-  if (sz64 > kMaxPit) {
-    spdlog::error("Embedded PIT too large: {}", src.display_name());
-    return {};
-  }
-
-  std::vector<std::byte> out(static_cast<std::size_t>(sz64));
-  for (std::size_t off = 0; off < out.size();) {
-    const std::size_t got = src.read({out.data() + off, out.size() - off});
-    if (!got) {
-      auto st = src.status();
-      if (!st)
-        spdlog::error("PIT read failed: {}", st.error());
-      else
-        spdlog::error("Short read on embedded PIT: {}", src.display_name());
-      return {};
-    }
-    off += got;
-  }
-
-  return std::make_shared<const std::vector<std::byte>>(std::move(out));
-}
-
-std::string map_global_error_to_cli_message(const std::string& err) {
-  const auto has_ic = [&](std::string_view needle) {
-    auto it = std::search(err.begin(), err.end(), needle.begin(), needle.end(), [](char a, char b) {
-      return static_cast<char>(std::tolower(static_cast<unsigned char>(a))) ==
-             static_cast<char>(std::tolower(static_cast<unsigned char>(b)));
-    });
-    return it != err.end();
-  };
-
-  if (has_ic("mismatch across devices") || has_ic("differs across devices")) {
-    return "The connected devices do not match!";
-  }
-
-  return err;
-}
-
 int list_devices_cli() {
   const auto devs = enumerate_samsung_targets();
   if (devs.empty()) {
@@ -327,74 +310,50 @@ int list_devices_cli() {
   return 0;
 }
 
-brokkr::core::Result<Provider> make_provider(const CliArgs& args, const brokkr::odin::Cfg& cfg) {
-  Provider p;
-
-  if (args.wireless) {
-    brokkr::platform::TcpListener listener;
-    BRK_TRY(listener.bind_and_listen("0.0.0.0", kWirelessPort));
-
-    spdlog::info("Waiting for connection on port {}", kWirelessPort);
-
-    for (;;) {
-      auto ar = listener.accept_one();
-      if (ar) {
-        p.wireless_conn = std::make_unique<brokkr::platform::TcpConnection>(std::move(*ar));
-        break;
-      }
-      if (ar.error() != "accept: timeout") return brokkr::core::fail(std::move(ar.error()));
-      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+int list_remote_devices_cli(const std::vector<std::string>& remotes) {
+  int rc = 0;
+  for (const auto& spec : remotes) {
+    auto hp = parse_remote_spec(spec);
+    auto devs = hp ? brokkr::relay::list_remote_devices(hp->first, hp->second)
+                   : brokkr::core::Result<std::vector<brokkr::relay::RemoteDevice>>(std::unexpect, hp.error());
+    if (!devs) {
+      spdlog::error("{}: {}", spec, devs.error());
+      rc = 1;
+      continue;
     }
-
-    p.owned.push_back(brokkr::odin::Target{.id = "wireless", .link = p.wireless_conn.get()});
-    p.ptrs.push_back(&p.owned.back());
-    return p;
+    if (devs->empty()) std::cout << spec << "\tNo devices in Odin Mode\n";
+    for (const auto& d : *devs) std::cout << spec << "\t" << d.sysname << "\tOdin Mode\n";
   }
+  return rc;
+}
 
-  std::vector<brokkr::platform::UsbDeviceSysfsInfo> targets;
-  if (args.target && !args.target->empty()) {
-    auto info = select_samsung_target(*args.target);
-    if (!info) return brokkr::core::fail("Target sysname not found.");
-    if (!is_odin_product(info->product)) {
-      return brokkr::core::fail("The device is not in Odin Mode, reboot to download mode first.");
-    }
-    targets.push_back(*info);
-  } else {
-    const auto all_samsung = enumerate_samsung_targets();
-    if (all_samsung.empty()) return brokkr::core::fail("No connected devices detected.");
-
-    for (const auto& d : all_samsung) {
-      if (is_odin_product(d.product)) {
-        targets.push_back(d);
-      } else {
-        spdlog::info("{} is not in Odin Mode hence ignored", d.sysname);
-      }
-    }
-
-    if (targets.empty()) return brokkr::core::fail("None of the devices are in Odin Mode");
+int reboot_download_cli() {
+  auto r = reboot_to_download(kRebootDownloadWait);
+  if (!r) {
+    spdlog::error("{}", r.error());
+    return 1;
   }
 
-  p.usb.reserve(targets.size());
-  p.owned.reserve(targets.size());
-  p.ptrs.reserve(targets.size());
-
-  for (const auto& td : targets) {
-    auto ut = std::make_unique<brokkr::odin::UsbTarget>(td.devnode());
-
-    auto st = ut->dev.open_and_init();
-    if (!st) return brokkr::core::fail(std::move(st.error()));
-
-    auto cst = ut->conn.open();
-    if (!cst) return brokkr::core::fail(std::move(cst.error()));
+  if (r->normal_mode == 0) {
+    spdlog::info("No connected device needs reboot into Download Mode.");
+    return 0;
+  }
+  for (const auto& f : r->failures) spdlog::error("{}", f);
+  if (r->ports == 0) {
+    spdlog::error("No Samsung serial port found.");
+    return 1;
+  }
 
-    ut->conn.set_timeout_ms(cfg.preflash_timeout_ms);
+  spdlog::info("Reboot command sent to {} of {} Samsung serial port(s); {} device(s) back in Download Mode.", r->sent,
+               r->ports, r->odin.size());
+  for (const auto& s : r->odin) std::cout << s << "\tOdin Mode\n";
+  if (static_cast<int>(r->odin.size()) < r->sent) spdlog::warn("Not every device re-enumerated in Odin Mode in time.");
 
-    p.owned.push_back(brokkr::odin::Target{.id = ut->devnode, .link = &ut->conn});
-    p.ptrs.push_back(&p.owned.back());
-    p.usb.push_back(std::move(ut));
-  }
+  return r->failures.empty() && static_cast<int>(r->odin.size()) >= r->sent ? 0 : 1;
+}
 
-  return p;
+MemoryProfile memory_profile(const CliArgs& args) noexcept {
+  return args.low_memory ? MemoryProfile::Low : memory_profile_from_env();
 }
 
 int run_flash_cli(const CliArgs& args) {
@@ -407,14 +366,29 @@ int run_flash_cli(const CliArgs& args) {
     spdlog::error("Wireless cannot be used together with Target Sysname.");
     return 2;
   }
+  if (args.wireless && !args.remotes.empty()) {
+    spdlog::error("Wireless cannot be used together with remote agents.");
+    return 2;
+  }
 
-  auto pit_to_upload = load_pit_if_needed(args);
-  if (args.pit && !pit_to_upload) return 1;
+  std::shared_ptr<const std::vector<std::byte>> pit_to_upload;
+  if (args.pit) {
+    auto pr = load_pit_file(*args.pit);
+    if (!pr) {
+      spdlog::error("{}", pr.error());
+      return 1;
+    }
+    pit_to_upload = std::move(*pr);
+  }
 
   auto inputs = collect_inputs_in_gui_order(args);
 
+  const auto profile = memory_profile(args);
+  init_memory_profile(profile);
+
   brokkr::odin::Cfg cfg;
   cfg.reboot_after = !args.no_reboot;
+  apply_memory_profile(profile, cfg);
 
   std::atomic_bool saw_per_device_fail{false};
   std::optional<brokkr::core::SignalShield> sig_guard;
@@ -440,68 +414,253 @@ int run_flash_cli(const CliArgs& args) {
     spdlog::error("{}", s);
   };
 
-  auto provider_r = make_provider(args, cfg);
+  auto provider_r = make_provider(ProviderOpts{.target = args.target,
+                                               .wireless = args.wireless,
+                                               .remotes = args.remotes,
+                                               .remote_lz4 = args.remote_lz4},
+                                  cfg);
   if (!provider_r) {
-    spdlog::error("{}", map_global_error_to_cli_message(provider_r.error()));
+    spdlog::error("{}", user_facing_error(provider_r.error()));
     return 1;
   }
   auto provider = std::move(*provider_r);
 
-  std::vector<brokkr::odin::ImageSpec> specs;
-  if (!inputs.empty()) {
-    auto jobsr = brokkr::app::md5_jobs(inputs);
-    if (!jobsr) {
-      spdlog::error("{}", jobsr.error());
-      return 1;
+  auto pkgr = prepare_package(inputs, std::move(pit_to_upload), ui, hash_limits(profile));
+  if (!pkgr) {
+    spdlog::error("{}", pkgr.error());
+    return 1;
+  }
+  const auto& specs = pkgr->specs;
+  pit_to_upload = pkgr->pit;
+
+  auto fst = brokkr::odin::flash(provider.ptrs, specs, pit_to_upload, cfg, ui);
+  if (!fst) {
+    if (!saw_per_device_fail.load(std::memory_order_relaxed)) {
+      spdlog::error("{}", user_facing_error(fst.error()));
     }
+    return 1;
+  }
 
-    for (const auto& job : *jobsr) {
-      std::string name = job.path.filename().string();
-      if (name.empty()) name = job.path.string();
+  return 0;
+}
 
-      if (name.size() >= 11)
-        name = name.substr(0, 10) + "...";
+// One device held by --station between poll() and on_batch_done().
+struct StationDevice {
+  std::string sysname;
+  std::unique_ptr<brokkr::odin::UsbTarget> usb;
+  brokkr::odin::Target target;
+};
 
-      spdlog::info("Checking MD5/XXH3 on {}", name);
-    }
+int run_station_cli(const CliArgs& args) {
+  if (!has_any_file_selected(args)) {
+    spdlog::error("No files selected.");
+    return 2;
+  }
+  if (args.wireless || !args.remotes.empty() || (args.target && !args.target->empty())) {
+    spdlog::error("Station mode flashes every local Odin device and cannot be used with a target.");
+    return 2;
+  }
 
-    auto vst = brokkr::app::md5_verify(*jobsr, ui);
-    if (!vst) {
-      spdlog::error("{}", vst.error());
+  std::shared_ptr<const std::vector<std::byte>> pit_to_upload;
+  if (args.pit) {
+    auto pr = load_pit_file(*args.pit);
+    if (!pr) {
+      spdlog::error("{}", pr.error());
       return 1;
     }
+    pit_to_upload = std::move(*pr);
+  }
+
+  const auto profile = memory_profile(args);
+  init_memory_profile(profile);
 
-    auto specsr = brokkr::odin::expand_inputs_tar_or_raw(inputs);
-    if (!specsr) {
-      spdlog::error("{}", specsr.error());
+  brokkr::odin::Cfg cfg;
+  cfg.reboot_after = !args.no_reboot;
+  apply_memory_profile(profile, cfg);
+
+  std::optional<Experiment> exp;
+  std::filesystem::path results;
+  brokkr::odin::StationCfg scfg;
+  if (args.experiment) {
+    auto er = load_experiment(*args.experiment);
+    if (!er) {
+      spdlog::error("{}", er.error());
+      return 2;
+    }
+    auto cache = brokkr::platform::app_cache_dir();
+    if (!cache) {
+      spdlog::error("Cannot locate the cache directory for experiment results: {}", cache.error());
       return 1;
     }
-    specs = std::move(*specsr);
+    exp = std::move(*er);
+    results = experiment_results_file(*cache, exp->name);
+    for (const auto& v : exp->variants) scfg.variants.push_back(v.apply(cfg));
+  }
 
-    if (!pit_to_upload) {
-      if (auto pit = pit_from_specs(specs)) pit_to_upload = std::move(pit);
-    }
+  brokkr::odin::Ui hash_ui;
+  hash_ui.on_error = [](const std::string& s) { spdlog::error("{}", s); };
+  auto pkgr = prepare_package(collect_inputs_in_gui_order(args), std::move(pit_to_upload), hash_ui,
+                              hash_limits(profile));
+  if (!pkgr) {
+    spdlog::error("{}", pkgr.error());
+    return 1;
+  }
 
-    std::vector<brokkr::odin::ImageSpec> filtered;
-    filtered.reserve(specs.size());
-    for (auto& s : specs)
-      if (!is_pit_name(s.basename)) filtered.push_back(std::move(s));
-    specs = std::move(filtered);
+  // The first interrupt stops accepting devices; batches already attached still run to completion.
+  std::stop_source stop;
+  auto sig_guard = brokkr::core::SignalShield::enable([&stop](const char* sig_desc, int count) {
+    if (count == 1) spdlog::warn("{} received - finishing the devices already attached", sig_desc);
+    stop.request_stop();
+  });
+  if (!sig_guard) spdlog::warn("Failed to enable signal shielding; interrupts may terminate this flash run.");
+
+  std::mutex mu;
+  std::vector<std::unique_ptr<StationDevice>> attached;
+  std::unordered_set<std::string> finished; // sysnames not picked up again until they leave the bus
+
+  brokkr::odin::StationHooks hooks;
+  hooks.poll = [&] {
+    const auto all = enumerate_samsung_targets();
+    std::vector<brokkr::odin::Target*> out;
+
+    std::lock_guard lk(mu);
+    std::erase_if(finished, [&](const std::string& s) {
+      return std::none_of(all.begin(), all.end(), [&](const auto& d) { return d.sysname == s; });
+    });
+    for (const auto& d : all) {
+      if (!is_odin_product(d.product) || finished.contains(d.sysname)) continue;
+      if (std::any_of(attached.begin(), attached.end(), [&](const auto& a) { return a->sysname == d.sysname; })) {
+        continue;
+      }
 
-    if (specs.empty() && !pit_to_upload) {
-      spdlog::error("No valid flashable files.");
-      return 1;
+      auto ut = open_usb_target(d, cfg);
+      if (!ut) {
+        spdlog::error("{}: {}", d.sysname, user_facing_error(ut.error()));
+        finished.insert(d.sysname);
+        continue;
+      }
+      auto sd = std::make_unique<StationDevice>();
+      sd->sysname = d.sysname;
+      sd->usb = std::move(*ut);
+      sd->target = brokkr::odin::Target{.id = sd->usb->devnode, .link = &sd->usb->conn};
+      out.push_back(&sd->target);
+      attached.push_back(std::move(sd));
+    }
+    return out;
+  };
+  hooks.on_batch_done = [&](const std::vector<brokkr::odin::Target*>& devs, const brokkr::core::Status& st) {
+    if (!st) spdlog::error("{}", user_facing_error(st.error()));
+
+    std::lock_guard lk(mu);
+    std::erase_if(attached, [&](const std::unique_ptr<StationDevice>& a) {
+      if (std::find(devs.begin(), devs.end(), &a->target) == devs.end()) return false;
+      finished.insert(a->sysname);
+      return true;
+    });
+  };
+  hooks.ui_for = [](const std::vector<brokkr::odin::Target*>& devs) {
+    std::vector<std::string> ids;
+    ids.reserve(devs.size());
+    for (const auto* d : devs) ids.push_back(d->id);
+
+    brokkr::odin::Ui ui;
+    ui.on_progress = [](std::uint64_t, std::uint64_t, std::uint64_t, std::uint64_t) {};
+    ui.on_error = [ids = std::move(ids)](const std::string& s) {
+      constexpr std::string_view kTag = "DEVFAIL idx=";
+      std::size_t idx = 0;
+      if (s.rfind(kTag, 0) == 0) {
+        const auto* b = s.data() + kTag.size();
+        const auto [p, ec] = std::from_chars(b, s.data() + s.size(), idx);
+        if (ec == std::errc{} && idx < ids.size()) {
+          spdlog::error("{}:{}", ids[idx], std::string_view(p, s.data() + s.size() - p));
+          return;
+        }
+      }
+      spdlog::error("{}", s);
+    };
+    return ui;
+  };
+
+  // Storage write-speed baseline per cpu_bl_id, updated as devices finish.
+  FlushBaseline flush_base;
+  std::filesystem::path flush_file;
+  if (auto cache = brokkr::platform::app_cache_dir()) {
+    flush_file = flush_baseline_file(*cache);
+    if (auto fb = load_flush_baseline(flush_file)) {
+      flush_base = std::move(*fb);
+    } else {
+      spdlog::warn("{}; starting a new storage baseline", fb.error());
     }
   }
 
-  auto fst = brokkr::odin::flash(provider.ptrs, specs, pit_to_upload, cfg, ui);
-  if (!fst) {
-    if (!saw_per_device_fail.load(std::memory_order_relaxed)) {
-      spdlog::error("{}", map_global_error_to_cli_message(fst.error()));
+  std::optional<VariantPicker> picker;
+  if (exp) {
+    picker.emplace(*exp, std::random_device{}());
+    hooks.variant = [&](const brokkr::odin::Target&) { return picker->pick(); };
+    spdlog::info("Experiment '{}': {} variant(s), results in {}", exp->name, exp->variants.size(), results.string());
+  }
+
+  hooks.on_device_done = [&](const brokkr::odin::DeviceOutcome& o) {
+    const auto& bl = o.dev->pit_table.cpu_bl_id;
+    if (!o.flush.empty()) {
+      const auto v = score_flush(flush_base, bl, o.flush);
+      const auto level = v.outlier ? spdlog::level::warn : spdlog::level::debug;
+      for (const auto& p : o.flush) spdlog::log(level, "{}:   {}", o.dev->id, describe_part_flush(p));
+      spdlog::log(v.outlier ? spdlog::level::warn : spdlog::level::info, "{}: {}", o.dev->id, describe_flush(v, bl));
+      if (!flush_file.empty()) {
+        if (auto st = save_flush_baseline(flush_file, flush_base); !st) spdlog::warn("{}", st.error());
+      }
     }
+    if (!exp) return;
+
+    const auto& var = exp->variants[o.variant];
+    const double secs = std::chrono::duration<double>(o.data_time).count();
+    const ExperimentTrial t{
+        .time =
+            std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+                .count(),
+        .variant = var.name,
+        .cpu_bl_id = bl,
+        .ok = o.ok,
+        .bytes = o.bytes,
+        .seconds = secs,
+        .batch_devices = o.batch_devices};
+    if (o.ok && secs > 0) {
+      spdlog::info("{}: variant {} ok, {:.1f} MB/s", o.dev->id, var.name, static_cast<double>(o.bytes) / secs / 1e6);
+    } else {
+      spdlog::info("{}: variant {} {}", o.dev->id, var.name, o.ok ? "ok" : "failed");
+    }
+    if (auto st = append_experiment_trial(results, t); !st) spdlog::warn("Experiment results: {}", st.error());
+  };
+
+  spdlog::info("Station ready; plug in devices in Odin Mode.");
+  const auto stats = brokkr::odin::run_station(pkgr->specs, pkgr->pit, cfg, scfg, hooks, stop.get_token());
+  spdlog::info("Station: {} device(s) in {} batch(es), {} failed.", stats.devices, stats.batches, stats.failed);
+  return stats.failed ? 1 : 0;
+}
+
+int experiment_report_cli(const std::string& config) {
+  auto exp = load_experiment(config);
+  if (!exp) {
+    spdlog::error("{}", exp.error());
+    return 2;
+  }
+  auto cache = brokkr::platform::app_cache_dir();
+  if (!cache) {
+    spdlog::error("{}", cache.error());
     return 1;
   }
-
+  const auto file = experiment_results_file(*cache, exp->name);
+  auto trials = load_experiment_trials(file);
+  if (!trials) {
+    spdlog::error("{}", trials.error());
+    return 1;
+  }
+  if (trials->empty()) {
+    spdlog::info("No results recorded yet in {}", file.string());
+    return 0;
+  }
+  std::cout << format_experiment_report(*exp, *trials);
   return 0;
 }
 
@@ -514,15 +673,11 @@ bool should_run_cli(int argc, char* argv[]) noexcept {
   return false;
 }
 
+void print_cli_usage() { print_usage(); }
+
 int run_cli(int argc, char* argv[]) {
   configure_cli_logger();
 
-  auto lock = brokkr::platform::SingleInstanceLock::try_acquire("brokkr-engine");
-  if (!lock) {
-    spdlog::error("Another instance is already running.");
-    return 2;
-  }
-
   auto argsr = parse_cli_args(argc, argv);
   if (!argsr) {
     spdlog::error("{}", argsr.error());
@@ -536,7 +691,46 @@ int run_cli(int argc, char* argv[]) {
     return 0;
   }
 
+  const std::filesystem::path socket = args.socket ? std::filesystem::path(*args.socket) : default_daemon_socket();
+  if (args.serve) return run_daemon(socket, memory_profile(args));
+  if (args.agent) return run_agent(args.agent_port);
+  if (args.list && !args.remotes.empty()) return list_remote_devices_cli(args.remotes);
+  if (args.experiment_report) return experiment_report_cli(*args.experiment_report);
+  if (args.experiment && !args.station) {
+    spdlog::error("--experiment only applies to --station.");
+    return 2;
+  }
+
+  if (args.reboot_download) {
+    if (args.wireless || !args.remotes.empty()) {
+      spdlog::error("--reboot-download only applies to local USB devices.");
+      return 2;
+    }
+    const int rc = reboot_download_cli();
+    // With files, flash whatever made it into Odin Mode; the flash reports the rest.
+    if (!args.list && !has_any_file_selected(args)) return rc;
+  }
+
+  if (!args.no_daemon && !args.station && (args.list || has_any_file_selected(args))) {
+    DaemonJob job{.list = args.list,
+                  .inputs = collect_inputs_in_gui_order(args),
+                  .pit = args.pit ? std::optional<std::filesystem::path>(*args.pit) : std::nullopt,
+                  .devices = ProviderOpts{.target = args.target,
+                                          .wireless = args.wireless,
+                                          .remotes = args.remotes,
+                                          .remote_lz4 = args.remote_lz4},
+                  .no_reboot = args.no_reboot};
+    if (auto rc = run_via_daemon(socket, job)) return *rc;
+  }
+
+  auto lock = brokkr::platform::SingleInstanceLock::try_acquire("brokkr-engine");
+  if (!lock) {
+    spdlog::error("Another instance is already running.");
+    return 2;
+  }
+
   if (args.list) return list_devices_cli();
+  if (args.station) return run_station_cli(args);
 
   return run_flash_cli(args);
 }
@@ -21,5 +21,6 @@ namespace brokkr::app {
 
 bool should_run_cli(int argc, char* argv[]) noexcept;
 int run_cli(int argc, char* argv[]);
+void print_cli_usage();
 
 } // namespace brokkr::app
@@ -0,0 +1,584 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app/daemon.hpp"
+
+#include "core/json.hpp"
+#include "platform/platform_all.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/spdlog.h>
+
+namespace brokkr::app {
+
+#if defined(BROKKR_PLATFORM_WINDOWS)
+
+std::filesystem::path default_daemon_socket() {
+  auto dir = brokkr::platform::app_cache_dir();
+  return dir ? (*dir / "brokkr.sock") : std::filesystem::path("brokkr.sock");
+}
+
+int run_daemon(const std::filesystem::path&, MemoryProfile) {
+  spdlog::error("serve is not supported on this platform.");
+  return 2;
+}
+
+std::optional<int> run_via_daemon(const std::filesystem::path&, const DaemonJob&) { return std::nullopt; }
+
+#else
+
+namespace {
+
+using brokkr::core::Json;
+using brokkr::platform::UnixStream;
+
+constexpr int kRpcParseError = -32700;
+constexpr int kRpcMethodNotFound = -32601;
+constexpr int kRpcInvalidParams = -32602;
+constexpr int kRpcJobFailed = -32000;
+constexpr int kRpcDevFailed = -32001;
+
+constexpr std::size_t kMaxCachedPackages = 8;
+constexpr auto kProgressInterval = std::chrono::milliseconds(200);
+
+Json rpc_result(const Json& id, Json result) {
+  Json j;
+  j["jsonrpc"] = "2.0";
+  j["id"] = id;
+  j["result"] = std::move(result);
+  return j;
+}
+
+Json rpc_error(const Json& id, int code, std::string msg) {
+  Json j;
+  j["jsonrpc"] = "2.0";
+  j["id"] = id;
+  j["error"]["code"] = code;
+  j["error"]["message"] = std::move(msg);
+  return j;
+}
+
+Json rpc_event(Json params) {
+  Json j;
+  j["jsonrpc"] = "2.0";
+  j["method"] = "event";
+  j["params"] = std::move(params);
+  return j;
+}
+
+struct Client {
+  UnixStream stream;
+  std::mutex wmtx;
+
+  bool send(const Json& j) {
+    std::lock_guard lk(wmtx);
+    return stream.write_line(j.dump()).has_value();
+  }
+};
+
+// Forwards engine log lines to whichever client owns the engine.
+class ClientLogSink final : public spdlog::sinks::base_sink<std::mutex> {
+ public:
+  using Fn = std::function<void(spdlog::level::level_enum, std::string)>;
+
+  void attach(Fn fn) {
+    std::lock_guard lk(mutex_);
+    fn_ = std::move(fn);
+  }
+
+ protected:
+  void sink_it_(const spdlog::details::log_msg& msg) override {
+    if (fn_) fn_(msg.level, std::string(msg.payload.data(), msg.payload.size()));
+  }
+  void flush_() override {}
+
+ private:
+  Fn fn_;
+};
+
+class LogAttach {
+ public:
+  LogAttach(ClientLogSink& sink, Client& c) : sink_(sink) {
+    sink_.attach([&c](spdlog::level::level_enum lvl, std::string text) {
+      Json ev;
+      ev["type"] = "log";
+      ev["level"] = std::string(spdlog::level::to_string_view(lvl).data(), spdlog::level::to_string_view(lvl).size());
+      ev["text"] = std::move(text);
+      (void)c.send(rpc_event(std::move(ev)));
+    });
+  }
+  ~LogAttach() { sink_.attach({}); }
+
+  LogAttach(const LogAttach&) = delete;
+  LogAttach& operator=(const LogAttach&) = delete;
+
+ private:
+  ClientLogSink& sink_;
+};
+
+brokkr::odin::Ui make_event_ui(Client& c) {
+  brokkr::odin::Ui ui;
+  auto last_progress = std::make_shared<std::chrono::steady_clock::time_point>();
+
+  auto emit = [&c](Json ev) { (void)c.send(rpc_event(std::move(ev))); };
+
+  ui.on_devices = [emit](std::size_t n, const std::vector<std::string>& ids) {
+    Json ev;
+    ev["type"] = "devices";
+    ev["count"] = static_cast<std::uint64_t>(n);
+    for (const auto& id : ids) ev["ids"].push_back(id);
+    emit(std::move(ev));
+  };
+  ui.on_model = [emit](const std::string& s) {
+    Json ev;
+    ev["type"] = "model";
+    ev["text"] = s;
+    emit(std::move(ev));
+  };
+  ui.on_stage = [emit](const std::string& s) {
+    Json ev;
+    ev["type"] = "stage";
+    ev["text"] = s;
+    emit(std::move(ev));
+  };
+  ui.on_plan = [emit](const std::vector<brokkr::odin::PlanItem>& plan, std::uint64_t total) {
+    Json ev;
+    ev["type"] = "plan";
+    ev["total"] = total;
+    ev["items"] = Json::Array{};
+    for (const auto& it : plan) {
+      Json item;
+      item["kind"] = it.kind == brokkr::odin::PlanItem::Kind::Pit ? "pit" : "part";
+      item["name"] = it.part_name;
+      item["file"] = it.pit_file_name;
+      item["source"] = it.source_base;
+      item["size"] = it.size;
+      ev["items"].push_back(std::move(item));
+    }
+    emit(std::move(ev));
+  };
+  ui.on_item_active = [emit](std::size_t i) {
+    Json ev;
+    ev["type"] = "item_active";
+    ev["index"] = static_cast<std::uint64_t>(i);
+    emit(std::move(ev));
+  };
+  ui.on_item_done = [emit](std::size_t i) {
+    Json ev;
+    ev["type"] = "item_done";
+    ev["index"] = static_cast<std::uint64_t>(i);
+    emit(std::move(ev));
+  };
+  ui.on_progress = [emit, last_progress](std::uint64_t done, std::uint64_t total, std::uint64_t item_done,
+                                         std::uint64_t item_total) {
+    const auto now = std::chrono::steady_clock::now();
+    if (done != total && now - *last_progress < kProgressInterval) return;
+    *last_progress = now;
+
+    Json ev;
+    ev["type"] = "progress";
+    ev["done"] = done;
+    ev["total"] = total;
+    ev["item_done"] = item_done;
+    ev["item_total"] = item_total;
+    emit(std::move(ev));
+  };
+  ui.on_done = [emit] {
+    Json ev;
+    ev["type"] = "done";
+    emit(std::move(ev));
+  };
+  return ui;
+}
+
+brokkr::core::Result<std::vector<std::filesystem::path>> parse_paths(const Json* arr) {
+  std::vector<std::filesystem::path> out;
+  if (!arr) return out;
+  if (!arr->is_array()) return brokkr::core::fail("inputs must be an array of paths");
+  for (const auto& v : arr->array()) {
+    if (!v.is_string() || v.as_string().empty()) return brokkr::core::fail("inputs must be an array of paths");
+    std::filesystem::path p(v.as_string());
+    if (!p.is_absolute()) return brokkr::core::failf("Path must be absolute: {}", p.string());
+    out.push_back(std::move(p));
+  }
+  return out;
+}
+
+std::optional<std::filesystem::path> opt_path(const Json& params, std::string_view key) {
+  const Json* v = params.find(key);
+  if (!v || !v->is_string() || v->as_string().empty()) return std::nullopt;
+  return std::filesystem::path(v->as_string());
+}
+
+class Daemon {
+ public:
+  Daemon(std::shared_ptr<ClientLogSink> sink, MemoryProfile profile) : sink_(std::move(sink)), profile_(profile) {}
+
+  int run(const std::filesystem::path& socket);
+
+ private:
+  struct CachedPackage {
+    std::string key;
+    std::vector<std::filesystem::path> inputs;
+    std::optional<std::filesystem::path> pit;
+    std::shared_ptr<const Package> pkg;
+  };
+
+  void serve_client_(Client& c);
+  Json dispatch_(const Json& req, Client& c);
+
+  Json list_devices_(const Json& id);
+  Json prepare_(const Json& id, const Json& params, Client& c);
+  Json flash_(const Json& id, const Json& params, Client& c);
+
+  brokkr::core::Result<std::pair<std::string, std::shared_ptr<const Package>>> package_for_(
+      const Json& params, const brokkr::odin::Ui& ui);
+
+ private:
+  std::shared_ptr<ClientLogSink> sink_;
+  MemoryProfile profile_ = MemoryProfile::Default;
+  std::atomic_bool stop_{false};
+
+  // One engine: package preparation and flashing are serialized across clients.
+  std::mutex engine_mtx_;
+  std::map<std::string, CachedPackage> packages_;
+  std::vector<std::string> package_order_;
+  std::uint64_t next_package_ = 1;
+};
+
+Json Daemon::list_devices_(const Json& id) {
+  Json arr = Json::Array{};
+  for (const auto& d : enumerate_samsung_targets()) {
+    Json dev;
+    dev["sysname"] = d.sysname;
+    dev["devnode"] = d.devnode();
+    dev["odin"] = is_odin_product(d.product);
+    arr.push_back(std::move(dev));
+  }
+  return rpc_result(id, std::move(arr));
+}
+
+brokkr::core::Result<std::pair<std::string, std::shared_ptr<const Package>>> Daemon::package_for_(
+    const Json& params, const brokkr::odin::Ui& ui) {
+  if (const Json* pid = params.find("package"); pid && pid->is_string()) {
+    const auto it = packages_.find(pid->as_string());
+    if (it == packages_.end()) return brokkr::core::failf("Unknown package: {}", pid->as_string());
+
+    BRK_TRYV(key, package_key(it->second.inputs, it->second.pit));
+    if (key != it->second.key) return brokkr::core::failf("Package {} changed on disk; prepare it again", it->first);
+    return std::pair{it->first, it->second.pkg};
+  }
+
+  BRK_TRYV(inputs, parse_paths(params.find("inputs")));
+  const auto pit_path = opt_path(params, "pit");
+  if (inputs.empty() && !pit_path) return brokkr::core::fail("No files selected.");
+
+  BRK_TRYV(key, package_key(inputs, pit_path));
+  for (const auto& [pid, cp] : packages_)
+    if (cp.key == key) return std::pair{pid, cp.pkg};
+
+  std::shared_ptr<const std::vector<std::byte>> pit;
+  if (pit_path) {
+    BRK_TRYV(loaded, load_pit_file(*pit_path));
+    pit = std::move(loaded);
+  }
+  BRK_TRYV(pkg, prepare_package(inputs, std::move(pit), ui, hash_limits(profile_)));
+
+  if (package_order_.size() >= kMaxCachedPackages) {
+    packages_.erase(package_order_.front());
+    package_order_.erase(package_order_.begin());
+  }
+
+  std::string pid = fmt::format("pkg-{}", next_package_++);
+  auto shared = std::make_shared<const Package>(std::move(pkg));
+  packages_.emplace(pid, CachedPackage{std::move(key), std::move(inputs), pit_path, shared});
+  package_order_.push_back(pid);
+  return std::pair{std::move(pid), std::move(shared)};
+}
+
+Json Daemon::prepare_(const Json& id, const Json& params, Client& c) {
+  std::lock_guard lk(engine_mtx_);
+  LogAttach attach(*sink_, c);
+
+  auto pr = package_for_(params, make_event_ui(c));
+  if (!pr) return rpc_error(id, kRpcJobFailed, std::move(pr.error()));
+
+  Json res;
+  res["package"] = pr->first;
+  res["pit"] = static_cast<bool>(pr->second->pit);
+  res["items"] = Json::Array{};
+  for (const auto& s : pr->second->specs) {
+    Json item;
+    item["name"] = s.basename;
+    item["size"] = s.size;
+    item["lz4"] = s.lz4;
+    res["items"].push_back(std::move(item));
+  }
+  return rpc_result(id, std::move(res));
+}
+
+Json Daemon::flash_(const Json& id, const Json& params, Client& c) {
+  std::lock_guard lk(engine_mtx_);
+  LogAttach attach(*sink_, c);
+
+  std::atomic_bool saw_per_device_fail{false};
+  auto ui = make_event_ui(c);
+  ui.on_error = [&](const std::string& s) {
+    if (s.rfind("DEVFAIL idx=", 0) == 0) saw_per_device_fail.store(true, std::memory_order_relaxed);
+    spdlog::error("{}", s);
+  };
+
+  ProviderOpts devices;
+  devices.wireless = params.find("wireless") && params.find("wireless")->as_bool();
+  if (auto t = params.find("target"); t && t->is_string() && !t->as_string().empty()) devices.target = t->as_string();
+  if (auto r = params.find("remotes"); r && r->is_array())
+    for (const auto& e : r->array())
+      if (e.is_string()) devices.remotes.push_back(e.as_string());
+  devices.remote_lz4 = params.find("remote_lz4") && params.find("remote_lz4")->as_bool();
+  if (devices.wireless && devices.target) {
+    return rpc_error(id, kRpcInvalidParams, "Wireless cannot be used together with Target Sysname.");
+  }
+  if (devices.wireless && !devices.remotes.empty()) {
+    return rpc_error(id, kRpcInvalidParams, "Wireless cannot be used together with remote agents.");
+  }
+
+  auto pr = package_for_(params, ui);
+  if (!pr) return rpc_error(id, kRpcJobFailed, std::move(pr.error()));
+  const auto pkg = pr->second;
+
+  brokkr::odin::Cfg cfg;
+  cfg.reboot_after = !(params.find("no_reboot") && params.find("no_reboot")->as_bool());
+  apply_memory_profile(profile_, cfg);
+
+  auto provider = make_provider(devices, cfg);
+  if (!provider) return rpc_error(id, kRpcJobFailed, std::move(provider.error()));
+
+  auto fst = brokkr::odin::flash(provider->ptrs, pkg->specs, pkg->pit, cfg, ui);
+  if (!fst) {
+    const bool devfail = saw_per_device_fail.load(std::memory_order_relaxed);
+    return rpc_error(id, devfail ? kRpcDevFailed : kRpcJobFailed, std::move(fst.error()));
+  }
+
+  Json res;
+  res["package"] = pr->first;
+  return rpc_result(id, std::move(res));
+}
+
+Json Daemon::dispatch_(const Json& req, Client& c) {
+  const Json id = req.find("id") ? *req.find("id") : Json{};
+  const Json* m = req.find("method");
+  if (!m || !m->is_string()) return rpc_error(id, kRpcInvalidParams, "missing method");
+
+  static const Json kNoParams = Json::Object{};
+  const Json* params = req.find("params");
+  if (!params) params = &kNoParams;
+  if (!params->is_object()) return rpc_error(id, kRpcInvalidParams, "params must be an object");
+
+  const std::string method = m->as_string();
+  if (method == "devices.list") return list_devices_(id);
+  if (method == "package.prepare") return prepare_(id, *params, c);
+  if (method == "flash") return flash_(id, *params, c);
+  if (method == "daemon.stop") {
+    stop_.store(true);
+    return rpc_result(id, true);
+  }
+  return rpc_error(id, kRpcMethodNotFound, "Unknown method: " + method);
+}
+
+void Daemon::serve_client_(Client& c) {
+  while (!stop_.load()) {
+    auto lr = c.stream.read_line(200);
+    if (!lr) {
+      if (lr.error() == "UnixStream: timeout") continue;
+      spdlog::debug("daemon client: {}", lr.error());
+      return;
+    }
+    if (!*lr) return;
+    if ((*lr)->empty()) continue;
+
+    auto req = Json::parse(**lr);
+    const Json resp = req ? dispatch_(*req, c) : rpc_error(Json{}, kRpcParseError, std::move(req.error()));
+    if (!c.send(resp)) return;
+  }
+}
+
+int Daemon::run(const std::filesystem::path& socket) {
+  brokkr::platform::UnixListener listener;
+  if (auto st = listener.bind_and_listen(socket); !st) {
+    spdlog::error("{}", st.error());
+    return 1;
+  }
+
+  auto shield = brokkr::core::SignalShield::enable([this](const char* sig_desc, int) {
+    spdlog::info("{} received, shutting down after the current job", sig_desc);
+    stop_.store(true);
+  });
+  if (!shield) spdlog::warn("Failed to enable signal shielding; interrupts may terminate an active flash.");
+
+  spdlog::info("Listening on {}", socket.string());
+
+  struct Conn {
+    std::unique_ptr<Client> client;
+    std::shared_ptr<std::atomic_bool> finished;
+    std::jthread th;
+  };
+  std::vector<Conn> conns;
+
+  while (!stop_.load()) {
+    std::erase_if(conns, [](const Conn& cn) { return cn.finished->load(); });
+
+    auto ar = listener.accept_one();
+    if (!ar) {
+      if (ar.error() == "accept: timeout") continue;
+      spdlog::error("{}", ar.error());
+      break;
+    }
+
+    Conn cn{std::make_unique<Client>(), std::make_shared<std::atomic_bool>(false), {}};
+    cn.client->stream = std::move(*ar);
+    cn.th = std::jthread([this, c = cn.client.get(), fin = cn.finished] {
+      serve_client_(*c);
+      fin->store(true);
+    });
+    conns.push_back(std::move(cn));
+  }
+
+  listener.close();
+  conns.clear();
+  return 0;
+}
+
+} // namespace
+
+std::filesystem::path default_daemon_socket() {
+  if (const char* rt = std::getenv("XDG_RUNTIME_DIR"); rt && *rt) return std::filesystem::path(rt) / "brokkr.sock";
+  auto dir = brokkr::platform::app_cache_dir();
+  return dir ? (*dir / "brokkr.sock") : std::filesystem::path("/tmp/brokkr.sock");
+}
+
+int run_daemon(const std::filesystem::path& socket, MemoryProfile profile) {
+  auto lock = brokkr::platform::SingleInstanceLock::try_acquire("brokkr-engine");
+  if (!lock) {
+    spdlog::error("Another instance is already running.");
+    return 2;
+  }
+
+  auto sink = std::make_shared<ClientLogSink>();
+  spdlog::default_logger()->sinks().push_back(sink);
+
+  init_memory_profile(profile);
+  if (profile == MemoryProfile::Low) spdlog::info("Low-memory profile enabled");
+
+  Daemon d(sink, profile);
+  const int rc = d.run(socket);
+
+  auto& sinks = spdlog::default_logger()->sinks();
+  std::erase(sinks, sink);
+  return rc;
+}
+
+std::optional<int> run_via_daemon(const std::filesystem::path& socket, const DaemonJob& job) {
+  auto sr = UnixStream::connect(socket);
+  if (!sr) return std::nullopt;
+  auto& s = *sr;
+
+  Json req;
+  req["jsonrpc"] = "2.0";
+  req["id"] = 1;
+  if (job.list) {
+    req["method"] = "devices.list";
+  } else {
+    req["method"] = "flash";
+    auto& p = req["params"];
+    p["inputs"] = Json::Array{};
+    for (const auto& in : job.inputs) p["inputs"].push_back(std::filesystem::absolute(in).string());
+    if (job.pit) p["pit"] = std::filesystem::absolute(*job.pit).string();
+    if (job.devices.target) p["target"] = *job.devices.target;
+    p["wireless"] = job.devices.wireless;
+    if (!job.devices.remotes.empty()) {
+      p["remotes"] = Json::Array{};
+      for (const auto& r : job.devices.remotes) p["remotes"].push_back(r);
+      p["remote_lz4"] = job.devices.remote_lz4;
+    }
+    p["no_reboot"] = job.no_reboot;
+  }
+
+  if (auto st = s.write_line(req.dump()); !st) return std::nullopt;
+  spdlog::debug("Forwarding to daemon at {}", socket.string());
+
+  for (;;) {
+    auto lr = s.read_line();
+    if (!lr || !*lr) {
+      spdlog::error("Lost connection to daemon{}", lr ? std::string() : ": " + lr.error());
+      return 1;
+    }
+
+    auto msg = Json::parse(**lr);
+    if (!msg) {
+      spdlog::error("Bad daemon message: {}", msg.error());
+      return 1;
+    }
+
+    if (const Json* m = msg->find("method"); m && m->as_string() == "event") {
+      const Json* params = msg->find("params");
+      if (params && params->find("type") && params->find("type")->as_string() == "log") {
+        const auto lvl = spdlog::level::from_str(params->find("level") ? params->find("level")->as_string() : "info");
+        spdlog::log(lvl, "{}", params->find("text") ? params->find("text")->as_string() : "");
+      }
+      continue;
+    }
+
+    if (const Json* err = msg->find("error")) {
+      const auto code = err->find("code") ? err->find("code")->as_int() : kRpcJobFailed;
+      // Per-device failures were already streamed as log lines.
+      if (code != kRpcDevFailed) {
+        spdlog::error("{}", user_facing_error(err->find("message") ? err->find("message")->as_string() : ""));
+      }
+      return code == kRpcInvalidParams ? 2 : 1;
+    }
+
+    if (job.list) {
+      const auto& devs = msg->find("result") ? msg->find("result")->array() : Json::Array{};
+      if (devs.empty()) {
+        std::cout << "No Samsung devices found.\n";
+        return 0;
+      }
+      for (const auto& d : devs) {
+        std::cout << (d.find("sysname") ? d.find("sysname")->as_string() : "") << "\t"
+                  << ((d.find("odin") && d.find("odin")->as_bool()) ? "Odin Mode" : "Not in Odin Mode") << "\n";
+      }
+    }
+    return 0;
+  }
+}
+
+#endif
+
+} // namespace brokkr::app
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "app/engine.hpp"
+
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace brokkr::app {
+
+// `brokkr serve`: JSON-RPC 2.0 over a Unix domain socket, one request per line.
+//   devices.list    -> [{sysname, devnode, odin}]
+//   package.prepare {inputs, pit?}                 -> {package, items, pit}
+//   flash           {package | inputs, pit?, target?, wireless?, no_reboot?}
+//                   streams {"method":"event"} notifications until the final response
+//   daemon.stop
+std::filesystem::path default_daemon_socket();
+int run_daemon(const std::filesystem::path& socket, MemoryProfile profile = MemoryProfile::Default);
+
+struct DaemonJob {
+  bool list = false;
+
+  std::vector<std::filesystem::path> inputs;
+  std::optional<std::filesystem::path> pit;
+  ProviderOpts devices;
+  bool no_reboot = false;
+};
+
+// Runs the job on a daemon listening at `socket`; std::nullopt when none is reachable.
+std::optional<int> run_via_daemon(const std::filesystem::path& socket, const DaemonJob& job);
+
+} // namespace brokkr::app
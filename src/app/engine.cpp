@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app/engine.hpp"
+
+#include "app/md5_verify.hpp"
+#include "core/buffer_pool.hpp"
+#include "core/str.hpp"
+#include "io/source.hpp"
+#include "protocol/relay/relay_wire.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <thread>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+namespace brokkr::app {
+
+bool is_odin_product(std::uint16_t pid) noexcept {
+  return std::find(std::begin(kOdinPids), std::end(kOdinPids), pid) != std::end(kOdinPids);
+}
+
+std::vector<brokkr::platform::UsbDeviceSysfsInfo> enumerate_samsung_targets() {
+  brokkr::platform::EnumerateFilter f{.vendor = kSamsungVid};
+  return brokkr::platform::enumerate_usb_devices_sysfs(f);
+}
+
+std::optional<brokkr::platform::UsbDeviceSysfsInfo> select_samsung_target(std::string_view sysname) {
+  if (sysname.empty()) return std::nullopt;
+  auto info = brokkr::platform::find_by_sysname(sysname);
+  if (!info || info->vendor != kSamsungVid) return std::nullopt;
+  return info;
+}
+
+brokkr::core::Result<RebootToDownload> reboot_to_download(std::chrono::milliseconds wait) {
+#if !defined(BROKKR_HAS_SUDDLMOD)
+  (void)wait;
+  return brokkr::core::fail("Rebooting into Download Mode is not supported on this platform.");
+#else
+  RebootToDownload out;
+  std::set<std::string> odin_before;
+  for (const auto& d : enumerate_samsung_targets()) {
+    if (is_odin_product(d.product)) {
+      odin_before.insert(d.sysname);
+    } else {
+      ++out.normal_mode;
+    }
+  }
+  if (out.normal_mode == 0) return out;
+
+  auto r = brokkr::platform::send_suddlmod_to_samsung_serial(kSamsungVid, out.normal_mode);
+  out.ports = r.ports_seen;
+  out.sent = r.sent_ok;
+  out.failures = std::move(r.failures);
+  if (out.sent == 0) return out;
+
+  const auto deadline = std::chrono::steady_clock::now() + wait;
+  for (;;) {
+    out.odin.clear();
+    for (const auto& d : enumerate_samsung_targets()) {
+      if (is_odin_product(d.product) && !odin_before.contains(d.sysname)) out.odin.push_back(d.sysname);
+    }
+    if (static_cast<int>(out.odin.size()) >= out.sent || std::chrono::steady_clock::now() >= deadline) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+  }
+  return out;
+#endif
+}
+
+namespace {
+
+constexpr std::size_t kLowMemWindowPackets = 4;
+constexpr std::size_t kLowMemHashBufBytes = 2ull * 1024 * 1024;
+constexpr std::size_t kLowMemHashJobs = 2;
+constexpr std::size_t kLowMemPoolBytes = 8ull * 1024 * 1024;
+
+} // namespace
+
+MemoryProfile memory_profile_from_env() noexcept {
+  const char* v = std::getenv("BROKKR_LOW_MEMORY");
+  return (v && *v && std::string_view(v) != "0") ? MemoryProfile::Low : MemoryProfile::Default;
+}
+
+void init_memory_profile(MemoryProfile p) noexcept {
+  if (p == MemoryProfile::Low) brokkr::core::buffer_pool().set_max_retained(kLowMemPoolBytes);
+}
+
+void apply_memory_profile(MemoryProfile p, brokkr::odin::Cfg& cfg) noexcept {
+  if (p != MemoryProfile::Low) return;
+  cfg.window_packets = kLowMemWindowPackets;
+  cfg.decode_workers = 1;
+}
+
+HashLimits hash_limits(MemoryProfile p) noexcept {
+  if (p != MemoryProfile::Low) return {};
+  return HashLimits{.buf_bytes = kLowMemHashBufBytes, .max_jobs = kLowMemHashJobs};
+}
+
+bool is_pit_name(std::string_view base) noexcept { return brokkr::core::ends_with_ci(base, ".pit"); }
+
+brokkr::core::Result<std::shared_ptr<const std::vector<std::byte>>> load_pit_file(const std::filesystem::path& p) {
+  std::error_code ec;
+  const auto sz = std::filesystem::file_size(p, ec);
+  if (ec) return brokkr::core::fail("Cannot stat PIT file.");
+
+  std::vector<std::byte> buf(static_cast<std::size_t>(sz));
+  std::ifstream in(p, std::ios::binary);
+  if (!in.is_open()) return brokkr::core::fail("Cannot open PIT file.");
+
+  if (!buf.empty()) {
+    in.read(reinterpret_cast<char*>(buf.data()), static_cast<std::streamsize>(buf.size()));
+    if (!in.good()) return brokkr::core::fail("Failed to read PIT file.");
+  }
+
+  return std::make_shared<const std::vector<std::byte>>(std::move(buf));
+}
+
+brokkr::core::Result<std::string> package_key(const std::vector<std::filesystem::path>& inputs,
+                                              const std::optional<std::filesystem::path>& pit) {
+  std::string key;
+  auto add = [&](const std::filesystem::path& p) -> brokkr::core::Status {
+    std::error_code ec;
+    const auto sz = std::filesystem::file_size(p, ec);
+    if (ec) return brokkr::core::failf("Cannot stat {}", p.string());
+    const auto mt = std::filesystem::last_write_time(p, ec);
+    if (ec) return brokkr::core::failf("Cannot stat {}", p.string());
+    key += fmt::format("{}|{}|{};", p.string(), sz, mt.time_since_epoch().count());
+    return {};
+  };
+  for (const auto& p : inputs) BRK_TRY(add(p));
+  if (pit) {
+    key += "pit:";
+    BRK_TRY(add(*pit));
+  }
+  return key;
+}
+
+brokkr::core::Result<std::pair<std::string, std::uint16_t>> parse_remote_spec(std::string_view spec) {
+  const auto colon = spec.rfind(':');
+  if (colon == std::string_view::npos) return std::pair{std::string(spec), brokkr::relay::kDefaultPort};
+
+  unsigned port = 0;
+  const auto ps = spec.substr(colon + 1);
+  const auto [ptr, ec] = std::from_chars(ps.data(), ps.data() + ps.size(), port);
+  if (ec != std::errc{} || ptr != ps.data() + ps.size() || port == 0 || port > 65535)
+    return brokkr::core::failf("Invalid remote address: {}", spec);
+  return std::pair{std::string(spec.substr(0, colon)), static_cast<std::uint16_t>(port)};
+}
+
+namespace {
+
+brokkr::core::Result<std::shared_ptr<const std::vector<std::byte>>> pit_from_specs(
+    const std::vector<brokkr::odin::ImageSpec>& specs) {
+  const brokkr::odin::ImageSpec* pit = nullptr;
+  for (const auto& s : specs)
+    if (is_pit_name(s.basename)) pit = &s;
+  if (!pit) return std::shared_ptr<const std::vector<std::byte>>{};
+
+  auto sr = pit->open();
+  if (!sr) return brokkr::core::failf("PIT open failed: {}", sr.error());
+  auto& src = **sr;
+
+  constexpr std::uint64_t kMaxPit = 256ull * 1024ull * 1024ull;
+  const auto sz64 = src.size();
+  if (sz64 > kMaxPit) return brokkr::core::failf("Embedded PIT too large: {}", src.display_name());
+
+  std::vector<std::byte> out(static_cast<std::size_t>(sz64));
+  for (std::size_t off = 0; off < out.size();) {
+    const std::size_t got = src.read({out.data() + off, out.size() - off});
+    if (!got) {
+      auto st = src.status();
+      if (!st) return brokkr::core::failf("PIT read failed: {}", st.error());
+      return brokkr::core::failf("Short read on embedded PIT: {}", src.display_name());
+    }
+    off += got;
+  }
+
+  return std::make_shared<const std::vector<std::byte>>(std::move(out));
+}
+
+brokkr::core::Status open_remotes(Provider& p, const ProviderOpts& opts, const brokkr::odin::Cfg& cfg) {
+  for (const auto& spec : opts.remotes) {
+    BRK_TRYV(hp, parse_remote_spec(spec));
+    const auto& [host, port] = hp;
+
+    auto devs = brokkr::relay::list_remote_devices(host, port);
+    if (!devs) return brokkr::core::failf("Agent {} unreachable: {}", spec, devs.error());
+    if (devs->empty()) spdlog::info("Agent {} has no devices in Odin Mode", spec);
+
+    for (const auto& d : *devs) {
+      if (opts.target && !opts.target->empty() && d.sysname != *opts.target) continue;
+
+      BRK_TRYV(rt, brokkr::relay::RemoteTransport::open(host, port, d.devnode, opts.remote_lz4));
+      auto link = std::make_unique<brokkr::relay::RemoteTransport>(std::move(rt));
+      link->set_timeout_ms(cfg.preflash_timeout_ms);
+      p.remote.push_back(std::move(link));
+    }
+  }
+  if (p.remote.empty()) return brokkr::core::fail("No connected devices detected.");
+
+  p.owned.reserve(p.remote.size());
+  for (const auto& r : p.remote) {
+    p.owned.push_back(brokkr::odin::Target{.id = r->label(), .link = r.get()});
+    p.ptrs.push_back(&p.owned.back());
+  }
+  return {};
+}
+
+} // namespace
+
+brokkr::core::Result<std::unique_ptr<brokkr::odin::UsbTarget>> open_usb_target(
+    const brokkr::platform::UsbDeviceSysfsInfo& info, const brokkr::odin::Cfg& cfg) {
+  auto ut = std::make_unique<brokkr::odin::UsbTarget>(info.devnode());
+
+  auto st = ut->dev.open_and_init();
+  if (!st) return brokkr::core::fail(std::move(st.error()));
+
+  auto cst = ut->conn.open();
+  if (!cst) return brokkr::core::fail(std::move(cst.error()));
+
+  ut->conn.set_timeout_ms(cfg.preflash_timeout_ms);
+  return ut;
+}
+
+brokkr::core::Result<Provider> make_provider(const ProviderOpts& opts, const brokkr::odin::Cfg& cfg) {
+  Provider p;
+
+  if (opts.wireless) {
+    brokkr::platform::TcpListener listener;
+    BRK_TRY(listener.bind_and_listen("0.0.0.0", kWirelessPort));
+
+    spdlog::info("Waiting for connection on port {}", kWirelessPort);
+
+    for (;;) {
+      auto ar = listener.accept_one();
+      if (ar) {
+        p.wireless_conn = std::make_unique<brokkr::platform::TcpConnection>(std::move(*ar));
+        break;
+      }
+      if (ar.error() != "accept: timeout") return brokkr::core::fail(std::move(ar.error()));
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    p.owned.push_back(brokkr::odin::Target{.id = "wireless", .link = p.wireless_conn.get()});
+    p.ptrs.push_back(&p.owned.back());
+    return p;
+  }
+
+  if (!opts.remotes.empty()) {
+    BRK_TRY(open_remotes(p, opts, cfg));
+    return p;
+  }
+
+  std::vector<brokkr::platform::UsbDeviceSysfsInfo> targets;
+  if (opts.target && !opts.target->empty()) {
+    auto info = select_samsung_target(*opts.target);
+    if (!info) return brokkr::core::fail("Target sysname not found.");
+    if (!is_odin_product(info->product)) {
+      return brokkr::core::fail("The device is not in Odin Mode, reboot to download mode first.");
+    }
+    targets.push_back(*info);
+  } else {
+    const auto all_samsung = enumerate_samsung_targets();
+    if (all_samsung.empty()) return brokkr::core::fail("No connected devices detected.");
+
+    for (const auto& d : all_samsung) {
+      if (is_odin_product(d.product)) {
+        targets.push_back(d);
+      } else {
+        spdlog::info("{} is not in Odin Mode hence ignored", d.sysname);
+      }
+    }
+
+    if (targets.empty()) return brokkr::core::fail("None of the devices are in Odin Mode");
+  }
+
+  p.usb.reserve(targets.size());
+  p.owned.reserve(targets.size());
+  p.ptrs.reserve(targets.size());
+
+  for (const auto& td : targets) {
+    BRK_TRYV(ut, open_usb_target(td, cfg));
+
+    p.owned.push_back(brokkr::odin::Target{.id = ut->devnode, .link = &ut->conn});
+    p.ptrs.push_back(&p.owned.back());
+    p.usb.push_back(std::move(ut));
+  }
+
+  return p;
+}
+
+brokkr::core::Result<Package> prepare_package(const std::vector<std::filesystem::path>& inputs,
+                                              std::shared_ptr<const std::vector<std::byte>> pit,
+                                              const brokkr::odin::Ui& ui, const HashLimits& limits) {
+  Package out;
+  out.pit = std::move(pit);
+  if (inputs.empty()) return out;
+
+  BRK_TRYV(jobs, md5_jobs(inputs));
+
+  for (const auto& job : jobs) {
+    std::string name = job.path.filename().string();
+    if (name.empty()) name = job.path.string();
+
+    if (name.size() >= 11)
+      name = name.substr(0, 10) + "...";
+
+    spdlog::info("Checking MD5/XXH3 on {}", name);
+  }
+
+  BRK_TRY(md5_verify(jobs, ui, limits));
+  BRK_TRYV(specs, brokkr::odin::expand_inputs_tar_or_raw(inputs));
+
+  if (!out.pit) {
+    if (auto embedded = pit_from_specs(specs))
+      out.pit = std::move(*embedded);
+    else
+      spdlog::error("{}", embedded.error());
+  }
+
+  out.specs.reserve(specs.size());
+  for (auto& s : specs)
+    if (!is_pit_name(s.basename)) out.specs.push_back(std::move(s));
+
+  if (out.specs.empty() && !out.pit) return brokkr::core::fail("No valid flashable files.");
+  return out;
+}
+
+std::string user_facing_error(const std::string& err) {
+  const auto has_ic = [&](std::string_view needle) {
+    auto it = std::search(err.begin(), err.end(), needle.begin(), needle.end(), [](char a, char b) {
+      return brokkr::core::ascii_lower(static_cast<unsigned char>(a)) ==
+             brokkr::core::ascii_lower(static_cast<unsigned char>(b));
+    });
+    return it != err.end();
+  };
+
+  if (has_ic("mismatch across devices") || has_ic("differs across devices")) {
+    return "The connected devices do not match!";
+  }
+
+  return err;
+}
+
+} // namespace brokkr::app
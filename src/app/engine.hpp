@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "app/md5_verify.hpp"
+#include "core/status.hpp"
+#include "platform/platform_all.hpp"
+#include "protocol/odin/flash.hpp"
+#include "protocol/odin/group_flasher.hpp"
+#include "protocol/relay/remote_transport.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace brokkr::app {
+
+inline constexpr std::uint16_t kSamsungVid = 0x04E8;
+inline constexpr std::uint16_t kOdinPids[] = {0x6601, 0x685D, 0x68C3};
+inline constexpr std::uint16_t kWirelessPort = 13579;
+
+bool is_odin_product(std::uint16_t pid) noexcept;
+std::vector<brokkr::platform::UsbDeviceSysfsInfo> enumerate_samsung_targets();
+std::optional<brokkr::platform::UsbDeviceSysfsInfo> select_samsung_target(std::string_view sysname);
+
+struct RebootToDownload {
+  int normal_mode = 0; // Samsung devices not in Odin mode before the command
+  int ports = 0;       // serial ports the command was sent to
+  int sent = 0;
+  std::vector<std::string> failures;
+  std::vector<std::string> odin; // sysnames that came back with an Odin PID
+};
+
+// Sends AT+SUDDLMOD to every Samsung device in normal mode at once, then polls until as many new Odin
+// devices as commands sent have enumerated, or `wait` has passed. Fails where the platform has no serial path.
+brokkr::core::Result<RebootToDownload> reboot_to_download(std::chrono::milliseconds wait);
+
+struct Provider {
+  std::vector<std::unique_ptr<brokkr::odin::UsbTarget>> usb;
+  std::vector<brokkr::odin::Target> owned;
+  std::vector<brokkr::odin::Target*> ptrs;
+  std::unique_ptr<brokkr::platform::TcpConnection> wireless_conn;
+  std::vector<std::unique_ptr<brokkr::relay::RemoteTransport>> remote;
+};
+
+struct ProviderOpts {
+  std::optional<std::string> target;
+  bool wireless = false;
+  std::vector<std::string> remotes; // host[:port] of `brokkr agent`s; replaces local USB when set
+  bool remote_lz4 = false;
+};
+
+// "host[:port]"; the port defaults to the relay agent's.
+brokkr::core::Result<std::pair<std::string, std::uint16_t>> parse_remote_spec(std::string_view spec);
+
+brokkr::core::Result<Provider> make_provider(const ProviderOpts& opts, const brokkr::odin::Cfg& cfg);
+
+// Opens and claims one Odin-mode USB device with the pre-flash timeout applied.
+brokkr::core::Result<std::unique_ptr<brokkr::odin::UsbTarget>> open_usb_target(
+    const brokkr::platform::UsbDeviceSysfsInfo& info, const brokkr::odin::Cfg& cfg);
+
+// Low: packet-sized stream windows, small hash buffers, at most two hash jobs and a small buffer pool,
+// for controllers with a few hundred MB of RAM. Also selected by BROKKR_LOW_MEMORY=1.
+enum class MemoryProfile { Default, Low };
+
+MemoryProfile memory_profile_from_env() noexcept;
+void init_memory_profile(MemoryProfile p) noexcept; // process-wide: buffer pool retention
+void apply_memory_profile(MemoryProfile p, brokkr::odin::Cfg& cfg) noexcept;
+HashLimits hash_limits(MemoryProfile p) noexcept;
+
+struct Package {
+  std::vector<brokkr::odin::ImageSpec> specs;
+  std::shared_ptr<const std::vector<std::byte>> pit;
+};
+
+bool is_pit_name(std::string_view base) noexcept;
+brokkr::core::Result<std::shared_ptr<const std::vector<std::byte>>> load_pit_file(const std::filesystem::path& p);
+
+// Identifies a package by the path, size and mtime of every input, so a cached prepare can be reused
+// until one of them changes on disk.
+brokkr::core::Result<std::string> package_key(const std::vector<std::filesystem::path>& inputs,
+                                              const std::optional<std::filesystem::path>& pit);
+
+// MD5/XXH3 verification, tar expansion and PIT extraction; the explicit PIT wins over an embedded one.
+brokkr::core::Result<Package> prepare_package(const std::vector<std::filesystem::path>& inputs,
+                                              std::shared_ptr<const std::vector<std::byte>> pit,
+                                              const brokkr::odin::Ui& ui, const HashLimits& limits = {});
+
+std::string user_facing_error(const std::string& err);
+
+} // namespace brokkr::app
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app/experiment.hpp"
+
+#include "core/json.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <system_error>
+
+#include <fmt/format.h>
+
+namespace brokkr::app {
+namespace {
+
+using brokkr::core::Json;
+
+constexpr std::size_t kKiB = 1024;
+constexpr std::size_t kMiB = 1024 * 1024;
+
+brokkr::core::Result<std::optional<std::size_t>> positive_field(const Json& v, std::string_view key,
+                                                                const std::string& variant) {
+  const Json* f = v.find(key);
+  if (!f || f->is_null()) return std::optional<std::size_t>{};
+  const double n = f->as_number(-1);
+  if (!f->is_number() || n < 1 || n != std::trunc(n) || n > 1e9) {
+    return brokkr::core::failf("Experiment variant '{}': {} must be a positive integer", variant, key);
+  }
+  return std::optional<std::size_t>{static_cast<std::size_t>(n)};
+}
+
+std::string file_safe(std::string_view name) {
+  std::string out;
+  for (const char c : name) {
+    const bool keep = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' ||
+                      c == '_' || c == '.';
+    out.push_back(keep ? c : '_');
+  }
+  return out;
+}
+
+void append_table(std::string& out, const std::vector<VariantStats>& rows) {
+  out += fmt::format("  {:<16} {:>6} {:>7} {:>16} {:>9} {:>20}  {}\n", "variant", "n", "fail", "fail 95% CI", "MB/s",
+                     "MB/s 95% CI", "vs control");
+  for (std::size_t i = 0; i < rows.size(); ++i) {
+    const auto& r = rows[i];
+    const double fail = r.sessions ? 100.0 * static_cast<double>(r.failures) / static_cast<double>(r.sessions) : 0;
+    out += fmt::format("  {:<16} {:>6} {:>6.1f}% [{:>5.1f}, {:>5.1f}]%", r.name, r.sessions, fail,
+                       100 * r.failure_ci.lo, 100 * r.failure_ci.hi);
+    if (r.mbps.n) {
+      out += fmt::format(" {:>9.2f} [{:>8.2f}, {:>8.2f}]", r.mbps.mean, r.mbps_ci.lo, r.mbps_ci.hi);
+    } else {
+      out += fmt::format(" {:>9} {:>20}", "-", "-");
+    }
+    if (!i) {
+      out += "  (control)";
+    } else if (r.vs_control) {
+      const bool sig = r.vs_control->lo > 0 || r.vs_control->hi < 0;
+      out += fmt::format("  {:+.2f} [{:+.2f}, {:+.2f}]{}", r.mbps.mean - rows[0].mbps.mean, r.vs_control->lo,
+                         r.vs_control->hi, sig ? " *" : "");
+    } else {
+      out += "  -";
+    }
+    out += '\n';
+  }
+}
+
+} // namespace
+
+brokkr::odin::Cfg ExperimentVariant::apply(brokkr::odin::Cfg base) const noexcept {
+  if (packet_bytes) base.pkt_all_v2plus = *packet_bytes;
+  if (window_bytes) {
+    base.buffer_bytes = *window_bytes;
+    base.window_packets = 0;
+  }
+  if (pipeline_depth) base.pipeline_depth = *pipeline_depth;
+  if (compressed_download) base.compressed_download = *compressed_download;
+  return base;
+}
+
+brokkr::core::Result<Experiment> parse_experiment(std::string_view json) noexcept {
+  BRK_TRYV(root, Json::parse(json));
+  if (!root.is_object()) return brokkr::core::fail("Experiment config must be a JSON object");
+
+  Experiment exp;
+  if (const Json* n = root.find("name")) exp.name = n->as_string();
+  if (exp.name.empty()) return brokkr::core::fail("Experiment config needs a \"name\"");
+
+  const Json* vs = root.find("variants");
+  if (!vs || !vs->is_array() || vs->array().empty()) {
+    return brokkr::core::fail("Experiment config needs a non-empty \"variants\" array");
+  }
+
+  for (const auto& v : vs->array()) {
+    if (!v.is_object()) return brokkr::core::fail("Experiment variants must be JSON objects");
+
+    ExperimentVariant var;
+    if (const Json* n = v.find("name")) var.name = n->as_string();
+    if (var.name.empty()) return brokkr::core::fail("Every experiment variant needs a \"name\"");
+    const bool dup = std::ranges::any_of(exp.variants, [&](const ExperimentVariant& o) { return o.name == var.name; });
+    if (dup) return brokkr::core::failf("Duplicate experiment variant '{}'", var.name);
+
+    if (const Json* w = v.find("weight")) {
+      var.weight = w->as_number(-1);
+      if (!(var.weight > 0)) return brokkr::core::failf("Experiment variant '{}': weight must be > 0", var.name);
+    }
+
+    BRK_TRYV(pkt, positive_field(v, "packet_kib", var.name));
+    BRK_TRYV(win, positive_field(v, "window_mib", var.name));
+    BRK_TRYV(depth, positive_field(v, "pipeline_depth", var.name));
+    if (pkt) var.packet_bytes = *pkt * kKiB;
+    if (win) var.window_bytes = *win * kMiB;
+    var.pipeline_depth = depth;
+
+    if (const Json* c = v.find("compression"); c && !c->is_null()) {
+      if (!c->is_bool()) return brokkr::core::failf("Experiment variant '{}': compression must be a bool", var.name);
+      var.compressed_download = c->as_bool();
+    }
+
+    exp.variants.push_back(std::move(var));
+  }
+  return exp;
+}
+
+brokkr::core::Result<Experiment> load_experiment(const std::filesystem::path& path) noexcept {
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open()) return brokkr::core::failf("Cannot open experiment config {}", path.string());
+  std::ostringstream ss;
+  ss << in.rdbuf();
+
+  auto exp = parse_experiment(ss.str());
+  if (!exp) return brokkr::core::failf("{}: {}", path.string(), exp.error());
+  return exp;
+}
+
+VariantPicker::VariantPicker(const Experiment& exp, std::uint64_t seed) : rng_(seed) {
+  std::vector<double> w;
+  w.reserve(exp.variants.size());
+  for (const auto& v : exp.variants) w.push_back(v.weight);
+  dist_ = std::discrete_distribution<std::size_t>(w.begin(), w.end());
+}
+
+std::size_t VariantPicker::pick() { return dist_(rng_); }
+
+std::filesystem::path experiment_results_file(const std::filesystem::path& app_cache_dir, std::string_view name) {
+  return app_cache_dir / "experiments" / (file_safe(name) + ".jsonl");
+}
+
+brokkr::core::Status append_experiment_trial(const std::filesystem::path& file, const ExperimentTrial& t) noexcept {
+  std::error_code ec;
+  const auto parent = file.parent_path();
+  if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+  if (ec) return brokkr::core::failf("Cannot create {}: {}", parent.string(), ec.message());
+
+  Json j(Json::Object{});
+  j["t"] = Json(t.time);
+  j["variant"] = Json(t.variant);
+  j["cpu_bl_id"] = Json(t.cpu_bl_id);
+  j["ok"] = Json(t.ok);
+  j["bytes"] = Json(t.bytes);
+  j["seconds"] = Json(t.seconds);
+  j["batch"] = Json(static_cast<std::uint64_t>(t.batch_devices));
+
+  // One write per line, so concurrent stations sharing the file do not interleave records.
+  const std::string line = j.dump() + '\n';
+  std::ofstream out(file, std::ios::binary | std::ios::app);
+  if (!out.is_open()) return brokkr::core::failf("Cannot open {}", file.string());
+  out.write(line.data(), static_cast<std::streamsize>(line.size()));
+  out.flush();
+  if (!out.good()) return brokkr::core::failf("Cannot write {}", file.string());
+  return {};
+}
+
+brokkr::core::Result<std::vector<ExperimentTrial>> load_experiment_trials(const std::filesystem::path& file) noexcept {
+  std::vector<ExperimentTrial> out;
+  std::error_code ec;
+  if (!std::filesystem::exists(file, ec)) return out;
+
+  std::ifstream in(file, std::ios::binary);
+  if (!in.is_open()) return brokkr::core::failf("Cannot open {}", file.string());
+
+  std::string line;
+  while (std::getline(in, line)) {
+    auto j = Json::parse(line);
+    if (!j || !j->is_object()) continue; // torn tail after a crash
+
+    ExperimentTrial t;
+    auto str = [&](std::string_view k) { return j->find(k) ? j->find(k)->as_string() : std::string{}; };
+    auto num = [&](std::string_view k) { return j->find(k) ? j->find(k)->as_number() : 0.0; };
+    t.time = static_cast<std::int64_t>(num("t"));
+    t.variant = str("variant");
+    t.cpu_bl_id = str("cpu_bl_id");
+    t.ok = j->find("ok") && j->find("ok")->as_bool();
+    t.bytes = static_cast<std::uint64_t>(num("bytes"));
+    t.seconds = num("seconds");
+    t.batch_devices = static_cast<std::size_t>(num("batch"));
+    if (!t.variant.empty()) out.push_back(std::move(t));
+  }
+  return out;
+}
+
+std::vector<VariantStats> summarize_experiment(const Experiment& exp, std::span<const ExperimentTrial> trials,
+                                               std::optional<std::string_view> cpu_bl_id) {
+  std::vector<VariantStats> rows(exp.variants.size());
+  for (std::size_t i = 0; i < rows.size(); ++i) rows[i].name = exp.variants[i].name;
+
+  for (const auto& t : trials) {
+    if (cpu_bl_id && t.cpu_bl_id != *cpu_bl_id) continue;
+    const auto it = std::ranges::find(rows, t.variant, &VariantStats::name);
+    if (it == rows.end()) continue;
+
+    ++it->sessions;
+    if (!t.ok) {
+      ++it->failures;
+      continue;
+    }
+    if (t.bytes && t.seconds > 0) it->mbps.add(static_cast<double>(t.bytes) / t.seconds / 1e6);
+  }
+
+  for (auto& r : rows) {
+    r.failure_ci = brokkr::core::wilson95(r.failures, r.sessions);
+    r.mbps_ci = brokkr::core::mean_ci95(r.mbps);
+  }
+  for (std::size_t i = 1; i < rows.size(); ++i) {
+    brokkr::core::Interval d;
+    if (brokkr::core::welch_ci95(rows[i].mbps, rows[0].mbps, d)) rows[i].vs_control = d;
+  }
+  return rows;
+}
+
+std::string format_experiment_report(const Experiment& exp, std::span<const ExperimentTrial> trials) {
+  const auto all = summarize_experiment(exp, trials);
+  std::size_t sessions = 0;
+  for (const auto& r : all) sessions += r.sessions;
+
+  std::string out = fmt::format("Experiment '{}': {} session(s), 95% confidence intervals\n", exp.name, sessions);
+  append_table(out, all);
+
+  std::set<std::string> bl_ids;
+  for (const auto& t : trials)
+    if (std::ranges::any_of(exp.variants, [&](const ExperimentVariant& v) { return v.name == t.variant; }))
+      bl_ids.insert(t.cpu_bl_id);
+
+  if (bl_ids.size() > 1) {
+    for (const auto& id : bl_ids) {
+      out += fmt::format("\ncpu_bl_id {}:\n", id.empty() ? "(unknown)" : id);
+      append_table(out, summarize_experiment(exp, trials, id));
+    }
+  }
+  out += "\n* the MB/s difference to the control is significant at the 95% level\n";
+  return out;
+}
+
+} // namespace brokkr::app
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "core/stats.hpp"
+#include "core/status.hpp"
+#include "protocol/odin/group_flasher.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace brokkr::app {
+
+// Station experiments: a JSON config lists Cfg variants, every device that attaches is assigned one at
+// random, and each session's outcome is appended to a results file so the variants can be compared
+// across a whole fleet rather than one bench device.
+//
+//   {"name": "pkt-2026q4",
+//    "variants": [{"name": "control"},
+//                 {"name": "pkt512k", "packet_kib": 512},
+//                 {"name": "deep", "pipeline_depth": 4, "window_mib": 8, "weight": 0.5},
+//                 {"name": "host-lz4", "compression": false}]}
+//
+// Unset fields keep the station's Cfg. The first variant is the control the others are measured against.
+struct ExperimentVariant {
+  std::string name;
+  double weight = 1.0;
+  std::optional<std::size_t> packet_bytes; // Cfg::pkt_all_v2plus
+  std::optional<std::size_t> window_bytes; // Cfg::buffer_bytes
+  std::optional<std::size_t> pipeline_depth;
+  std::optional<bool> compressed_download;
+
+  brokkr::odin::Cfg apply(brokkr::odin::Cfg base) const noexcept;
+};
+
+struct Experiment {
+  std::string name;
+  std::vector<ExperimentVariant> variants;
+};
+
+brokkr::core::Result<Experiment> parse_experiment(std::string_view json) noexcept;
+brokkr::core::Result<Experiment> load_experiment(const std::filesystem::path& path) noexcept;
+
+// Weighted assignment, one draw per device session.
+class VariantPicker {
+ public:
+  VariantPicker(const Experiment& exp, std::uint64_t seed);
+  std::size_t pick();
+
+ private:
+  std::mt19937_64 rng_;
+  std::discrete_distribution<std::size_t> dist_;
+};
+
+struct ExperimentTrial {
+  std::int64_t time = 0; // unix seconds
+  std::string variant;
+  std::string cpu_bl_id;
+  bool ok = false;
+  std::uint64_t bytes = 0;
+  double seconds = 0; // data phase
+  std::size_t batch_devices = 0;
+};
+
+// One JSON object per line, appended as sessions end.
+std::filesystem::path experiment_results_file(const std::filesystem::path& app_cache_dir, std::string_view name);
+brokkr::core::Status append_experiment_trial(const std::filesystem::path& file, const ExperimentTrial& t) noexcept;
+brokkr::core::Result<std::vector<ExperimentTrial>> load_experiment_trials(const std::filesystem::path& file) noexcept;
+
+struct VariantStats {
+  std::string name;
+  std::size_t sessions = 0;
+  std::size_t failures = 0;
+  brokkr::core::Interval failure_ci; // Wilson 95%
+  brokkr::core::RunningStats mbps;   // successful sessions that reached the data phase
+  brokkr::core::Interval mbps_ci;    // t 95%
+  // Welch 95% interval of mean MB/s minus the control's.
+  std::optional<brokkr::core::Interval> vs_control;
+};
+
+// Trials of variants no longer in the config are ignored; without cpu_bl_id every device counts.
+std::vector<VariantStats> summarize_experiment(const Experiment& exp, std::span<const ExperimentTrial> trials,
+                                               std::optional<std::string_view> cpu_bl_id = std::nullopt);
+// Per-variant table for the whole fleet, then one per bootloader when the trials saw more than one.
+std::string format_experiment_report(const Experiment& exp, std::span<const ExperimentTrial> trials);
+
+} // namespace brokkr::app
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app/flush_fingerprint.hpp"
+
+#include "core/json.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+#include <fmt/format.h>
+
+namespace brokkr::app {
+namespace {
+
+using brokkr::core::Json;
+
+// In ln units (~5%): keeps a very uniform fleet from flagging ordinary jitter.
+constexpr double kMinStddev = 0.05;
+
+} // namespace
+
+std::filesystem::path flush_baseline_file(const std::filesystem::path& app_cache_dir) {
+  return app_cache_dir / "flush_baseline.json";
+}
+
+brokkr::core::Result<FlushBaseline> load_flush_baseline(const std::filesystem::path& file) noexcept {
+  FlushBaseline out;
+  std::error_code ec;
+  if (!std::filesystem::exists(file, ec)) return out;
+
+  std::ifstream in(file, std::ios::binary);
+  if (!in.is_open()) return brokkr::core::failf("Cannot open {}", file.string());
+  std::ostringstream ss;
+  ss << in.rdbuf();
+
+  auto j = Json::parse(ss.str());
+  if (!j || !j->is_object()) return brokkr::core::failf("{} is corrupt", file.string());
+  const Json* ids = j->find("cpu_bl_id");
+  if (!ids || !ids->is_object()) return out;
+
+  for (const auto& [id, v] : ids->object()) {
+    brokkr::core::RunningStats s;
+    if (const Json* n = v.find("n")) s.n = static_cast<std::size_t>(n->as_int());
+    if (const Json* m = v.find("mean")) s.mean = m->as_number();
+    if (const Json* m2 = v.find("m2")) s.m2 = m2->as_number();
+    if (s.n && std::isfinite(s.mean) && s.m2 >= 0) out.by_cpu_bl_id.emplace(id, s);
+  }
+  return out;
+}
+
+brokkr::core::Status save_flush_baseline(const std::filesystem::path& file, const FlushBaseline& b) noexcept {
+  std::error_code ec;
+  const auto parent = file.parent_path();
+  if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+  if (ec) return brokkr::core::failf("Cannot create {}: {}", parent.string(), ec.message());
+
+  Json ids(Json::Object{});
+  for (const auto& [id, s] : b.by_cpu_bl_id) {
+    Json v(Json::Object{});
+    v["n"] = Json(static_cast<std::uint64_t>(s.n));
+    v["mean"] = Json(s.mean);
+    v["m2"] = Json(s.m2);
+    ids[id] = std::move(v);
+  }
+  Json root(Json::Object{});
+  root["version"] = Json(1);
+  root["cpu_bl_id"] = std::move(ids);
+
+  auto tmp = file;
+  tmp += ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return brokkr::core::failf("Cannot open {}", tmp.string());
+    out << root.dump() << '\n';
+    if (!out.good()) return brokkr::core::failf("Cannot write {}", tmp.string());
+  }
+  std::filesystem::rename(tmp, file, ec);
+  if (ec) return brokkr::core::failf("Cannot replace {}: {}", file.string(), ec.message());
+  return {};
+}
+
+FlushVerdict score_flush(FlushBaseline& b, std::string_view cpu_bl_id, std::span<const brokkr::odin::PartFlush> parts,
+                         const FlushPolicy& policy) {
+  FlushVerdict v;
+  for (const auto& p : parts) {
+    if (p.bytes < policy.min_part_bytes || p.flush.count() <= 0) continue;
+    v.bytes += p.bytes;
+    v.flush += p.flush;
+  }
+  const double secs = std::chrono::duration<double>(v.flush).count();
+  v.measured = v.bytes && secs > 0;
+  if (!v.measured) return v;
+  v.mbps = static_cast<double>(v.bytes) / secs / 1e6;
+
+  if (cpu_bl_id.empty()) return v;
+  auto it = b.by_cpu_bl_id.find(cpu_bl_id);
+  if (it == b.by_cpu_bl_id.end()) it = b.by_cpu_bl_id.try_emplace(std::string(cpu_bl_id)).first;
+  auto& st = it->second;
+
+  const double x = std::log(v.mbps);
+  v.baseline_n = st.n;
+  if (st.n) {
+    v.baseline_mbps = std::exp(st.mean);
+    v.z = (x - st.mean) / std::max(st.stddev(), kMinStddev);
+    v.outlier = st.n >= policy.min_baseline && v.z < -policy.z_limit;
+  }
+  if (!v.outlier) st.add(x);
+  return v;
+}
+
+std::string describe_flush(const FlushVerdict& v, std::string_view cpu_bl_id) {
+  if (!v.measured) return "storage: too little data written to measure";
+
+  std::string out = fmt::format("storage writes {:.1f} MB/s ({:.1f} MiB flushed in {:.2f} s)", v.mbps,
+                                static_cast<double>(v.bytes) / (1024.0 * 1024.0),
+                                std::chrono::duration<double>(v.flush).count());
+  if (v.baseline_n) {
+    out += fmt::format(", {} typical {:.1f} MB/s over {} device(s), z {:+.1f}", cpu_bl_id, v.baseline_mbps,
+                       v.baseline_n, v.z);
+  }
+  if (v.outlier) out += " - SLOW STORAGE OUTLIER";
+  return out;
+}
+
+std::string describe_part_flush(const brokkr::odin::PartFlush& p) {
+  const double ratio = p.wire_bytes ? static_cast<double>(p.bytes) / static_cast<double>(p.wire_bytes) : 1.0;
+  return fmt::format("{:<16} {:>9.1f} MiB  {:>4.1f}x  {:>4} window(s)  flush {:>8.3f} s  {:>8.1f} MB/s",
+                     p.part_name.empty() ? fmt::format("#{}", p.part_id) : p.part_name,
+                     static_cast<double>(p.bytes) / (1024.0 * 1024.0), ratio, p.windows,
+                     std::chrono::duration<double>(p.flush).count(), p.write_mbps());
+}
+
+} // namespace brokkr::app
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "core/stats.hpp"
+#include "core/status.hpp"
+#include "protocol/odin/group_flasher.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace brokkr::app {
+
+// Storage write-speed fingerprint. The end_download round trip after a window's last packet is mostly the
+// phone committing that window to eMMC/UFS, so bytes written per second of flush is the effective write
+// speed of its storage. Devices are compared with earlier ones sharing their cpu_bl_id, whose stats are
+// kept (Welford, on ln MB/s) in the cache directory, and slow outliers are flagged for QA.
+struct FlushPolicy {
+  std::uint64_t min_part_bytes = 8ull << 20; // smaller partitions measure the ACK round trip, not the storage
+  std::size_t min_baseline = 10;             // devices per cpu_bl_id before anything is flagged
+  double z_limit = 3.0;
+};
+
+struct FlushVerdict {
+  bool measured = false; // at least one partition was large enough
+  double mbps = 0;       // decompressed bytes over flush time, across those partitions
+  std::uint64_t bytes = 0;
+  std::chrono::nanoseconds flush{0};
+
+  std::size_t baseline_n = 0;
+  double baseline_mbps = 0; // geometric mean of the baseline
+  double z = 0;             // of ln MB/s against the baseline
+  bool outlier = false;     // slower than z_limit standard deviations
+};
+
+struct FlushBaseline {
+  std::map<std::string, brokkr::core::RunningStats, std::less<>> by_cpu_bl_id;
+};
+
+std::filesystem::path flush_baseline_file(const std::filesystem::path& app_cache_dir);
+brokkr::core::Result<FlushBaseline> load_flush_baseline(const std::filesystem::path& file) noexcept;
+brokkr::core::Status save_flush_baseline(const std::filesystem::path& file, const FlushBaseline& b) noexcept;
+
+// Scores one device against its cpu_bl_id and then adds it to the baseline, unless it was flagged: a run of
+// bad units must not drag the reference down. Devices without a cpu_bl_id are measured but not compared.
+FlushVerdict score_flush(FlushBaseline& b, std::string_view cpu_bl_id, std::span<const brokkr::odin::PartFlush> parts,
+                         const FlushPolicy& policy = {});
+
+std::string describe_flush(const FlushVerdict& v, std::string_view cpu_bl_id);
+std::string describe_part_flush(const brokkr::odin::PartFlush& p);
+
+} // namespace brokkr::app
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "app/cli_mode.hpp"
+
+int main(int argc, char* argv[]) {
+  // Nothing to fall back to without the GUI: show the usage instead.
+  if (!brokkr::app::should_run_cli(argc, argv)) {
+    brokkr::app::print_cli_usage();
+    return argc > 1 ? 2 : 0;
+  }
+
+  return brokkr::app::run_cli(argc, argv);
+}
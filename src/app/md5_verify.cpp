@@ -19,23 +19,30 @@
 
 #include "app/md5_xxh3_cache.hpp"
 
+#include "core/buffer_pool.hpp"
 #include "core/prefetcher.hpp"
 #include "core/str.hpp"
 #include "core/thread_pool.hpp"
+#include "core/trace.hpp"
 
 #include "io/tar.hpp"
 #include "platform/platform_all.hpp"
+#include "protocol/odin/flash.hpp"
 #include "third_party/md5/md5.h"
 #include "third_party/xxhash/xxhash_vendor.h"
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <fstream>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <thread>
@@ -63,7 +70,9 @@ namespace {
 constexpr std::size_t kTrailerMaxBytes = 16 * 1024;
 constexpr std::size_t kMd5HexChars = 32;
 constexpr std::size_t kMd5Xxh3CacheMaxEntries = 100;
-constexpr std::size_t kHashBufBytes = 32 * 1024 * 1024;
+constexpr std::size_t kMinHashBufBytes = 64 * 1024;
+constexpr std::size_t kSolidHashBufBytes = 8ull * 1024 * 1024;
+constexpr std::size_t kSolidMaxStreams = 8;
 
 struct CombinedDigest {
   std::array<unsigned char, 16> md5{};
@@ -246,6 +255,11 @@ static void remember_session_verify_cache(const Md5Job& job) {
   session_verify_cache().insert(make_session_verify_key(job));
 }
 
+// Only called once the bytes behind `index` have been verified.
+static void remember_tar_index(const Md5Job& job, const std::optional<brokkr::io::TarArchive>& index) noexcept {
+  if (index) brokkr::io::TarArchive::remember(*index, job.identity_size, job.identity_write_time);
+}
+
 struct Xxh3Consumer {
   using Digest = std::uint64_t;
   static constexpr bool kUsesMd5 = false;
@@ -306,15 +320,98 @@ struct Md5Xxh3Consumer {
   XXH3_state_t* state_ = nullptr;
 };
 
+// Serves TarArchive::scan() from the blocks being hashed, so the index and the member heads the
+// expansion needs come out of the same read as the digest.
+class IngestTarStream final : public brokkr::io::TarStream {
+ public:
+  using NextFn = std::function<brokkr::core::Result<std::span<const std::byte>>()>; // empty at the end
+
+  explicit IngestTarStream(NextFn next) : next_(std::move(next)) {}
+
+  brokkr::core::Result<std::size_t> read(std::span<std::byte> dst) noexcept override {
+    std::size_t got = 0;
+    while (got < dst.size()) {
+      BRK_TRYV(n, take_(dst.size() - got));
+      if (!n) break;
+      std::copy_n(cur_.begin(), n, dst.begin() + static_cast<std::ptrdiff_t>(got));
+      consume_(n);
+      got += n;
+    }
+    return got;
+  }
+
+  brokkr::core::Status skip(std::uint64_t n) noexcept override {
+    while (n) {
+      BRK_TRYV(k, take_(static_cast<std::size_t>(std::min<std::uint64_t>(n, SIZE_MAX))));
+      if (!k) return brokkr::core::fail("TarArchive: short read while skipping");
+      consume_(k);
+      n -= k;
+    }
+    return {};
+  }
+
+  void on_member(const brokkr::io::TarEntry& e) noexcept override {
+    head_.clear();
+    head_want_ = brokkr::odin::spec_head_bytes(e);
+    head_off_ = e.data_offset;
+  }
+
+  // A read error is the hash's failure, not a broken archive.
+  const brokkr::core::Status& feed_status() const noexcept { return feed_st_; }
+  std::vector<std::pair<std::uint64_t, std::vector<std::byte>>>& heads() noexcept { return heads_; }
+
+ private:
+  brokkr::core::Result<std::size_t> take_(std::size_t want) noexcept {
+    if (cur_.empty()) {
+      auto b = next_();
+      if (!b) {
+        feed_st_ = brokkr::core::fail(b.error());
+        return brokkr::core::fail(std::move(b.error()));
+      }
+      cur_ = *b;
+    }
+    return std::min(want, cur_.size());
+  }
+
+  void consume_(std::size_t n) {
+    if (head_.size() < head_want_) {
+      const std::size_t k = std::min(n, head_want_ - head_.size());
+      head_.insert(head_.end(), cur_.begin(), cur_.begin() + static_cast<std::ptrdiff_t>(k));
+      if (head_.size() == head_want_) {
+        heads_.emplace_back(head_off_, std::move(head_));
+        head_.clear();
+        head_want_ = 0;
+      }
+    }
+    cur_ = cur_.subspan(n);
+  }
+
+  NextFn next_;
+  std::span<const std::byte> cur_;
+  brokkr::core::Status feed_st_{};
+
+  std::vector<std::byte> head_;
+  std::size_t head_want_ = 0;
+  std::uint64_t head_off_ = 0;
+  std::vector<std::pair<std::uint64_t, std::vector<std::byte>>> heads_;
+};
+
+// With `index`, the tar inside the hashed range is scanned on the way; it stays empty if the bytes do
+// not parse as a tar.
 template <class Consumer>
 static brokkr::core::Result<typename Consumer::Digest> hash_prefetch(const std::filesystem::path& path,
                                                                      std::uint64_t bytes_to_hash,
                                                                      std::atomic_uint64_t& done,
                                                                      std::uint64_t total,
-                                                                     const brokkr::odin::Ui& ui) noexcept {
+                                                                     const brokkr::odin::Ui& ui,
+                                                                     std::size_t buf_bytes,
+                                                                     std::optional<brokkr::io::TarArchive>* index =
+                                                                         nullptr) noexcept {
   struct Slot {
-    std::vector<unsigned char> buf;
+    brokkr::core::PooledBytes buf;
     std::size_t n = 0;
+
+    unsigned char* data() noexcept { return reinterpret_cast<unsigned char*>(buf->data()); }
   };
 
   HashFileReader reader(path);
@@ -326,15 +423,18 @@ static brokkr::core::Result<typename Consumer::Digest> hash_prefetch(const std::
       [&](Slot& s, std::stop_token st) -> brokkr::core::Result<bool> {
         if (st.stop_requested() || !remaining) return false;
 
-        const std::size_t want = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, kHashBufBytes));
-        BRK_TRYV(got, reader.read_some(s.buf.data(), want));
+        const std::size_t want = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, buf_bytes));
+        BRK_TRYV(got, reader.read_some(s.data(), want));
         if (got != want) return brokkr::core::failf("Short read while hashing: {}", path.string());
 
         s.n = got;
         remaining -= static_cast<std::uint64_t>(got);
         return true;
       },
-      [&](Slot& s) { s.buf.resize(kHashBufBytes); });
+      [&](Slot& s) {
+        s.buf = brokkr::core::PooledBytes(buf_bytes);
+        s.buf->resize(buf_bytes);
+      });
 
   Consumer consumer;
   if constexpr (Consumer::kUsesMd5) {
@@ -346,20 +446,43 @@ static brokkr::core::Result<typename Consumer::Digest> hash_prefetch(const std::
   BRK_TRY(consumer.init());
 
   std::uint64_t processed = 0;
-  while (processed < bytes_to_hash) {
-    auto lease = pf.next();
-    if (!lease) break;
+  std::optional<typename brokkr::core::TwoSlotPrefetcher<Slot>::Lease> lease;
+  auto next_block = [&]() -> brokkr::core::Result<std::span<const std::byte>> {
+    lease.reset();
+    if (processed >= bytes_to_hash) return std::span<const std::byte>{};
+    lease = pf.next();
+    if (!lease) return std::span<const std::byte>{};
 
     auto& s = lease->get();
-    if (!s.n) break;
+    if (!s.n) return std::span<const std::byte>{};
 
-    BRK_TRY(consumer.update(s.buf.data(), s.n));
+    BRK_TRY(consumer.update(s.data(), s.n));
     processed += static_cast<std::uint64_t>(s.n);
+    BRK_TRACE(hash_chunk, s.n, processed, bytes_to_hash);
 
     const auto new_done = done.fetch_add(static_cast<std::uint64_t>(s.n), std::memory_order_relaxed) +
                           static_cast<std::uint64_t>(s.n);
     if (ui.on_progress) ui.on_progress(new_done, total, new_done, total);
+    return std::span<const std::byte>(reinterpret_cast<const std::byte*>(s.data()), s.n);
+  };
+
+  if (index) {
+    IngestTarStream in(next_block);
+    auto tar = brokkr::io::TarArchive::scan(path.string(), in);
+    if (!in.feed_status()) return brokkr::core::fail(in.feed_status().error());
+    if (tar) {
+      for (auto& [off, bytes] : in.heads()) tar->set_head(off, std::move(bytes));
+      index->emplace(std::move(*tar));
+    } else {
+      spdlog::debug("Ingest: no tar index for {}: {}", path.string(), tar.error());
+    }
+  }
+
+  for (;;) {
+    BRK_TRYV(block, next_block());
+    if (block.empty()) break;
   }
+  lease.reset();
 
   auto pst = pf.status();
   if (!pst) return brokkr::core::fail(std::move(pst.error()));
@@ -379,6 +502,63 @@ static brokkr::core::Result<typename Consumer::Digest> hash_prefetch(const std::
   return digest;
 }
 
+struct HashLane {
+  std::vector<const Md5Job*> jobs;
+  std::uint64_t bytes = 0;
+  std::size_t buf_bytes = 0;
+};
+
+static std::string_view storage_kind_name(const brokkr::platform::StorageInfo& s) noexcept {
+  switch (s.kind) {
+    case brokkr::platform::StorageKind::Rotational:
+      return s.usb ? "rotational, USB" : "rotational";
+    case brokkr::platform::StorageKind::Solid:
+      return s.usb ? "solid-state, USB" : "solid-state";
+    case brokkr::platform::StorageKind::Unknown:
+      break;
+  }
+  return "unknown";
+}
+
+// Groups the jobs by disk and spreads each disk's files over its lanes, largest first onto the
+// least-loaded lane, so a big AP does not end up queued behind the small archives.
+static std::vector<HashLane> plan_hash_lanes(const std::vector<Md5Job>& jobs, const HashLimits& limits) {
+  struct Disk {
+    brokkr::platform::StorageInfo info;
+    std::vector<const Md5Job*> jobs;
+  };
+
+  std::vector<Disk> disks;
+  for (const auto& j : jobs) {
+    auto info = brokkr::platform::storage_info(j.path);
+    auto it = std::find_if(disks.begin(), disks.end(),
+                           [&](const Disk& d) { return info.device && d.info.device == info.device; });
+    if (it == disks.end()) it = disks.insert(disks.end(), Disk{.info = std::move(info), .jobs = {}});
+    it->jobs.push_back(&j);
+  }
+
+  std::vector<HashLane> lanes;
+  for (auto& d : disks) {
+    const auto policy = storage_hash_policy(d.info, limits);
+    const std::size_t n = policy.streams ? std::min(policy.streams, d.jobs.size()) : d.jobs.size();
+    spdlog::debug("Hashing {} file(s) on {} ({}): {} stream(s), {} KiB reads", d.jobs.size(),
+                  d.info.name.empty() ? "?" : d.info.name, storage_kind_name(d.info), n, policy.buf_bytes / 1024);
+
+    std::sort(d.jobs.begin(), d.jobs.end(),
+              [](const Md5Job* a, const Md5Job* b) { return a->bytes_to_hash > b->bytes_to_hash; });
+
+    const std::size_t first = lanes.size();
+    lanes.resize(first + n, HashLane{.jobs = {}, .bytes = 0, .buf_bytes = policy.buf_bytes});
+    for (const auto* j : d.jobs) {
+      auto lane = std::min_element(lanes.begin() + static_cast<std::ptrdiff_t>(first), lanes.end(),
+                                   [](const HashLane& a, const HashLane& b) { return a.bytes < b.bytes; });
+      lane->jobs.push_back(j);
+      lane->bytes += j->bytes_to_hash;
+    }
+  }
+  return lanes;
+}
+
 static brokkr::core::Result<std::optional<Md5Job>> detect_md5_job(const std::filesystem::path& p) noexcept {
   std::error_code ec;
   const std::uint64_t file_size = std::filesystem::file_size(p, ec);
@@ -443,6 +623,22 @@ static brokkr::core::Result<std::optional<Md5Job>> detect_md5_job(const std::fil
 
 } // namespace
 
+StorageHashPolicy storage_hash_policy(const brokkr::platform::StorageInfo& s, const HashLimits& limits) noexcept {
+  const std::size_t buf_bytes = std::max(limits.buf_bytes, kMinHashBufBytes);
+  switch (s.kind) {
+    case brokkr::platform::StorageKind::Rotational:
+      return {.streams = 1, .buf_bytes = buf_bytes};
+    case brokkr::platform::StorageKind::Solid:
+      // USB bridges serialize anyway; NVMe (queue depth ~1000) takes the most streams, SATA (~64) two.
+      if (s.usb) return {.streams = 1, .buf_bytes = buf_bytes};
+      return {.streams = std::clamp<std::size_t>(s.queue_depth / 32, 2, kSolidMaxStreams),
+              .buf_bytes = std::min(buf_bytes, kSolidHashBufBytes)};
+    case brokkr::platform::StorageKind::Unknown:
+      break;
+  }
+  return {.streams = 0, .buf_bytes = buf_bytes};
+}
+
 brokkr::core::Result<std::vector<Md5Job>> md5_jobs(const std::vector<std::filesystem::path>& inputs) noexcept {
   std::vector<Md5Job> jobs;
 
@@ -476,7 +672,8 @@ std::string_view md5_verify_name(const std::vector<Md5Job>& jobs) noexcept {
   return all_jobs_cached ? "XXH3" : "MD5";
 }
 
-brokkr::core::Status md5_verify(const std::vector<Md5Job>& jobs, const brokkr::odin::Ui& ui) noexcept {
+brokkr::core::Status md5_verify(const std::vector<Md5Job>& jobs, const brokkr::odin::Ui& ui,
+                                const HashLimits& limits) noexcept {
   if (jobs.empty()) return {};
 
   std::uint64_t total = 0;
@@ -539,8 +736,10 @@ brokkr::core::Status md5_verify(const std::vector<Md5Job>& jobs, const brokkr::o
     return {};
   }
 
-  const std::size_t threads = std::min<std::size_t>(pending_jobs.size(),
-                                                    std::max<std::size_t>(1, std::thread::hardware_concurrency()));
+  const auto lanes = plan_hash_lanes(pending_jobs, limits);
+  const std::size_t max_jobs =
+      limits.max_jobs ? limits.max_jobs : std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  const std::size_t threads = std::min<std::size_t>(lanes.size(), max_jobs);
 
   brokkr::core::ThreadPool pool(threads);
 
@@ -559,81 +758,100 @@ brokkr::core::Status md5_verify(const std::vector<Md5Job>& jobs, const brokkr::o
     }
   };
 
-  for (const auto& j : pending_jobs) {
-    auto st = pool.submit([&, j]() -> brokkr::core::Status {
-      if (pool.cancelled()) return {};
-
-      std::optional<std::uint64_t> cached_xxh3;
-      if (cache_enabled) {
-        std::lock_guard lk(cache_mtx);
-        cached_xxh3 = lookup_md5_xxh3_cache(cache_entries, j.expected, j.bytes_to_hash);
-        if (cached_xxh3) cache_dirty = true;
-      }
-
-      if (cached_xxh3) {
-        auto xxh3 = hash_prefetch<Xxh3Consumer>(j.path, j.bytes_to_hash, done, total, ui);
-        if (!xxh3) {
-          if (cache_enabled) {
-            std::lock_guard lk(cache_mtx);
-            if (forget_md5_xxh3_cache(cache_entries, j.expected, j.bytes_to_hash)) {
-              cache_dirty = true;
-              spdlog::warn("Removed MD5/XXH3 cache entry after XXH3 failure: {}", j.path.string());
-            }
-          }
-          return brokkr::core::fail(std::move(xxh3.error()));
-        }
-
-        if (*xxh3 == *cached_xxh3) {
-          spdlog::debug("MD5/XXH3 cache hit: {}", j.path.string());
-          remember_session_verify_cache(j);
-          return {};
-        }
-
-        spdlog::warn("MD5/XXH3 cache mismatch, falling back to full MD5");
-
-        if (ui.on_stage) ui.on_stage("Checking package MD5");
-        if (ui.on_progress) ui.on_progress(0, j.bytes_to_hash, 0, j.bytes_to_hash);
-
-        std::atomic_uint64_t retry_done{0};
-        auto retry_ui = ui;
-
-        auto retry = hash_prefetch<Md5Xxh3Consumer>(j.path, j.bytes_to_hash, retry_done, j.bytes_to_hash, retry_ui);
-        if (!retry) return brokkr::core::fail(std::move(retry.error()));
-
-        if (std::memcmp(retry->md5.data(), j.expected.data(), j.expected.size()) != 0) {
-          return brokkr::core::fail("MD5 mismatch: " + j.path.string() + "\n  expected:   " + md5_hex32(j.expected) +
-                                    "\n  calculated: " + md5_hex32(retry->md5) +
-                                    "\n  byte count: " + std::to_string(j.bytes_to_hash));
-        }
+  auto verify_job = [&](const Md5Job& j, std::size_t buf_bytes) -> brokkr::core::Status {
+    std::optional<std::uint64_t> cached_xxh3;
+    if (cache_enabled) {
+      std::lock_guard lk(cache_mtx);
+      cached_xxh3 = lookup_md5_xxh3_cache(cache_entries, j.expected, j.bytes_to_hash);
+      if (cached_xxh3) cache_dirty = true;
+    }
 
+    std::optional<brokkr::io::TarArchive> index;
+    if (cached_xxh3) {
+      auto xxh3 = hash_prefetch<Xxh3Consumer>(j.path, j.bytes_to_hash, done, total, ui, buf_bytes, &index);
+      if (!xxh3) {
         if (cache_enabled) {
           std::lock_guard lk(cache_mtx);
-          remember_md5_xxh3_cache(cache_entries, j.expected, j.bytes_to_hash, retry->xxh3_64,
-                                  kMd5Xxh3CacheMaxEntries);
-          cache_dirty = true;
+          if (forget_md5_xxh3_cache(cache_entries, j.expected, j.bytes_to_hash)) {
+            cache_dirty = true;
+            spdlog::warn("Removed MD5/XXH3 cache entry after XXH3 failure: {}", j.path.string());
+          }
         }
+        return brokkr::core::fail(std::move(xxh3.error()));
+      }
+
+      if (*xxh3 == *cached_xxh3) {
+        spdlog::debug("MD5/XXH3 cache hit: {}", j.path.string());
         remember_session_verify_cache(j);
+        remember_tar_index(j, index);
         return {};
       }
 
-      auto digest = hash_prefetch<Md5Xxh3Consumer>(j.path, j.bytes_to_hash, done, total, ui);
-      if (!digest) return brokkr::core::fail(std::move(digest.error()));
+      spdlog::warn("MD5/XXH3 cache mismatch, falling back to full MD5");
+
+      if (ui.on_stage) ui.on_stage("Checking package MD5");
+      if (ui.on_progress) ui.on_progress(0, j.bytes_to_hash, 0, j.bytes_to_hash);
+
+      std::atomic_uint64_t retry_done{0};
+      auto retry_ui = ui;
+
+      index.reset();
+      auto retry = hash_prefetch<Md5Xxh3Consumer>(j.path, j.bytes_to_hash, retry_done, j.bytes_to_hash, retry_ui,
+                                                  buf_bytes, &index);
+      if (!retry) return brokkr::core::fail(std::move(retry.error()));
 
-      if (std::memcmp(digest->md5.data(), j.expected.data(), j.expected.size()) != 0) {
+      if (std::memcmp(retry->md5.data(), j.expected.data(), j.expected.size()) != 0) {
         return brokkr::core::fail("MD5 mismatch: " + j.path.string() + "\n  expected:   " + md5_hex32(j.expected) +
-                                  "\n  calculated: " + md5_hex32(digest->md5) +
+                                  "\n  calculated: " + md5_hex32(retry->md5) +
                                   "\n  byte count: " + std::to_string(j.bytes_to_hash));
       }
 
       if (cache_enabled) {
         std::lock_guard lk(cache_mtx);
-        remember_md5_xxh3_cache(cache_entries, j.expected, j.bytes_to_hash, digest->xxh3_64,
+        remember_md5_xxh3_cache(cache_entries, j.expected, j.bytes_to_hash, retry->xxh3_64,
                                 kMd5Xxh3CacheMaxEntries);
         cache_dirty = true;
       }
-
       remember_session_verify_cache(j);
+      remember_tar_index(j, index);
+      return {};
+    }
+
+    auto digest = hash_prefetch<Md5Xxh3Consumer>(j.path, j.bytes_to_hash, done, total, ui, buf_bytes, &index);
+    if (!digest) return brokkr::core::fail(std::move(digest.error()));
+
+    if (std::memcmp(digest->md5.data(), j.expected.data(), j.expected.size()) != 0) {
+      return brokkr::core::fail("MD5 mismatch: " + j.path.string() + "\n  expected:   " + md5_hex32(j.expected) +
+                                "\n  calculated: " + md5_hex32(digest->md5) +
+                                "\n  byte count: " + std::to_string(j.bytes_to_hash));
+    }
 
+    if (cache_enabled) {
+      std::lock_guard lk(cache_mtx);
+      remember_md5_xxh3_cache(cache_entries, j.expected, j.bytes_to_hash, digest->xxh3_64,
+                              kMd5Xxh3CacheMaxEntries);
+      cache_dirty = true;
+    }
+
+    remember_session_verify_cache(j);
+    remember_tar_index(j, index);
+
+    return {};
+  };
+
+  for (const auto& lane : lanes) {
+    auto st = pool.submit([&, lane = &lane]() -> brokkr::core::Status {
+      const auto t0 = std::chrono::steady_clock::now();
+      for (const auto* j : lane->jobs) {
+        if (pool.cancelled()) return {};
+        BRK_TRY(verify_job(*j, lane->buf_bytes));
+      }
+
+      const std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+      if (dt.count() > 0) {
+        spdlog::debug("Hashed {} file(s), {} MiB at {:.0f} MiB/s", lane->jobs.size(), lane->bytes >> 20,
+                      static_cast<double>(lane->bytes) / (1024.0 * 1024.0) / dt.count());
+      }
       return {};
     });
 
@@ -18,9 +18,11 @@
 #pragma once
 
 #include "core/status.hpp"
+#include "platform/platform_all.hpp"
 #include "protocol/odin/group_flasher.hpp"
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <string_view>
@@ -37,8 +39,23 @@ struct Md5Job {
   std::array<unsigned char, 16> expected{};
 };
 
+struct HashLimits {
+  std::size_t buf_bytes = 32ull * 1024 * 1024; // per read slot; each job double-buffers
+  std::size_t max_jobs = 0;                    // 0: one per hardware thread
+};
+
+// How the files of one disk are hashed: `streams` lanes side by side, each reading `buf_bytes` at a time.
+// Spinning and USB-attached disks get one sequential stream, SSDs a few, unknown storage one per file.
+struct StorageHashPolicy {
+  std::size_t streams = 0; // 0: one per file
+  std::size_t buf_bytes = 0;
+};
+
+StorageHashPolicy storage_hash_policy(const brokkr::platform::StorageInfo& s, const HashLimits& limits) noexcept;
+
 brokkr::core::Result<std::vector<Md5Job>> md5_jobs(const std::vector<std::filesystem::path>& inputs) noexcept;
 std::string_view md5_verify_name(const std::vector<Md5Job>& jobs) noexcept;
-brokkr::core::Status md5_verify(const std::vector<Md5Job>& jobs, const brokkr::odin::Ui& ui) noexcept;
+brokkr::core::Status md5_verify(const std::vector<Md5Job>& jobs, const brokkr::odin::Ui& ui,
+                                const HashLimits& limits = {}) noexcept;
 
 } // namespace brokkr::app
@@ -0,0 +1,490 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "capi/brokkr.h"
+
+#include "app/engine.hpp"
+#include "core/json.hpp"
+#include "core/mpmc_ring.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+using brokkr::core::Json;
+
+constexpr std::size_t kDefaultEventCapacity = 1024;
+constexpr std::size_t kMaxCachedPackages = 8;
+constexpr std::size_t kMaxFinishedJobs = 256;
+constexpr auto kProgressInterval = std::chrono::milliseconds(100);
+
+thread_local std::string t_last_error;
+
+void init_once() {
+  static std::once_flag once;
+  std::call_once(once, [] {
+    spdlog::set_level(spdlog::level::warn);
+    brokkr::app::init_memory_profile(brokkr::app::memory_profile_from_env());
+  });
+}
+
+int fail(int code, std::string msg) {
+  t_last_error = std::move(msg);
+  return code;
+}
+
+// Nothing may unwind through the C boundary.
+template <class F>
+int guarded(F&& f) noexcept {
+  try {
+    return f();
+  } catch (const std::exception& e) {
+    return fail(BROKKR_ERR_FAILED, e.what());
+  } catch (...) {
+    return fail(BROKKR_ERR_FAILED, "unknown exception");
+  }
+}
+
+int copy_out(std::string_view s, char* buf, std::size_t cap, std::size_t* needed) {
+  if (needed) *needed = s.size() + 1;
+  if (!buf || cap < s.size() + 1) return fail(BROKKR_ERR_BUFFER, "buffer too small");
+  std::memcpy(buf, s.data(), s.size());
+  buf[s.size()] = '\0';
+  return BROKKR_OK;
+}
+
+void set_text(brokkr_event& ev, std::string_view s) {
+  const std::size_t n = std::min(s.size(), sizeof(ev.text) - 1);
+  std::memcpy(ev.text, s.data(), n);
+  ev.text[n] = '\0';
+}
+
+struct Job {
+  brokkr_handle id = 0;
+
+  std::mutex m;
+  std::condition_variable cv;
+  bool done = false;
+  int status = BROKKR_PENDING;
+  std::string error;
+  brokkr_handle package = 0;
+
+  std::jthread thread;
+};
+
+struct CachedPackage {
+  std::string key;
+  std::vector<std::filesystem::path> inputs;
+  std::optional<std::filesystem::path> pit;
+  std::shared_ptr<const brokkr::app::Package> pkg;
+};
+
+struct JobResult {
+  int status = BROKKR_OK;
+  std::string error;
+  brokkr_handle package = 0;
+};
+
+} // namespace
+
+struct brokkr_ctx {
+  explicit brokkr_ctx(std::size_t capacity) : events(capacity ? capacity : kDefaultEventCapacity) {}
+
+  brokkr::core::MpmcRing<brokkr_event> events;
+  std::atomic<std::uint64_t> dropped{0};
+  brokkr::app::MemoryProfile profile = brokkr::app::MemoryProfile::Default;
+
+  std::mutex flash_mtx; // flashes queue like daemon requests: they would fight over the same devices
+
+  std::mutex m;
+  brokkr_handle next_handle = 1;
+  std::map<brokkr_handle, std::shared_ptr<Job>> jobs;
+  std::vector<brokkr_handle> finished; // oldest first
+  std::map<brokkr_handle, CachedPackage> packages;
+  std::vector<brokkr_handle> package_order;
+
+  void emit(const brokkr_event& ev) noexcept {
+    if (!events.try_push(ev)) dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  brokkr::odin::Ui make_ui(brokkr_handle job, std::atomic_bool& devfail);
+
+  template <class F>
+  brokkr_handle start(F fn);
+
+  std::shared_ptr<Job> job(brokkr_handle id) {
+    std::lock_guard lk(m);
+    const auto it = jobs.find(id);
+    return it == jobs.end() ? nullptr : it->second;
+  }
+};
+
+brokkr::odin::Ui brokkr_ctx::make_ui(brokkr_handle job, std::atomic_bool& devfail) {
+  brokkr::odin::Ui ui;
+  auto last_progress = std::make_shared<std::chrono::steady_clock::time_point>();
+
+  auto event = [job](std::int32_t type) {
+    brokkr_event ev{};
+    ev.job = job;
+    ev.type = type;
+    return ev;
+  };
+
+  ui.on_devices = [this, event](std::size_t n, const std::vector<std::string>& ids) {
+    auto ev = event(BROKKR_EVENT_DEVICES);
+    ev.a = n;
+    std::string joined;
+    for (const auto& id : ids) joined += (joined.empty() ? "" : "\n") + id;
+    set_text(ev, joined);
+    emit(ev);
+  };
+  ui.on_model = [this, event](const std::string& s) {
+    auto ev = event(BROKKR_EVENT_MODEL);
+    set_text(ev, s);
+    emit(ev);
+  };
+  ui.on_stage = [this, event](const std::string& s) {
+    auto ev = event(BROKKR_EVENT_STAGE);
+    set_text(ev, s);
+    emit(ev);
+  };
+  ui.on_plan = [this, event](const std::vector<brokkr::odin::PlanItem>& plan, std::uint64_t total) {
+    auto ev = event(BROKKR_EVENT_PLAN);
+    ev.a = plan.size();
+    ev.b = total;
+    emit(ev);
+  };
+  ui.on_item_active = [this, event](std::size_t i) {
+    auto ev = event(BROKKR_EVENT_ITEM_ACTIVE);
+    ev.a = i;
+    emit(ev);
+  };
+  ui.on_item_done = [this, event](std::size_t i) {
+    auto ev = event(BROKKR_EVENT_ITEM_DONE);
+    ev.a = i;
+    emit(ev);
+  };
+  ui.on_progress = [this, event, last_progress](std::uint64_t done, std::uint64_t total, std::uint64_t item_done,
+                                                std::uint64_t item_total) {
+    const auto now = std::chrono::steady_clock::now();
+    if (done < total && now - *last_progress < kProgressInterval) return;
+    *last_progress = now;
+
+    auto ev = event(BROKKR_EVENT_PROGRESS);
+    ev.a = done;
+    ev.b = total;
+    ev.c = item_done;
+    ev.d = item_total;
+    emit(ev);
+  };
+  ui.on_error = [this, event, &devfail](const std::string& s) {
+    if (s.rfind("DEVFAIL idx=", 0) == 0) devfail.store(true, std::memory_order_relaxed);
+    auto ev = event(BROKKR_EVENT_ERROR);
+    set_text(ev, s);
+    emit(ev);
+  };
+  return ui;
+}
+
+// Runs fn (JobResult(brokkr_handle job)) on its own thread and reports its end as BROKKR_EVENT_JOB_DONE.
+template <class F>
+brokkr_handle brokkr_ctx::start(F fn) {
+  auto job = std::make_shared<Job>();
+  {
+    std::lock_guard lk(m);
+    job->id = next_handle++;
+    jobs.emplace(job->id, job);
+  }
+
+  job->thread = std::jthread([this, job, fn = std::move(fn)]() mutable {
+    JobResult r;
+    try {
+      r = fn(job->id);
+    } catch (const std::exception& e) {
+      r = {BROKKR_ERR_FAILED, e.what(), 0};
+    } catch (...) {
+      r = {BROKKR_ERR_FAILED, "unknown exception", 0};
+    }
+
+    brokkr_event ev{};
+    ev.job = job->id;
+    ev.type = BROKKR_EVENT_JOB_DONE;
+    ev.status = r.status;
+    ev.a = r.package;
+    set_text(ev, r.error);
+
+    emit(ev); // before waking waiters, so the event is already queued when brokkr_job_wait() returns
+    {
+      std::lock_guard lk(job->m);
+      job->status = r.status;
+      job->error = std::move(r.error);
+      job->package = r.package;
+      job->done = true;
+    }
+    job->cv.notify_all();
+
+    std::lock_guard lk(m);
+    finished.push_back(job->id);
+  });
+
+  // Forget the oldest finished jobs; their threads have already returned, or are about to.
+  std::vector<std::shared_ptr<Job>> evicted;
+  {
+    std::lock_guard lk(m);
+    while (finished.size() > kMaxFinishedJobs) {
+      const auto it = jobs.find(finished.front());
+      if (it != jobs.end()) {
+        evicted.push_back(std::move(it->second));
+        jobs.erase(it);
+      }
+      finished.erase(finished.begin());
+    }
+  }
+  for (auto& j : evicted)
+    if (j->thread.joinable()) j->thread.join();
+
+  return job->id;
+}
+
+extern "C" {
+
+int brokkr_abi_version(void) { return BROKKR_ABI_VERSION; }
+
+const char* brokkr_last_error(void) { return t_last_error.c_str(); }
+
+void brokkr_set_log_level(int level) {
+  init_once();
+  spdlog::set_level(static_cast<spdlog::level::level_enum>(std::clamp(level, 0, 6)));
+}
+
+brokkr_ctx* brokkr_create(size_t event_capacity) {
+  try {
+    init_once();
+    auto* ctx = new brokkr_ctx(event_capacity);
+    ctx->profile = brokkr::app::memory_profile_from_env();
+    return ctx;
+  } catch (const std::exception& e) {
+    fail(BROKKR_ERR_FAILED, e.what());
+    return nullptr;
+  }
+}
+
+void brokkr_destroy(brokkr_ctx* ctx) {
+  if (!ctx) return;
+  std::map<brokkr_handle, std::shared_ptr<Job>> jobs;
+  {
+    std::lock_guard lk(ctx->m);
+    jobs = ctx->jobs;
+  }
+  for (auto& [id, j] : jobs)
+    if (j->thread.joinable()) j->thread.join();
+  delete ctx;
+}
+
+int brokkr_list_devices(brokkr_ctx* ctx, char* buf, size_t cap, size_t* needed) {
+  if (!ctx) return fail(BROKKR_ERR_INVALID, "null context");
+  return guarded([&]() -> int {
+    Json arr = Json::Array{};
+    for (const auto& d : brokkr::app::enumerate_samsung_targets()) {
+      Json dev;
+      dev["sysname"] = d.sysname;
+      dev["devnode"] = d.devnode();
+      dev["odin"] = brokkr::app::is_odin_product(d.product);
+      arr.push_back(std::move(dev));
+    }
+    return copy_out(arr.dump(), buf, cap, needed);
+  });
+}
+
+int brokkr_prepare(brokkr_ctx* ctx, const char* const* inputs, size_t input_count, const char* pit,
+                   brokkr_handle* job) {
+  if (!ctx || !job || (input_count && !inputs)) return fail(BROKKR_ERR_INVALID, "invalid argument");
+  return guarded([&]() -> int {
+    std::vector<std::filesystem::path> paths;
+    for (std::size_t i = 0; i < input_count; ++i) {
+      if (!inputs[i] || !*inputs[i]) return fail(BROKKR_ERR_INVALID, "empty input path");
+      paths.emplace_back(inputs[i]);
+    }
+    std::optional<std::filesystem::path> pit_path;
+    if (pit && *pit) pit_path = pit;
+    if (paths.empty() && !pit_path) return fail(BROKKR_ERR_INVALID, "No files selected.");
+
+    *job = ctx->start([ctx, paths = std::move(paths), pit_path](brokkr_handle id) -> JobResult {
+      auto key = brokkr::app::package_key(paths, pit_path);
+      if (!key) return {BROKKR_ERR_FAILED, std::move(key.error()), 0};
+      {
+        std::lock_guard lk(ctx->m);
+        for (const auto& [h, cp] : ctx->packages)
+          if (cp.key == *key) return {BROKKR_OK, {}, h};
+      }
+
+      std::atomic_bool devfail{false};
+      const auto ui = ctx->make_ui(id, devfail);
+
+      std::shared_ptr<const std::vector<std::byte>> pit_bytes;
+      if (pit_path) {
+        auto loaded = brokkr::app::load_pit_file(*pit_path);
+        if (!loaded) return {BROKKR_ERR_FAILED, std::move(loaded.error()), 0};
+        pit_bytes = std::move(*loaded);
+      }
+      auto pkg = brokkr::app::prepare_package(paths, std::move(pit_bytes), ui, brokkr::app::hash_limits(ctx->profile));
+      if (!pkg) return {BROKKR_ERR_FAILED, std::move(pkg.error()), 0};
+
+      std::lock_guard lk(ctx->m);
+      if (ctx->package_order.size() >= kMaxCachedPackages) {
+        ctx->packages.erase(ctx->package_order.front());
+        ctx->package_order.erase(ctx->package_order.begin());
+      }
+      const brokkr_handle h = ctx->next_handle++;
+      ctx->packages.emplace(h, CachedPackage{std::move(*key), paths, pit_path,
+                                             std::make_shared<const brokkr::app::Package>(std::move(*pkg))});
+      ctx->package_order.push_back(h);
+      return {BROKKR_OK, {}, h};
+    });
+    return BROKKR_OK;
+  });
+}
+
+int brokkr_package_info(brokkr_ctx* ctx, brokkr_handle package, char* buf, size_t cap, size_t* needed) {
+  if (!ctx) return fail(BROKKR_ERR_INVALID, "null context");
+  return guarded([&]() -> int {
+    std::shared_ptr<const brokkr::app::Package> pkg;
+    {
+      std::lock_guard lk(ctx->m);
+      const auto it = ctx->packages.find(package);
+      if (it == ctx->packages.end()) return fail(BROKKR_ERR_INVALID, "unknown package");
+      pkg = it->second.pkg;
+    }
+
+    Json res;
+    res["pit"] = static_cast<bool>(pkg->pit);
+    res["items"] = Json::Array{};
+    for (const auto& s : pkg->specs) {
+      Json item;
+      item["name"] = s.basename;
+      item["size"] = s.size;
+      item["lz4"] = s.lz4;
+      res["items"].push_back(std::move(item));
+    }
+    return copy_out(res.dump(), buf, cap, needed);
+  });
+}
+
+int brokkr_package_release(brokkr_ctx* ctx, brokkr_handle package) {
+  if (!ctx) return fail(BROKKR_ERR_INVALID, "null context");
+  std::lock_guard lk(ctx->m);
+  if (!ctx->packages.erase(package)) return fail(BROKKR_ERR_INVALID, "unknown package");
+  std::erase(ctx->package_order, package);
+  return BROKKR_OK;
+}
+
+int brokkr_flash(brokkr_ctx* ctx, const brokkr_flash_options* opts, brokkr_handle* job) {
+  if (!ctx || !opts || !job || opts->struct_size < sizeof(brokkr_flash_options))
+    return fail(BROKKR_ERR_INVALID, "invalid argument");
+  if (opts->remote_count && !opts->remotes) return fail(BROKKR_ERR_INVALID, "invalid argument");
+
+  return guarded([&]() -> int {
+    CachedPackage cp;
+    {
+      std::lock_guard lk(ctx->m);
+      const auto it = ctx->packages.find(opts->package);
+      if (it == ctx->packages.end()) return fail(BROKKR_ERR_INVALID, "unknown package");
+      cp = it->second;
+    }
+
+    brokkr::app::ProviderOpts devices;
+    if (opts->target && *opts->target) devices.target = opts->target;
+    for (std::size_t i = 0; i < opts->remote_count; ++i)
+      if (opts->remotes[i] && *opts->remotes[i]) devices.remotes.emplace_back(opts->remotes[i]);
+    devices.remote_lz4 = opts->remote_lz4 != 0;
+
+    brokkr::odin::Cfg cfg;
+    cfg.reboot_after = !opts->no_reboot;
+    brokkr::app::apply_memory_profile(ctx->profile, cfg);
+
+    *job = ctx->start([ctx, cp = std::move(cp), devices = std::move(devices), cfg](brokkr_handle id) -> JobResult {
+      std::lock_guard flash_lk(ctx->flash_mtx);
+      auto key = brokkr::app::package_key(cp.inputs, cp.pit);
+      if (!key) return {BROKKR_ERR_FAILED, std::move(key.error()), 0};
+      if (*key != cp.key) return {BROKKR_ERR_FAILED, "Package changed on disk; prepare it again", 0};
+
+      std::atomic_bool devfail{false};
+      const auto ui = ctx->make_ui(id, devfail);
+
+      auto provider = brokkr::app::make_provider(devices, cfg);
+      if (!provider) return {BROKKR_ERR_FAILED, std::move(provider.error()), 0};
+
+      auto st = brokkr::odin::flash(provider->ptrs, cp.pkg->specs, cp.pkg->pit, cfg, ui);
+      if (!st) {
+        const bool dev = devfail.load(std::memory_order_relaxed);
+        return {dev ? BROKKR_ERR_DEVICE : BROKKR_ERR_FAILED, std::move(st.error()), 0};
+      }
+      return {};
+    });
+    return BROKKR_OK;
+  });
+}
+
+int brokkr_job_wait(brokkr_ctx* ctx, brokkr_handle job, int timeout_ms, brokkr_handle* package) {
+  if (!ctx) return fail(BROKKR_ERR_INVALID, "null context");
+  const auto j = ctx->job(job);
+  if (!j) return fail(BROKKR_ERR_INVALID, "unknown job");
+
+  std::unique_lock lk(j->m);
+  if (timeout_ms < 0)
+    j->cv.wait(lk, [&] { return j->done; });
+  else if (!j->cv.wait_for(lk, std::chrono::milliseconds(timeout_ms), [&] { return j->done; }))
+    return BROKKR_PENDING;
+
+  if (package) *package = j->package;
+  if (j->status != BROKKR_OK) return fail(j->status, j->error);
+  return BROKKR_OK;
+}
+
+size_t brokkr_poll(brokkr_ctx* ctx, brokkr_event* out, size_t max) {
+  if (!ctx || !out) return 0;
+  std::size_t n = 0;
+  while (n < max) {
+    auto ev = ctx->events.try_pop();
+    if (!ev) break;
+    out[n++] = *ev;
+  }
+  return n;
+}
+
+uint64_t brokkr_events_dropped(brokkr_ctx* ctx) {
+  return ctx ? ctx->dropped.load(std::memory_order_relaxed) : 0;
+}
+
+} // extern "C"
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * libbrokkr: the flashing engine behind a stable C ABI, for harnesses that drive many jobs from one
+ * process (ctypes, cgo, ...) and keep package caches warm between them.
+ *
+ * Work runs asynchronously: brokkr_prepare() and brokkr_flash() return a job handle at once, and the job
+ * reports through a bounded lock-free event ring that the caller drains with brokkr_poll(). The engine never
+ * calls into foreign code, and a full ring drops events (counted by brokkr_events_dropped()) instead of
+ * stalling a transfer. The final outcome of a job does not depend on the ring: brokkr_job_wait() returns it.
+ *
+ * All functions are thread-safe. Strings are UTF-8. Handles are never 0.
+ */
+
+#ifndef BROKKR_H
+#define BROKKR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(BROKKR_CAPI_BUILD)
+#define BROKKR_API __declspec(dllexport)
+#else
+#define BROKKR_API __declspec(dllimport)
+#endif
+#else
+#define BROKKR_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on any incompatible change to the functions or structs below. */
+#define BROKKR_ABI_VERSION 1
+
+typedef struct brokkr_ctx brokkr_ctx;
+typedef uint64_t brokkr_handle;
+
+enum {
+  BROKKR_OK = 0,
+  BROKKR_PENDING = 1,         /* job still running */
+  BROKKR_ERR_FAILED = -1,     /* see brokkr_last_error() */
+  BROKKR_ERR_DEVICE = -2,     /* one or more devices failed during the flash */
+  BROKKR_ERR_INVALID = -3,    /* bad argument or unknown handle */
+  BROKKR_ERR_BUFFER = -4      /* output buffer too small; *needed holds the size */
+};
+
+enum {
+  BROKKR_EVENT_STAGE = 1,   /* text */
+  BROKKR_EVENT_MODEL,       /* text */
+  BROKKR_EVENT_DEVICES,     /* a: device count, text: ids separated by '\n' */
+  BROKKR_EVENT_PLAN,        /* a: item count, b: total bytes */
+  BROKKR_EVENT_ITEM_ACTIVE, /* a: item index */
+  BROKKR_EVENT_ITEM_DONE,   /* a: item index */
+  BROKKR_EVENT_PROGRESS,    /* a: bytes done, b: total, c: item bytes done, d: item total; throttled */
+  BROKKR_EVENT_ERROR,       /* text; "DEVFAIL idx=N ..." for a single device */
+  BROKKR_EVENT_JOB_DONE     /* status: final BROKKR_* code, a: package handle of a prepare job, text: error */
+};
+
+#define BROKKR_EVENT_TEXT_MAX 240
+
+typedef struct brokkr_event {
+  brokkr_handle job;
+  int32_t type;
+  int32_t status;
+  uint64_t a, b, c, d;
+  char text[BROKKR_EVENT_TEXT_MAX]; /* NUL-terminated, truncated if longer */
+} brokkr_event;
+
+typedef struct brokkr_flash_options {
+  size_t struct_size;          /* sizeof(brokkr_flash_options) */
+  brokkr_handle package;       /* from a finished brokkr_prepare() */
+  const char* target;          /* USB sysname; NULL: every device in Odin Mode */
+  const char* const* remotes;  /* host[:port] of `brokkr agent`s; replaces local USB when non-empty */
+  size_t remote_count;
+  int remote_lz4;              /* compress windows sent to agents */
+  int no_reboot;
+} brokkr_flash_options;
+
+BROKKR_API int brokkr_abi_version(void);
+
+/* Message of the last failed call on the calling thread; valid until its next call. */
+BROKKR_API const char* brokkr_last_error(void);
+
+/* spdlog levels: 0 trace ... 4 error, 5 critical, 6 off. The library starts at warnings. */
+BROKKR_API void brokkr_set_log_level(int level);
+
+/* event_capacity: ring slots, rounded up to a power of two; 0 picks a default. */
+BROKKR_API brokkr_ctx* brokkr_create(size_t event_capacity);
+/* Waits for running jobs, then frees everything. */
+BROKKR_API void brokkr_destroy(brokkr_ctx* ctx);
+
+/* JSON array of {sysname, devnode, odin} for connected Samsung USB devices. */
+BROKKR_API int brokkr_list_devices(brokkr_ctx* ctx, char* buf, size_t cap, size_t* needed);
+
+/* Verifies and indexes a package (MD5/XXH3 and tar index caches apply). A package whose files are unchanged
+   since an earlier prepare in this context finishes at once with the same handle. pit may be NULL. */
+BROKKR_API int brokkr_prepare(brokkr_ctx* ctx, const char* const* inputs, size_t input_count, const char* pit,
+                              brokkr_handle* job);
+/* JSON object {pit, items: [{name, size, lz4}]}. */
+BROKKR_API int brokkr_package_info(brokkr_ctx* ctx, brokkr_handle package, char* buf, size_t cap, size_t* needed);
+BROKKR_API int brokkr_package_release(brokkr_ctx* ctx, brokkr_handle package);
+
+/* Flash jobs in one context run one after another, in the order they were started. */
+BROKKR_API int brokkr_flash(brokkr_ctx* ctx, const brokkr_flash_options* opts, brokkr_handle* job);
+
+/* BROKKR_PENDING after timeout_ms (negative: wait forever), else the job's final code. On success of a
+   prepare job, *package receives its handle (package may be NULL). */
+BROKKR_API int brokkr_job_wait(brokkr_ctx* ctx, brokkr_handle job, int timeout_ms, brokkr_handle* package);
+
+/* Moves up to max pending events into out without blocking; returns how many. */
+BROKKR_API size_t brokkr_poll(brokkr_ctx* ctx, brokkr_event* out, size_t max);
+BROKKR_API uint64_t brokkr_events_dropped(brokkr_ctx* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BROKKR_H */
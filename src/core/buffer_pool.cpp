@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "core/buffer_pool.hpp"
+
+#include <algorithm>
+
+namespace brokkr::core {
+
+namespace {
+
+constexpr std::size_t kDefaultRetainedBytes = 64ull * 1024 * 1024;
+
+} // namespace
+
+std::vector<std::byte> BufferPool::take(std::size_t capacity) {
+  {
+    std::lock_guard lk(mtx_);
+    // Smallest parked buffer that fits, so large windows are not burned on small requests.
+    auto best = free_.end();
+    for (auto it = free_.begin(); it != free_.end(); ++it)
+      if (it->capacity() >= capacity && (best == free_.end() || it->capacity() < best->capacity())) best = it;
+
+    if (best != free_.end()) {
+      std::vector<std::byte> v = std::move(*best);
+      free_.erase(best);
+      retained_ -= v.capacity();
+      return v;
+    }
+  }
+
+  std::vector<std::byte> v;
+  v.reserve(capacity);
+  return v;
+}
+
+void BufferPool::give(std::vector<std::byte> v) noexcept {
+  if (!v.capacity()) return;
+  v.clear();
+
+  std::lock_guard lk(mtx_);
+  if (v.capacity() > max_retained_) return;
+  retained_ += v.capacity();
+  free_.push_back(std::move(v));
+  trim_locked_();
+}
+
+void BufferPool::set_max_retained(std::size_t bytes) noexcept {
+  std::lock_guard lk(mtx_);
+  max_retained_ = bytes;
+  trim_locked_();
+}
+
+std::size_t BufferPool::retained_bytes() const noexcept {
+  std::lock_guard lk(mtx_);
+  return retained_;
+}
+
+void BufferPool::trim_locked_() noexcept {
+  // Oldest buffers go first.
+  while (retained_ > max_retained_ && !free_.empty()) {
+    retained_ -= free_.front().capacity();
+    free_.erase(free_.begin());
+  }
+}
+
+BufferPool& buffer_pool() noexcept {
+  static BufferPool pool(kDefaultRetainedBytes);
+  return pool;
+}
+
+} // namespace brokkr::core
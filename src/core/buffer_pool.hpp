@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace brokkr::core {
+
+// Released stream/hash buffers are parked here so the next item or stage reuses their pages
+// instead of faulting in fresh ones. Anything beyond the retention cap is freed.
+class BufferPool {
+ public:
+  explicit BufferPool(std::size_t max_retained_bytes) noexcept : max_retained_(max_retained_bytes) {}
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  // Empty vector with at least `capacity` reserved.
+  std::vector<std::byte> take(std::size_t capacity);
+  void give(std::vector<std::byte> v) noexcept;
+
+  void set_max_retained(std::size_t bytes) noexcept;
+  std::size_t retained_bytes() const noexcept;
+
+ private:
+  void trim_locked_() noexcept;
+
+ private:
+  mutable std::mutex mtx_;
+  std::vector<std::vector<std::byte>> free_;
+  std::size_t retained_ = 0;
+  std::size_t max_retained_ = 0;
+};
+
+BufferPool& buffer_pool() noexcept;
+
+// A pool buffer that returns itself on destruction.
+class PooledBytes {
+ public:
+  PooledBytes() = default;
+  explicit PooledBytes(std::size_t capacity) : v_(buffer_pool().take(capacity)) {}
+  ~PooledBytes() { release_(); }
+
+  PooledBytes(const PooledBytes&) = delete;
+  PooledBytes& operator=(const PooledBytes&) = delete;
+
+  PooledBytes(PooledBytes&& o) noexcept : v_(std::exchange(o.v_, {})) {}
+  PooledBytes& operator=(PooledBytes&& o) noexcept {
+    if (this != &o) {
+      release_();
+      v_ = std::exchange(o.v_, {});
+    }
+    return *this;
+  }
+
+  std::vector<std::byte>& operator*() noexcept { return v_; }
+  const std::vector<std::byte>& operator*() const noexcept { return v_; }
+  std::vector<std::byte>* operator->() noexcept { return &v_; }
+  const std::vector<std::byte>* operator->() const noexcept { return &v_; }
+
+ private:
+  void release_() noexcept {
+    if (v_.capacity()) buffer_pool().give(std::move(v_));
+    v_ = {};
+  }
+
+  std::vector<std::byte> v_;
+};
+
+} // namespace brokkr::core
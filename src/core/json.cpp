@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "core/json.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+namespace brokkr::core {
+
+namespace {
+
+constexpr int kMaxDepth = 64;
+
+class Parser {
+ public:
+  explicit Parser(std::string_view s) : s_(s) {}
+
+  Result<Json> run() {
+    BRK_TRYV(v, value_(0));
+    ws_();
+    if (i_ != s_.size()) return err_("trailing data");
+    return v;
+  }
+
+ private:
+  std::unexpected<Error> err_(std::string_view what) const { return failf("json: {} at offset {}", what, i_); }
+
+  void ws_() {
+    while (i_ < s_.size() && (s_[i_] == ' ' || s_[i_] == '\t' || s_[i_] == '\n' || s_[i_] == '\r')) ++i_;
+  }
+
+  bool eat_(std::string_view lit) {
+    if (s_.substr(i_, lit.size()) != lit) return false;
+    i_ += lit.size();
+    return true;
+  }
+
+  Result<Json> value_(int depth) {
+    if (depth > kMaxDepth) return err_("nesting too deep");
+    ws_();
+    if (i_ >= s_.size()) return err_("unexpected end");
+
+    const char c = s_[i_];
+    if (c == '{') return object_(depth);
+    if (c == '[') return array_(depth);
+    if (c == '"') {
+      BRK_TRYV(str, string_());
+      return Json(std::move(str));
+    }
+    if (eat_("true")) return Json(true);
+    if (eat_("false")) return Json(false);
+    if (eat_("null")) return Json(nullptr);
+    return number_();
+  }
+
+  Result<Json> object_(int depth) {
+    ++i_;
+    Json::Object o;
+    ws_();
+    if (i_ < s_.size() && s_[i_] == '}') {
+      ++i_;
+      return Json(std::move(o));
+    }
+    for (;;) {
+      ws_();
+      if (i_ >= s_.size() || s_[i_] != '"') return err_("expected key");
+      BRK_TRYV(key, string_());
+      ws_();
+      if (i_ >= s_.size() || s_[i_] != ':') return err_("expected ':'");
+      ++i_;
+      BRK_TRYV(v, value_(depth + 1));
+      o.insert_or_assign(std::move(key), std::move(v));
+      ws_();
+      if (i_ < s_.size() && s_[i_] == ',') {
+        ++i_;
+        continue;
+      }
+      if (i_ < s_.size() && s_[i_] == '}') {
+        ++i_;
+        return Json(std::move(o));
+      }
+      return err_("expected ',' or '}'");
+    }
+  }
+
+  Result<Json> array_(int depth) {
+    ++i_;
+    Json::Array a;
+    ws_();
+    if (i_ < s_.size() && s_[i_] == ']') {
+      ++i_;
+      return Json(std::move(a));
+    }
+    for (;;) {
+      BRK_TRYV(v, value_(depth + 1));
+      a.push_back(std::move(v));
+      ws_();
+      if (i_ < s_.size() && s_[i_] == ',') {
+        ++i_;
+        continue;
+      }
+      if (i_ < s_.size() && s_[i_] == ']') {
+        ++i_;
+        return Json(std::move(a));
+      }
+      return err_("expected ',' or ']'");
+    }
+  }
+
+  Result<unsigned> hex4_() {
+    if (s_.size() - i_ < 4) return err_("short \\u escape");
+    unsigned v = 0;
+    const auto r = std::from_chars(s_.data() + i_, s_.data() + i_ + 4, v, 16);
+    if (r.ec != std::errc{} || r.ptr != s_.data() + i_ + 4) return err_("bad \\u escape");
+    i_ += 4;
+    return v;
+  }
+
+  static void put_utf8_(std::string& out, unsigned cp) {
+    if (cp < 0x80) {
+      out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+      out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+      out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+      out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+  }
+
+  Result<std::string> string_() {
+    ++i_;
+    std::string out;
+    while (i_ < s_.size()) {
+      const char c = s_[i_++];
+      if (c == '"') return out;
+      if (static_cast<unsigned char>(c) < 0x20) return err_("control character in string");
+      if (c != '\\') {
+        out.push_back(c);
+        continue;
+      }
+      if (i_ >= s_.size()) break;
+      const char e = s_[i_++];
+      switch (e) {
+        case '"': out.push_back('"'); break;
+        case '\\': out.push_back('\\'); break;
+        case '/': out.push_back('/'); break;
+        case 'b': out.push_back('\b'); break;
+        case 'f': out.push_back('\f'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 't': out.push_back('\t'); break;
+        case 'u': {
+          BRK_TRYV(cp, hex4_());
+          if (cp >= 0xD800 && cp < 0xDC00 && eat_("\\u")) {
+            BRK_TRYV(lo, hex4_());
+            if (lo < 0xDC00 || lo >= 0xE000) return err_("bad surrogate pair");
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+          }
+          put_utf8_(out, cp);
+          break;
+        }
+        default: return err_("bad escape");
+      }
+    }
+    return err_("unterminated string");
+  }
+
+  Result<Json> number_() {
+    const std::size_t start = i_;
+    if (i_ < s_.size() && s_[i_] == '-') ++i_;
+    while (i_ < s_.size()) {
+      const char c = s_[i_];
+      if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+        ++i_;
+        continue;
+      }
+      break;
+    }
+    if (i_ == start) return err_("unexpected character");
+
+    double v = 0;
+    const auto r = std::from_chars(s_.data() + start, s_.data() + i_, v);
+    if (r.ec != std::errc{} || r.ptr != s_.data() + i_) return err_("bad number");
+    return Json(v);
+  }
+
+  std::string_view s_;
+  std::size_t i_ = 0;
+};
+
+void dump_string(std::string& out, std::string_view s) {
+  out.push_back('"');
+  for (const char c : s) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(static_cast<unsigned char>(c)));
+          out += buf;
+        } else {
+          out.push_back(c);
+        }
+    }
+  }
+  out.push_back('"');
+}
+
+void dump_number(std::string& out, double v) {
+  if (!std::isfinite(v)) {
+    out += "null";
+    return;
+  }
+  char buf[32];
+  constexpr double kExactInt = 9007199254740992.0;
+  const auto r = (std::trunc(v) == v && std::fabs(v) < kExactInt)
+                     ? std::to_chars(buf, buf + sizeof(buf), static_cast<std::int64_t>(v))
+                     : std::to_chars(buf, buf + sizeof(buf), v);
+  out.append(buf, r.ptr);
+}
+
+void dump_value(std::string& out, const Json& j) {
+  if (j.is_null()) {
+    out += "null";
+  } else if (j.is_bool()) {
+    out += j.as_bool() ? "true" : "false";
+  } else if (j.is_number()) {
+    dump_number(out, j.as_number());
+  } else if (j.is_string()) {
+    dump_string(out, j.as_string());
+  } else if (j.is_array()) {
+    out.push_back('[');
+    bool first = true;
+    for (const auto& v : j.array()) {
+      if (!first) out.push_back(',');
+      first = false;
+      dump_value(out, v);
+    }
+    out.push_back(']');
+  } else {
+    out.push_back('{');
+    bool first = true;
+    for (const auto& [k, v] : j.object()) {
+      if (!first) out.push_back(',');
+      first = false;
+      dump_string(out, k);
+      out.push_back(':');
+      dump_value(out, v);
+    }
+    out.push_back('}');
+  }
+}
+
+} // namespace
+
+Result<Json> Json::parse(std::string_view text) noexcept {
+  try {
+    return Parser(text).run();
+  } catch (const std::exception& e) {
+    return failf("json: {}", e.what());
+  }
+}
+
+std::string Json::dump() const {
+  std::string out;
+  dump_value(out, *this);
+  return out;
+}
+
+const Json::Array& Json::array() const noexcept {
+  static const Array kEmpty;
+  return is_array() ? std::get<Array>(v_) : kEmpty;
+}
+
+const Json::Object& Json::object() const noexcept {
+  static const Object kEmpty;
+  return is_object() ? std::get<Object>(v_) : kEmpty;
+}
+
+const Json* Json::find(std::string_view key) const noexcept {
+  if (!is_object()) return nullptr;
+  const auto& o = std::get<Object>(v_);
+  const auto it = o.find(key);
+  return it == o.end() ? nullptr : &it->second;
+}
+
+Json& Json::operator[](std::string_view key) {
+  if (!is_object()) v_ = Object{};
+  auto& o = std::get<Object>(v_);
+  auto it = o.find(key);
+  if (it == o.end()) it = o.emplace(std::string(key), Json{}).first;
+  return it->second;
+}
+
+void Json::push_back(Json v) {
+  if (!is_array()) v_ = Array{};
+  std::get<Array>(v_).push_back(std::move(v));
+}
+
+} // namespace brokkr::core
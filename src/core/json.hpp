@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "core/status.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace brokkr::core {
+
+class Json {
+ public:
+  using Array = std::vector<Json>;
+  using Object = std::map<std::string, Json, std::less<>>;
+
+  Json() = default;
+  Json(std::nullptr_t) {}
+  Json(bool b) : v_(b) {}
+  Json(int n) : v_(static_cast<double>(n)) {}
+  Json(std::int64_t n) : v_(static_cast<double>(n)) {}
+  Json(std::uint64_t n) : v_(static_cast<double>(n)) {}
+  Json(double n) : v_(n) {}
+  Json(const char* s) : v_(std::string(s)) {}
+  Json(std::string s) : v_(std::move(s)) {}
+  Json(std::string_view s) : v_(std::string(s)) {}
+  Json(Array a) : v_(std::move(a)) {}
+  Json(Object o) : v_(std::move(o)) {}
+
+  static Result<Json> parse(std::string_view text) noexcept;
+  std::string dump() const;
+
+  bool is_null() const noexcept { return std::holds_alternative<std::monostate>(v_); }
+  bool is_bool() const noexcept { return std::holds_alternative<bool>(v_); }
+  bool is_number() const noexcept { return std::holds_alternative<double>(v_); }
+  bool is_string() const noexcept { return std::holds_alternative<std::string>(v_); }
+  bool is_array() const noexcept { return std::holds_alternative<Array>(v_); }
+  bool is_object() const noexcept { return std::holds_alternative<Object>(v_); }
+
+  bool as_bool(bool def = false) const noexcept { return is_bool() ? std::get<bool>(v_) : def; }
+  double as_number(double def = 0) const noexcept { return is_number() ? std::get<double>(v_) : def; }
+  std::int64_t as_int(std::int64_t def = 0) const noexcept {
+    return is_number() ? static_cast<std::int64_t>(std::get<double>(v_)) : def;
+  }
+  std::string as_string(std::string def = {}) const { return is_string() ? std::get<std::string>(v_) : def; }
+
+  const Array& array() const noexcept;
+  const Object& object() const noexcept;
+
+  const Json* find(std::string_view key) const noexcept;
+
+  Json& operator[](std::string_view key);
+  void push_back(Json v);
+
+ private:
+  std::variant<std::monostate, bool, double, std::string, Array, Object> v_{};
+};
+
+} // namespace brokkr::core
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace brokkr::core {
+
+// Bounded lock-free multi-producer/multi-consumer queue (Dmitry Vyukov's sequenced ring). Each cell carries a
+// sequence number that tells producers and consumers whose turn it is, so neither side ever blocks or takes
+// a lock: a full ring makes try_push() fail, an empty one makes try_pop() return nullopt.
+template <class T>
+  requires std::is_default_constructible_v<T> && std::is_move_assignable_v<T>
+class MpmcRing {
+ public:
+  // Rounded up to a power of two, at least 2.
+  explicit MpmcRing(std::size_t capacity)
+      : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1), cells_(new Cell[mask_ + 1]) {
+    for (std::size_t i = 0; i <= mask_; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  MpmcRing(const MpmcRing&) = delete;
+  MpmcRing& operator=(const MpmcRing&) = delete;
+
+  std::size_t capacity() const noexcept { return mask_ + 1; }
+
+  bool try_push(T v) noexcept(std::is_nothrow_move_assignable_v<T>) {
+    std::size_t pos = tail_.load(std::memory_order_relaxed);
+    Cell* c = nullptr;
+    for (;;) {
+      c = &cells_[pos & mask_];
+      const std::size_t seq = c->seq.load(std::memory_order_acquire);
+      const auto dif = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (dif == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (dif < 0) {
+        return false; // full: the cell still holds the value from one lap ago
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    c->value = std::move(v);
+    c->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  std::optional<T> try_pop() noexcept(std::is_nothrow_move_constructible_v<T>) {
+    std::size_t pos = head_.load(std::memory_order_relaxed);
+    Cell* c = nullptr;
+    for (;;) {
+      c = &cells_[pos & mask_];
+      const std::size_t seq = c->seq.load(std::memory_order_acquire);
+      const auto dif = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+      if (dif == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (dif < 0) {
+        return std::nullopt; // empty: no producer has published this cell yet
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+    std::optional<T> out(std::move(c->value));
+    c->seq.store(pos + mask_ + 1, std::memory_order_release);
+    return out;
+  }
+
+ private:
+  static constexpr std::size_t kLine = 64;
+
+  struct Cell {
+    std::atomic<std::size_t> seq{0};
+    T value{};
+  };
+
+  const std::size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+
+  alignas(kLine) std::atomic<std::size_t> tail_{0};
+  alignas(kLine) std::atomic<std::size_t> head_{0};
+};
+
+} // namespace brokkr::core
@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "core/status.hpp"
+#include "core/trace.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional> // std::move_only_function
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+namespace brokkr::core {
+
+// Blocking FIFO with a fixed capacity. close() lets consumers drain what is
+// left; cancel() drops everything and wakes both sides.
+template <class T>
+class BoundedQueue {
+ public:
+  explicit BoundedQueue(std::size_t capacity) : cap_(capacity ? capacity : 1) {}
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  bool push(T v) {
+    std::unique_lock lk(m_);
+    can_push_.wait(lk, [&] { return cancelled_ || closed_ || q_.size() < cap_; });
+    if (cancelled_ || closed_) return false;
+    q_.push_back(std::move(v));
+    lk.unlock();
+    can_pop_.notify_one();
+    return true;
+  }
+
+  std::optional<T> pop() {
+    std::unique_lock lk(m_);
+    can_pop_.wait(lk, [&] { return cancelled_ || closed_ || !q_.empty(); });
+    if (cancelled_ || q_.empty()) return std::nullopt;
+    T v = std::move(q_.front());
+    q_.pop_front();
+    lk.unlock();
+    can_push_.notify_one();
+    return v;
+  }
+
+  void close() noexcept {
+    {
+      std::lock_guard lk(m_);
+      closed_ = true;
+    }
+    can_pop_.notify_all();
+    can_push_.notify_all();
+  }
+
+  void cancel() noexcept {
+    {
+      std::lock_guard lk(m_);
+      cancelled_ = true;
+      q_.clear();
+    }
+    can_pop_.notify_all();
+    can_push_.notify_all();
+  }
+
+  std::size_t capacity() const noexcept { return cap_; }
+
+ private:
+  const std::size_t cap_;
+
+  std::mutex m_;
+  std::condition_variable can_push_;
+  std::condition_variable can_pop_;
+  std::deque<T> q_;
+  bool closed_ = false;
+  bool cancelled_ = false;
+};
+
+namespace detail {
+
+template <class T>
+struct Seq {
+  std::uint64_t seq = 0;
+  T value;
+};
+
+// Shared by every stage of one pipeline: owns the threads, the first error
+// and the cancel hooks. The last Pipeline handle going away cancels and joins.
+class PipelineCore {
+ public:
+  PipelineCore() = default;
+  PipelineCore(const PipelineCore&) = delete;
+  PipelineCore& operator=(const PipelineCore&) = delete;
+
+  ~PipelineCore() {
+    cancel();
+    for (auto& t : threads_)
+      if (t.joinable()) t.join();
+  }
+
+  void on_cancel(std::move_only_function<void()> fn) {
+    std::lock_guard lk(m_);
+    if (cancelled_) {
+      fn();
+      return;
+    }
+    hooks_.push_back(std::move(fn));
+  }
+
+  void spawn(std::move_only_function<void(std::stop_token)> body) {
+    std::lock_guard lk(m_);
+    threads_.emplace_back([this, body = std::move(body)](std::stop_token st) mutable {
+      try {
+        body(st);
+      } catch (const std::exception& e) {
+        spdlog::debug("Pipeline stage threw: {}", e.what());
+        fail(e.what());
+      } catch (...) {
+        spdlog::debug("Pipeline stage threw unknown exception");
+        fail("Unknown exception in pipeline stage");
+      }
+    });
+  }
+
+  void fail(Error e) noexcept {
+    {
+      std::lock_guard lk(m_);
+      if (!error_) error_ = std::move(e);
+    }
+    cancel();
+  }
+
+  void cancel() noexcept {
+    std::vector<std::move_only_function<void()>> hooks;
+    {
+      std::lock_guard lk(m_);
+      if (cancelled_) return;
+      cancelled_ = true;
+      hooks.swap(hooks_);
+      for (auto& t : threads_) t.request_stop();
+    }
+    for (auto& h : hooks) h();
+  }
+
+  bool cancelled() const noexcept {
+    std::lock_guard lk(m_);
+    return cancelled_;
+  }
+
+  Status status() const noexcept {
+    std::lock_guard lk(m_);
+    return error_ ? Status{std::unexpect, *error_} : Status{};
+  }
+
+ private:
+  mutable std::mutex m_;
+  std::vector<std::jthread> threads_;
+  std::vector<std::move_only_function<void()>> hooks_;
+  std::optional<Error> error_;
+  bool cancelled_ = false;
+};
+
+// Lets N workers of one stage publish in input order.
+struct Turnstile {
+  std::mutex m;
+  std::condition_variable cv;
+  std::uint64_t next = 0;
+  bool cancelled = false;
+  std::size_t alive = 0;
+};
+
+} // namespace detail
+
+// Output end of a chain of stages connected by bounded queues:
+//
+//   auto p = Pipeline<Chunk>::source(fill).then(4, decompress).then(1, pad);
+//   while (auto w = p.next()) send(*w);
+//   BRK_TRY(p.status());
+//
+// A source runs on one thread and yields values until it returns nullopt.
+// Each then() stage runs on its own worker threads; items leave a stage in
+// the order they entered it regardless of the worker count. The first error
+// from any stage cancels the whole chain and is reported by status().
+template <class T>
+class Pipeline {
+ public:
+  using value_type = T;
+  using FillFn = std::move_only_function<Result<std::optional<T>>(std::stop_token)>;
+
+  static Pipeline source(FillFn fill, std::size_t depth = 1) {
+    auto core = std::make_shared<detail::PipelineCore>();
+    auto out = std::make_shared<BoundedQueue<detail::Seq<T>>>(depth);
+    core->on_cancel([out] { out->cancel(); });
+
+    core->spawn([c = core.get(), out, fill = std::move(fill)](std::stop_token st) mutable {
+      for (std::uint64_t seq = 0;; ++seq) {
+        if (st.stop_requested()) break;
+        BRK_TRACE(pipeline_fill_start, seq);
+        auto r = fill(st);
+        BRK_TRACE(pipeline_fill_end, seq, r.has_value() && r->has_value());
+        if (!r) {
+          c->fail(std::move(r.error()));
+          break;
+        }
+        if (!*r) break;
+        if (!out->push({seq, std::move(**r)})) break;
+      }
+      out->close();
+    });
+
+    return Pipeline(std::move(core), std::move(out));
+  }
+
+  Pipeline(Pipeline&&) noexcept = default;
+  Pipeline& operator=(Pipeline&&) noexcept = default;
+  Pipeline(const Pipeline&) = delete;
+  Pipeline& operator=(const Pipeline&) = delete;
+
+  ~Pipeline() {
+    if (core_) core_->cancel();
+  }
+
+  // fn: Result<U>(T&&). workers == 0 is treated as 1.
+  template <class F>
+  auto then(std::size_t workers, F fn, std::size_t depth = 1) && {
+    using R = std::invoke_result_t<F&, T&&>;
+    using U = typename R::value_type;
+
+    if (!workers) workers = 1;
+    auto out = std::make_shared<BoundedQueue<detail::Seq<U>>>(depth);
+    auto gate = std::make_shared<detail::Turnstile>();
+    gate->alive = workers;
+
+    core_->on_cancel([out, gate] {
+      out->cancel();
+      {
+        std::lock_guard lk(gate->m);
+        gate->cancelled = true;
+      }
+      gate->cv.notify_all();
+    });
+
+    auto shared_fn = std::make_shared<F>(std::move(fn));
+    for (std::size_t i = 0; i < workers; ++i) {
+      core_->spawn([c = core_.get(), in = q_, out, gate, shared_fn](std::stop_token) {
+        for (;;) {
+          auto item = in->pop();
+          if (!item) break;
+
+          auto r = (*shared_fn)(std::move(item->value));
+          if (!r) {
+            c->fail(std::move(r.error()));
+            break;
+          }
+
+          {
+            std::unique_lock lk(gate->m);
+            gate->cv.wait(lk, [&] { return gate->cancelled || gate->next == item->seq; });
+            if (gate->cancelled) break;
+          }
+          const bool ok = out->push({item->seq, std::move(*r)});
+          {
+            std::lock_guard lk(gate->m);
+            gate->next++;
+          }
+          gate->cv.notify_all();
+          if (!ok) break;
+        }
+
+        bool last_out = false;
+        {
+          std::lock_guard lk(gate->m);
+          last_out = (--gate->alive == 0);
+        }
+        if (last_out) out->close();
+      });
+    }
+
+    return Pipeline<U>(std::exchange(core_, nullptr), std::move(out));
+  }
+
+  // nullopt at end of stream, on error and after cancel(); check status().
+  std::optional<T> next() {
+    BRK_TRACE(pipeline_wait);
+    auto item = q_->pop();
+    if (!item) return std::nullopt;
+    BRK_TRACE(pipeline_handoff, item->seq);
+    return std::move(item->value);
+  }
+
+  Status status() const noexcept { return core_->status(); }
+
+  void cancel() noexcept { core_->cancel(); }
+
+ private:
+  template <class>
+  friend class Pipeline;
+
+  Pipeline(std::shared_ptr<detail::PipelineCore> core, std::shared_ptr<BoundedQueue<detail::Seq<T>>> q)
+      : core_(std::move(core)), q_(std::move(q)) {}
+
+  std::shared_ptr<detail::PipelineCore> core_;
+  std::shared_ptr<BoundedQueue<detail::Seq<T>>> q_;
+};
+
+} // namespace brokkr::core
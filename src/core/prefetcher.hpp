@@ -18,6 +18,7 @@
 #pragma once
 
 #include "core/status.hpp"
+#include "core/trace.hpp"
 
 #include <condition_variable>
 #include <exception>
@@ -103,6 +104,7 @@ class TwoSlotPrefetcher {
   }
 
   std::optional<Lease> next() noexcept {
+    BRK_TRACE(prefetch_wait);
     std::unique_lock lk(m_);
     cv_can_take_.wait(lk, [&] {
       return stopping_ || error_.has_value() || filled_[read_idx_] || (done_ && !filled_[read_idx_]);
@@ -112,6 +114,7 @@ class TwoSlotPrefetcher {
 
     const int idx = read_idx_;
     read_idx_ ^= 1;
+    BRK_TRACE(prefetch_lease, idx);
     return Lease{this, idx};
   }
 
@@ -122,6 +125,7 @@ class TwoSlotPrefetcher {
 
  private:
   void release_(int idx) noexcept {
+    BRK_TRACE(prefetch_release, idx);
     {
       std::lock_guard lk(m_);
       filled_[idx] = false;
@@ -142,7 +146,9 @@ class TwoSlotPrefetcher {
           }
         }
 
+        BRK_TRACE(prefetch_fill_start, write_idx_);
         auto r = fill_(slots_[write_idx_], st);
+        BRK_TRACE(prefetch_fill_end, write_idx_, r.has_value() && *r);
 
         {
           std::lock_guard lk(m_);
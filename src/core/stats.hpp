@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace brokkr::core {
+
+// Welford's online mean and variance: one pass, no stored samples, stable for long runs.
+struct RunningStats {
+  std::size_t n = 0;
+  double mean = 0;
+  double m2 = 0;
+
+  void add(double x) noexcept {
+    ++n;
+    const double d = x - mean;
+    mean += d / static_cast<double>(n);
+    m2 += d * (x - mean);
+  }
+
+  double variance() const noexcept { return n > 1 ? m2 / static_cast<double>(n - 1) : 0.0; }
+  double stddev() const noexcept { return std::sqrt(variance()); }
+};
+
+struct Interval {
+  double lo = 0;
+  double hi = 0;
+};
+
+// Two-sided 95% Student t quantile; fractional df (Welch) round down, which keeps intervals conservative.
+inline double t95(double df) noexcept {
+  static constexpr std::array<double, 30> kTable = {
+      12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131,
+      2.120,  2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  if (!(df >= 1)) return kTable[0];
+  if (df < 31) return kTable[static_cast<std::size_t>(df) - 1];
+  if (df < 40) return 2.042;
+  if (df < 60) return 2.021;
+  if (df < 120) return 2.000;
+  return 1.980;
+}
+
+// 95% interval of the mean; collapses to the mean below two samples.
+inline Interval mean_ci95(const RunningStats& s) noexcept {
+  if (s.n < 2) return {s.mean, s.mean};
+  const double h = t95(static_cast<double>(s.n - 1)) * s.stddev() / std::sqrt(static_cast<double>(s.n));
+  return {s.mean - h, s.mean + h};
+}
+
+// Welch 95% interval of a.mean - b.mean; needs two samples on each side.
+inline bool welch_ci95(const RunningStats& a, const RunningStats& b, Interval& out) noexcept {
+  if (a.n < 2 || b.n < 2) return false;
+  const double va = a.variance() / static_cast<double>(a.n);
+  const double vb = b.variance() / static_cast<double>(b.n);
+  const double se2 = va + vb;
+  const double d = a.mean - b.mean;
+  if (se2 <= 0) {
+    out = {d, d};
+    return true;
+  }
+  const double df = se2 * se2 / (va * va / static_cast<double>(a.n - 1) + vb * vb / static_cast<double>(b.n - 1));
+  const double h = t95(df) * std::sqrt(se2);
+  out = {d - h, d + h};
+  return true;
+}
+
+// Wilson 95% interval of a proportion; well behaved at 0 and n, unlike the normal approximation.
+inline Interval wilson95(std::size_t hits, std::size_t n) noexcept {
+  if (!n) return {0, 1};
+  constexpr double z = 1.959964;
+  const double nn = static_cast<double>(n);
+  const double p = static_cast<double>(hits) / nn;
+  const double den = 1 + z * z / nn;
+  const double mid = (p + z * z / (2 * nn)) / den;
+  const double h = z * std::sqrt(p * (1 - p) / nn + z * z / (4 * nn * nn)) / den;
+  return {std::max(0.0, mid - h), std::min(1.0, mid + h)};
+}
+
+} // namespace brokkr::core
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// USDT (user-level statically defined tracing) probes under the "brokkr" provider. Each one compiles to a
+// single nop plus an ELF note, so they cost nothing until bpftrace, perf or SystemTap attaches; no rebuild
+// or flag is needed to use them. List them with `bpftrace -l 'usdt:./brokkr-cli:brokkr:*'`, and see
+// tools/bpftrace for ready-made scripts.
+//
+// Arguments must be integers or pointers (pass strings as const char*), and cheap to evaluate: they are
+// computed even when nothing is attached. Without <sys/sdt.h>, and on other platforms, BRK_TRACE compiles to
+// nothing; its arguments are type-checked but never evaluated.
+
+#if defined(BROKKR_PLATFORM_LINUX) && !defined(BROKKR_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define BROKKR_HAVE_USDT 1
+#endif
+#endif
+
+#if defined(BROKKR_HAVE_USDT)
+#define BRK_TRACE(name, ...) STAP_PROBEV(brokkr, name __VA_OPT__(, ) __VA_ARGS__)
+#else
+namespace brokkr::core::detail {
+template <class... Args>
+constexpr void trace_args(const Args&...) noexcept {}
+} // namespace brokkr::core::detail
+
+#define BRK_TRACE(name, ...)                                                                                           \
+  do {                                                                                                                 \
+    if (false) ::brokkr::core::detail::trace_args(__VA_ARGS__);                                                        \
+  } while (0)
+#endif
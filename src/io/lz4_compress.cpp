@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "io/lz4_compress.hpp"
+
+#include "core/endian.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace brokkr::io {
+
+namespace {
+
+constexpr int kHashLog = 14;
+constexpr std::size_t kMinMatch = 4;
+constexpr std::size_t kLastLiterals = 5;
+constexpr std::size_t kMfLimit = 12;
+constexpr std::size_t kMaxOffset = 65535;
+constexpr std::size_t kFrameBlock = 1024 * 1024;
+constexpr std::uint32_t kUncompressedFlag = 0x80000000u;
+
+inline std::uint32_t read32(const std::uint8_t* p) noexcept {
+  std::uint32_t v;
+  std::memcpy(&v, p, 4);
+  return v;
+}
+
+inline std::uint32_t hash4(std::uint32_t v) noexcept { return (v * 2654435761u) >> (32 - kHashLog); }
+
+class Writer {
+ public:
+  Writer(std::uint8_t* p, std::size_t cap) : p_(p), end_(p + cap), start_(p) {}
+
+  bool sequence(const std::uint8_t* lit, std::size_t lit_len, std::size_t offset, std::size_t match_len) noexcept {
+    // token + literal length bytes + literals + offset + match length bytes
+    const std::size_t worst = 1 + lit_len / 255 + 1 + lit_len + 2 + match_len / 255 + 1;
+    if (static_cast<std::size_t>(end_ - p_) < worst) return false;
+
+    std::uint8_t* token = p_++;
+    const std::size_t ml = match_len ? match_len - kMinMatch : 0;
+    *token = static_cast<std::uint8_t>(((lit_len >= 15 ? 15 : lit_len) << 4) | (ml >= 15 ? 15 : ml));
+
+    put_len_(lit_len);
+    std::memcpy(p_, lit, lit_len);
+    p_ += lit_len;
+
+    if (match_len) {
+      *p_++ = static_cast<std::uint8_t>(offset & 0xFF);
+      *p_++ = static_cast<std::uint8_t>(offset >> 8);
+      put_len_(ml);
+    }
+    return true;
+  }
+
+  std::size_t size() const noexcept { return static_cast<std::size_t>(p_ - start_); }
+
+ private:
+  void put_len_(std::size_t n) noexcept {
+    if (n < 15) return;
+    n -= 15;
+    while (n >= 255) {
+      *p_++ = 255;
+      n -= 255;
+    }
+    *p_++ = static_cast<std::uint8_t>(n);
+  }
+
+  std::uint8_t* p_;
+  std::uint8_t* end_;
+  std::uint8_t* start_;
+};
+
+} // namespace
+
+std::size_t lz4_compress_block(std::span<const std::byte> src_b, std::span<std::byte> dst_b) noexcept {
+  const auto* src = reinterpret_cast<const std::uint8_t*>(src_b.data());
+  const std::size_t n = src_b.size();
+  Writer w(reinterpret_cast<std::uint8_t*>(dst_b.data()), dst_b.size());
+
+  std::size_t anchor = 0;
+  if (n >= kMfLimit + 1) {
+    // Positions are stored +1 so zero means "empty".
+    auto table = std::make_unique<std::uint32_t[]>(std::size_t{1} << kHashLog);
+
+    const std::size_t limit = n - kMfLimit;
+    const std::size_t match_limit = n - kLastLiterals;
+    std::size_t ip = 0;
+
+    while (ip < limit) {
+      const std::uint32_t seq = read32(src + ip);
+      const std::uint32_t h = hash4(seq);
+      const std::size_t ref1 = table[h];
+      table[h] = static_cast<std::uint32_t>(ip + 1);
+
+      if (ref1 && ip - (ref1 - 1) <= kMaxOffset && read32(src + ref1 - 1) == seq) {
+        std::size_t ref = ref1 - 1;
+        std::size_t start = ip;
+        while (start > anchor && ref > 0 && src[start - 1] == src[ref - 1]) {
+          --start;
+          --ref;
+        }
+
+        std::size_t end = ip + kMinMatch;
+        std::size_t r = ref + (end - start);
+        while (end < match_limit && src[end] == src[r]) {
+          ++end;
+          ++r;
+        }
+
+        if (!w.sequence(src + anchor, start - anchor, start - ref, end - start)) return 0;
+        anchor = end;
+        ip = end;
+        if (ip - 2 < limit) table[hash4(read32(src + ip - 2))] = static_cast<std::uint32_t>(ip - 2 + 1);
+        continue;
+      }
+
+      ip += 1 + ((ip - anchor) >> 6);
+    }
+  }
+
+  if (!w.sequence(src + anchor, n - anchor, 0, 0)) return 0;
+  return w.size();
+}
+
+std::size_t lz4_append_frame_block(std::span<const std::byte> src, std::vector<std::byte>& out) {
+  const std::size_t at = out.size();
+  out.resize(at + 4 + lz4_compress_bound(src.size()));
+
+  std::size_t n = lz4_compress_block(src, {out.data() + at + 4, out.size() - at - 4});
+  std::uint32_t hdr = static_cast<std::uint32_t>(n);
+  if (n == 0 || n >= src.size()) {
+    std::memcpy(out.data() + at + 4, src.data(), src.size());
+    n = src.size();
+    hdr = static_cast<std::uint32_t>(n) | kUncompressedFlag;
+  }
+
+  const std::uint32_t le = brokkr::core::host_to_le(hdr);
+  std::memcpy(out.data() + at, &le, 4);
+  out.resize(at + 4 + n);
+  return 4 + n;
+}
+
+std::size_t lz4_append_zero_block(std::size_t n, std::vector<std::byte>& out) {
+  static const std::vector<std::byte> zeros(kFrameBlock);
+  static const std::vector<std::byte> encoded = [] {
+    std::vector<std::byte> v;
+    lz4_append_frame_block(zeros, v);
+    return v;
+  }();
+
+  if (n != kFrameBlock) return lz4_append_frame_block(std::span(zeros).first(n), out);
+  out.insert(out.end(), encoded.begin(), encoded.end());
+  return encoded.size();
+}
+
+} // namespace brokkr::io
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace brokkr::io {
+
+// Greedy single-pass LZ4 block compressor; output decodes with LZ4_decompress_safe.
+// The vendored lz4.c only carries the decoder.
+constexpr std::size_t lz4_compress_bound(std::size_t n) noexcept { return n + n / 255 + 16; }
+
+// Returns the compressed size, or 0 when `dst` is too small.
+std::size_t lz4_compress_block(std::span<const std::byte> src, std::span<std::byte> dst) noexcept;
+
+// Append one frame block (4-byte LE size, then payload) to `out`. Data that does not shrink is
+// stored with the uncompressed flag. Returns the bytes appended.
+std::size_t lz4_append_frame_block(std::span<const std::byte> src, std::vector<std::byte>& out);
+
+// Same for n <= 1 MiB zero bytes; the full 1 MiB block is encoded once and copied.
+std::size_t lz4_append_zero_block(std::size_t n, std::vector<std::byte>& out);
+
+} // namespace brokkr::io
@@ -17,6 +17,7 @@
 
 #include "io/lz4_frame.hpp"
 
+#include "core/trace.hpp"
 #include "io/read_exact.hpp"
 
 #include <algorithm>
@@ -60,6 +61,21 @@ static std::size_t max_block_size_from_bd(std::uint8_t bd) {
   }
 }
 
+static brokkr::core::Status decode_block(bool uncompressed, const std::byte* payload, std::size_t n,
+                                         std::span<std::byte> out) noexcept {
+  if (uncompressed) {
+    if (n != out.size()) return brokkr::core::fail("LZ4: uncompressed block size mismatch");
+    std::memcpy(out.data(), payload, n);
+    return {};
+  }
+  const int ret = ::LZ4_decompress_safe(reinterpret_cast<const char*>(payload), reinterpret_cast<char*>(out.data()),
+                                        static_cast<int>(n), static_cast<int>(out.size()));
+  if (ret < 0) return brokkr::core::fail("LZ4: decompression failed (LZ4_decompress_safe)");
+  if (static_cast<std::size_t>(ret) != out.size())
+    return brokkr::core::fail("LZ4: decompression produced unexpected size");
+  return {};
+}
+
 } // namespace
 
 brokkr::core::Result<Lz4FrameHeaderInfo> parse_lz4_frame_header(ByteSource& src) noexcept {
@@ -109,13 +125,14 @@ brokkr::core::Result<Lz4FrameHeaderInfo> parse_lz4_frame_header(ByteSource& src)
   st = read_exact(src, std::span<std::byte>(hc.data(), hc.size()));
   if (!st) return brokkr::core::fail(std::move(st.error()));
 
-  info.header_bytes = 4 + 1 + 1 + 8 + 1;
+  info.header_bytes = kLz4FrameHeaderBytes;
   return info;
 }
 
 brokkr::core::Result<Lz4BlockStreamReader> Lz4BlockStreamReader::open(std::unique_ptr<ByteSource> src) noexcept {
   if (!src) return brokkr::core::fail("LZ4: null source");
   BRK_TRYV(h, parse_lz4_frame_header(*src));
+  BRK_TRACE(lz4_open, h.content_size, h.max_block_size);
   return Lz4BlockStreamReader(std::move(src), h);
 }
 
@@ -210,16 +227,9 @@ brokkr::core::Status Lz4DecompressedSource::fill_next_block_() noexcept {
 
   block_out_.resize(expected_out);
 
-  if (uncompressed) {
-    if (payload != expected_out) return brokkr::core::fail("LZ4: uncompressed block size mismatch");
-    std::memcpy(block_out_.data(), comp_payload_.data(), payload);
-  } else {
-    const int ret = ::LZ4_decompress_safe(comp_payload_.data(), reinterpret_cast<char*>(block_out_.data()),
-                                          static_cast<int>(payload), static_cast<int>(expected_out));
-    if (ret < 0) return brokkr::core::fail("LZ4: decompression failed (LZ4_decompress_safe)");
-    if (static_cast<std::size_t>(ret) != expected_out)
-      return brokkr::core::fail("LZ4: decompression produced unexpected size");
-  }
+  st = decode_block(uncompressed, reinterpret_cast<const std::byte*>(comp_payload_.data()), payload,
+                    {block_out_.data(), expected_out});
+  if (!st) return st;
 
   produced_ += expected_out;
   block_off_ = 0;
@@ -260,4 +270,29 @@ brokkr::core::Result<std::unique_ptr<ByteSource>> open_lz4_decompressed(std::uni
   return Lz4DecompressedSource::open(std::move(src));
 }
 
+brokkr::core::Status decode_lz4_blocks(std::span<const std::byte> blocks, std::span<std::byte> out) noexcept {
+  std::size_t in = 0;
+  std::size_t produced = 0;
+
+  while (produced < out.size()) {
+    if (blocks.size() - in < 4) return brokkr::core::fail("LZ4: truncated block header");
+    const std::uint32_t raw_sz = u32_le(std::span<const std::byte, 4>(blocks.data() + in, 4));
+    if (raw_sz == 0) return brokkr::core::fail("LZ4: encountered endmark unexpectedly while decoding");
+    in += 4;
+
+    const std::size_t payload = raw_sz & 0x7FFFFFFFu;
+    if (blocks.size() - in < payload) return brokkr::core::fail("LZ4: truncated block payload");
+
+    const std::size_t expected_out = std::min<std::size_t>(out.size() - produced, LZ4_ONE_MIB);
+    BRK_TRY(decode_block((raw_sz & 0x80000000u) != 0, blocks.data() + in, payload,
+                         out.subspan(produced, expected_out)));
+
+    in += payload;
+    produced += expected_out;
+  }
+
+  if (in != blocks.size()) return brokkr::core::fail("LZ4: trailing bytes after decoded blocks");
+  return {};
+}
+
 } // namespace brokkr::io
@@ -30,6 +30,8 @@
 namespace brokkr::io {
 
 inline constexpr std::uint64_t LZ4_ONE_MIB = 1024ull * 1024ull;
+// Magic, FLG, BD, content size and header checksum: the only layout parse_lz4_frame_header() accepts.
+inline constexpr std::size_t kLz4FrameHeaderBytes = 4 + 1 + 1 + 8 + 1;
 
 struct Lz4FrameHeaderInfo {
   std::uint64_t content_size = 0;
@@ -115,4 +117,8 @@ class Lz4DecompressedSource final : public ByteSource {
 
 brokkr::core::Result<std::unique_ptr<ByteSource>> open_lz4_decompressed(std::unique_ptr<ByteSource> src) noexcept;
 
+// Decodes consecutive blocks as returned by Lz4BlockStreamReader::read_n_blocks.
+// Every block but the last must expand to LZ4_ONE_MIB; out.size() is the total.
+brokkr::core::Status decode_lz4_blocks(std::span<const std::byte> blocks, std::span<std::byte> out) noexcept;
+
 } // namespace brokkr::io
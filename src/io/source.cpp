@@ -17,6 +17,10 @@
 
 #include "io/source.hpp"
 
+#include "io/zstd_seekable.hpp"
+
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <limits>
@@ -81,6 +85,116 @@ class TarEntrySource final : public ByteSource {
   std::uint64_t remaining_ = 0;
 };
 
+// A member of a seekable .tar.zst; the reader decodes the frames ahead of it in parallel.
+class ZstdTarEntrySource final : public ByteSource {
+ public:
+  ZstdTarEntrySource(std::filesystem::path tar, TarEntry e, std::unique_ptr<ZstdSeekableReader> z)
+      : tar_path_(std::move(tar)), entry_(std::move(e)), z_(std::move(z)), remaining_(entry_.size) {}
+
+  std::string display_name() const override { return tar_path_.string() + ":" + entry_.name; }
+  std::uint64_t size() const override { return entry_.size; }
+
+  std::size_t read(std::span<std::byte> out) override {
+    if (remaining_ == 0 || out.empty() || !st_) return 0;
+    const auto want = static_cast<std::size_t>(std::min<std::uint64_t>(remaining_, out.size()));
+    auto got = z_->read(out.first(want));
+    if (!got) {
+      st_ = brokkr::core::fail(std::move(got.error()));
+      return 0;
+    }
+    remaining_ -= *got;
+    return *got;
+  }
+
+  brokkr::core::Status status() const noexcept override { return st_; }
+
+ private:
+  std::filesystem::path tar_path_;
+  TarEntry entry_;
+  std::unique_ptr<ZstdSeekableReader> z_;
+  std::uint64_t remaining_ = 0;
+  brokkr::core::Status st_{};
+};
+
+SparseTarEntrySource::SparseTarEntrySource(std::filesystem::path tar, TarEntry e)
+    : tar_path_(std::move(tar)), entry_(std::move(e)), in_(tar_path_, std::ios::binary) {
+  stored_at_.reserve(entry_.sparse.size());
+  std::uint64_t at = entry_.data_offset;
+  for (const auto& x : entry_.sparse) {
+    stored_at_.push_back(at);
+    at += x.size;
+  }
+  file_pos_ = std::numeric_limits<std::uint64_t>::max();
+}
+
+brokkr::core::Result<std::unique_ptr<SparseTarEntrySource>> SparseTarEntrySource::open(
+    const std::filesystem::path& tar_path, const TarEntry& entry) noexcept {
+  if (!entry.is_sparse()) return brokkr::core::failf("open_tar_entry: not a sparse member: {}", entry.name);
+  if (is_seekable_zstd(tar_path))
+    return brokkr::core::failf("open_tar_entry: sparse members are not supported in compressed packages: {}",
+                               entry.name);
+
+  std::unique_ptr<SparseTarEntrySource> ptr(new SparseTarEntrySource(tar_path, entry));
+  if (!ptr->in_.is_open()) return brokkr::core::failf("open_tar_entry: cannot open tar: {}", tar_path.string());
+  return ptr;
+}
+
+bool SparseTarEntrySource::hole_ahead(std::uint64_t n) const noexcept {
+  const std::uint64_t end = std::min(entry_.size, pos_ + n);
+  for (std::size_t i = ext_; i < entry_.sparse.size(); ++i) {
+    if (!entry_.sparse[i].size || extent_end_(i) <= pos_) continue;
+    return entry_.sparse[i].offset >= end;
+  }
+  return true;
+}
+
+void SparseTarEntrySource::skip(std::uint64_t n) noexcept { pos_ = std::min(entry_.size, pos_ + n); }
+
+std::size_t SparseTarEntrySource::read(std::span<std::byte> out) {
+  const auto& map = entry_.sparse;
+  std::size_t done = 0;
+
+  while (done < out.size() && pos_ < entry_.size && st_) {
+    while (ext_ < map.size() && pos_ >= extent_end_(ext_)) ++ext_;
+    const std::uint64_t want = out.size() - done;
+
+    if (ext_ < map.size() && pos_ >= map[ext_].offset) {
+      const std::uint64_t off = stored_at_[ext_] + (pos_ - map[ext_].offset);
+      if (off != file_pos_) {
+        if (off > static_cast<std::uint64_t>(std::numeric_limits<std::streamoff>::max())) {
+          st_ = brokkr::core::failf("Sparse tar entry: offset too large: {}", display_name());
+          break;
+        }
+        in_.clear();
+        in_.seekg(static_cast<std::streamoff>(off), std::ios::beg);
+        if (!in_.good()) {
+          st_ = brokkr::core::failf("Sparse tar entry: seek failed: {}", display_name());
+          break;
+        }
+        file_pos_ = off;
+      }
+
+      const auto n = static_cast<std::size_t>(std::min(want, extent_end_(ext_) - pos_));
+      in_.read(reinterpret_cast<char*>(out.data() + done), static_cast<std::streamsize>(n));
+      if (in_.gcount() != static_cast<std::streamsize>(n)) {
+        st_ = brokkr::core::failf("Sparse tar entry: short read: {}", display_name());
+        break;
+      }
+      file_pos_ += n;
+      pos_ += n;
+      done += n;
+    } else {
+      const std::uint64_t next = ext_ < map.size() ? std::min(map[ext_].offset, entry_.size) : entry_.size;
+      const auto n = static_cast<std::size_t>(std::min(want, next - pos_));
+      std::memset(out.data() + done, 0, n);
+      pos_ += n;
+      done += n;
+    }
+  }
+
+  return done;
+}
+
 brokkr::core::Result<std::unique_ptr<ByteSource>> open_raw_file(const std::filesystem::path& path) noexcept {
   std::error_code ec;
   const auto sz = std::filesystem::file_size(path, ec);
@@ -94,6 +208,20 @@ brokkr::core::Result<std::unique_ptr<ByteSource>> open_raw_file(const std::files
 
 brokkr::core::Result<std::unique_ptr<ByteSource>> open_tar_entry(const std::filesystem::path& tar_path,
                                                                  const TarEntry& entry) noexcept {
+  if (entry.is_sparse()) {
+    BRK_TRYV(sp, SparseTarEntrySource::open(tar_path, entry));
+    return std::unique_ptr<ByteSource>(std::move(sp));
+  }
+
+  if (is_seekable_zstd(tar_path)) {
+    BRK_TRYV(z, ZstdSeekableReader::open(tar_path));
+    if (entry.size > z->size() || entry.data_offset > z->size() - entry.size)
+      return brokkr::core::failf("open_tar_entry: entry past end of archive: {}", entry.name);
+    BRK_TRY(z->seek(entry.data_offset));
+    z->set_read_ahead_limit(entry.data_offset + entry.size);
+    return std::unique_ptr<ByteSource>(std::make_unique<ZstdTarEntrySource>(tar_path, entry, std::move(z)));
+  }
+
   auto ptr = std::make_unique<TarEntrySource>(tar_path, entry);
 
   if (!ptr->opened()) return brokkr::core::failf("open_tar_entry: cannot open tar: {}", tar_path.string());
@@ -23,9 +23,11 @@
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
+#include <fstream>
 #include <memory>
 #include <span>
 #include <string>
+#include <vector>
 
 namespace brokkr::io {
 
@@ -41,6 +43,43 @@ class ByteSource {
   virtual brokkr::core::Status status() const noexcept { return {}; }
 };
 
+// A sparse tar member expanded to its logical size: extents are read from the archive, holes are
+// zero-filled without touching the disk.
+class SparseTarEntrySource final : public ByteSource {
+ public:
+  static brokkr::core::Result<std::unique_ptr<SparseTarEntrySource>> open(const std::filesystem::path& tar_path,
+                                                                          const TarEntry& entry) noexcept;
+
+  std::string display_name() const override { return tar_path_.string() + ":" + entry_.name; }
+  std::uint64_t size() const override { return entry_.size; }
+  std::size_t read(std::span<std::byte> out) override;
+
+  brokkr::core::Status status() const noexcept override { return st_; }
+
+  std::uint64_t position() const noexcept { return pos_; }
+
+  // True when the next n bytes hold no stored data.
+  bool hole_ahead(std::uint64_t n) const noexcept;
+  void skip(std::uint64_t n) noexcept;
+
+ private:
+  SparseTarEntrySource(std::filesystem::path tar, TarEntry e);
+
+  std::uint64_t extent_end_(std::size_t i) const noexcept { return entry_.sparse[i].offset + entry_.sparse[i].size; }
+
+ private:
+  std::filesystem::path tar_path_;
+  TarEntry entry_;
+  std::ifstream in_;
+
+  std::vector<std::uint64_t> stored_at_;
+  std::size_t ext_ = 0;
+  std::uint64_t pos_ = 0;
+  std::uint64_t file_pos_ = 0;
+
+  brokkr::core::Status st_{};
+};
+
 brokkr::core::Result<std::unique_ptr<ByteSource>> open_raw_file(const std::filesystem::path& path) noexcept;
 brokkr::core::Result<std::unique_ptr<ByteSource>> open_tar_entry(const std::filesystem::path& tar_path,
                                                                  const TarEntry& entry) noexcept;
@@ -17,6 +17,9 @@
 
 #include "io/tar.hpp"
 
+#include "core/trace.hpp"
+#include "io/zstd_seekable.hpp"
+
 #include <algorithm>
 #include <array>
 #include <charconv>
@@ -24,6 +27,7 @@
 #include <filesystem>
 #include <fstream>
 #include <limits>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
@@ -34,6 +38,7 @@ namespace brokkr::io {
 namespace {
 
 constexpr std::size_t kBlock = 512;
+constexpr std::size_t kIndexCacheMaxEntries = 16;
 
 inline std::uint64_t round_up_512(std::uint64_t n) noexcept {
   return (n + (kBlock - 1)) & ~(static_cast<std::uint64_t>(kBlock - 1));
@@ -59,26 +64,190 @@ static brokkr::core::Result<std::uint64_t> parse_u64_dec(std::string_view s) noe
   return v;
 }
 
+// GNU.sparse.map (PAX 0.1): "offset,size,offset,size,..."
+static brokkr::core::Result<std::vector<SparseExtent>> parse_sparse_map_csv(std::string_view s) noexcept {
+  std::vector<SparseExtent> out;
+  std::vector<std::uint64_t> nums;
+  while (!s.empty()) {
+    const auto comma = s.find(',');
+    BRK_TRYV(v, parse_u64_dec(s.substr(0, comma)));
+    nums.push_back(v);
+    if (comma == std::string_view::npos) break;
+    s.remove_prefix(comma + 1);
+  }
+  if (nums.size() % 2) return brokkr::core::fail("PAX: odd number of values in GNU.sparse.map");
+  for (std::size_t i = 0; i < nums.size(); i += 2) out.push_back(SparseExtent{nums[i], nums[i + 1]});
+  return out;
+}
+
+static brokkr::core::Status validate_sparse_map(const std::vector<SparseExtent>& map, std::uint64_t real_size,
+                                                std::uint64_t stored_size) noexcept {
+  std::uint64_t end = 0;
+  std::uint64_t stored = 0;
+  for (const auto& x : map) {
+    if (x.offset < end) return brokkr::core::fail("Tar: sparse map is unordered or overlapping");
+    if (x.size > real_size || x.offset > real_size - x.size) return brokkr::core::fail("Tar: sparse extent past end");
+    end = x.offset + x.size;
+    stored += x.size;
+  }
+  if (stored != stored_size) return brokkr::core::fail("Tar: sparse map does not match stored data size");
+  return {};
+}
+
+class FileTarStream final : public TarStream {
+ public:
+  explicit FileTarStream(const std::string& path) : path_(path), in_(path, std::ios::binary) {}
+
+  bool is_open() const noexcept { return in_.is_open(); }
+
+  brokkr::core::Result<std::size_t> read(std::span<std::byte> dst) noexcept override {
+    in_.read(reinterpret_cast<char*>(dst.data()), static_cast<std::streamsize>(dst.size()));
+    return static_cast<std::size_t>(in_.gcount());
+  }
+
+  brokkr::core::Status skip(std::uint64_t n) noexcept override {
+    if (n > static_cast<std::uint64_t>(std::numeric_limits<std::streamoff>::max()))
+      return brokkr::core::fail("TarArchive: entry too large for seekg");
+    in_.seekg(static_cast<std::streamoff>(n), std::ios::cur);
+    if (!in_.good()) return brokkr::core::failf("TarArchive: seek failed: {}", path_);
+    return {};
+  }
+
+ private:
+  std::string path_;
+  std::ifstream in_;
+};
+
+// Tar inside a seekable .tar.zst: skipping a payload jumps straight to the frame holding the next header.
+class ZstdTarStream final : public TarStream {
+ public:
+  explicit ZstdTarStream(ZstdSeekableReader& z) : z_(z) {}
+
+  brokkr::core::Result<std::size_t> read(std::span<std::byte> dst) noexcept override { return z_.read(dst); }
+
+  // Like seekg, skipping past the end only shows up as a short read afterwards.
+  brokkr::core::Status skip(std::uint64_t n) noexcept override {
+    return z_.seek(z_.position() + std::min(n, z_.size() - z_.position()));
+  }
+
+ private:
+  ZstdSeekableReader& z_;
+};
+
+struct FileIdentity {
+  std::uint64_t size = 0;
+  std::int64_t write_time = 0;
+
+  bool operator==(const FileIdentity&) const noexcept = default;
+};
+
+std::optional<FileIdentity> file_identity(const std::string& path) noexcept {
+  std::error_code ec;
+  const auto size = std::filesystem::file_size(path, ec);
+  if (ec) return std::nullopt;
+  const auto t = std::filesystem::last_write_time(path, ec);
+  if (ec) return std::nullopt;
+  return FileIdentity{size, static_cast<std::int64_t>(t.time_since_epoch().count())};
+}
+
+struct CachedIndex {
+  FileIdentity id;
+  TarArchive tar;
+};
+
+std::mutex& index_cache_mutex() {
+  static std::mutex mtx;
+  return mtx;
+}
+
+// Most recently remembered last.
+std::vector<CachedIndex>& index_cache() {
+  static std::vector<CachedIndex> cache;
+  return cache;
+}
+
+std::optional<TarArchive> cached_index(const std::string& path) {
+  std::lock_guard lk(index_cache_mutex());
+  auto& cache = index_cache();
+  const auto it = std::find_if(cache.begin(), cache.end(), [&](const CachedIndex& c) { return c.tar.path() == path; });
+  if (it == cache.end()) return std::nullopt;
+
+  const auto id = file_identity(path);
+  if (!id || *id != it->id) {
+    cache.erase(it);
+    return std::nullopt;
+  }
+  return it->tar;
+}
+
 } // namespace
 
 brokkr::core::Result<TarArchive> TarArchive::open(std::string path, bool validate_header_checksums) noexcept {
+  BRK_TRACE(tar_open, path.c_str());
+  if (auto cached = cached_index(path)) {
+    spdlog::debug("TarArchive: reusing ingested index of {}", path);
+    return std::move(*cached);
+  }
+
+  if (is_seekable_zstd(path)) {
+    // Only the frame holding each header is needed, so one lane avoids decoding payload ahead.
+    BRK_TRYV(z, ZstdSeekableReader::open(path, 1));
+    ZstdTarStream in(*z);
+    return scan(std::move(path), in, validate_header_checksums);
+  }
+
+  FileTarStream in(path);
+  if (!in.is_open()) return brokkr::core::failf("TarArchive: cannot open: {}", path);
+  return scan(std::move(path), in, validate_header_checksums);
+}
+
+brokkr::core::Result<TarArchive> TarArchive::scan(std::string path, TarStream& in,
+                                                  bool validate_header_checksums) noexcept {
   TarArchive t;
   t.path_ = std::move(path);
   t.validate_ = validate_header_checksums;
 
-  auto st = t.scan_();
+  auto st = t.scan_(in);
   if (!st) return brokkr::core::fail(std::move(st.error()));
+  BRK_TRACE(tar_indexed, t.path_.c_str(), t.entries_.size());
 
   return t;
 }
 
+void TarArchive::remember(const TarArchive& t, std::uint64_t file_size, std::int64_t write_time) noexcept {
+  std::lock_guard lk(index_cache_mutex());
+  auto& cache = index_cache();
+  std::erase_if(cache, [&](const CachedIndex& c) { return c.tar.path() == t.path(); });
+  if (cache.size() >= kIndexCacheMaxEntries) cache.erase(cache.begin());
+  cache.push_back(CachedIndex{FileIdentity{file_size, write_time}, t});
+}
+
+std::span<const std::byte> TarArchive::head(const TarEntry& e) const noexcept {
+  const auto it = heads_.find(e.data_offset);
+  if (it == heads_.end()) return {};
+  return it->second;
+}
+
+void TarArchive::set_head(std::uint64_t data_offset, std::vector<std::byte> bytes) {
+  heads_.insert_or_assign(data_offset, std::move(bytes));
+}
+
 bool TarArchive::is_tar_file(const std::string& path) noexcept {
-  std::ifstream in(path, std::ios::binary);
-  if (!in.is_open()) return false;
+  if (cached_index(path)) return true;
 
   std::array<std::byte, 512> header{};
-  in.read(reinterpret_cast<char*>(header.data()), header.size());
-  if (!in.good()) return false;
+  if (is_seekable_zstd(path)) {
+    auto z = ZstdSeekableReader::open(path, 1);
+    if (!z) return false;
+    auto got = (*z)->read(header);
+    if (!got || *got != header.size()) return false;
+  } else {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    in.read(reinterpret_cast<char*>(header.data()), header.size());
+    if (!in.good()) return false;
+  }
 
   if (header_all_zero(std::span<const std::byte, 512>(header))) return false;
   return validate_header_checksum(std::span<const std::byte, 512>(header));
@@ -208,16 +377,37 @@ brokkr::core::Result<TarArchive::PaxKV> TarArchive::parse_pax_payload(std::strin
       auto sz = parse_u64_dec(val);
       if (!sz) return brokkr::core::fail(std::move(sz.error()));
       kv.size = *sz;
+    } else if (key.starts_with("GNU.sparse.")) {
+      const auto k = key.substr(11);
+      if (k == "name") {
+        kv.sparse_name = std::string(val);
+      } else if (k == "size" || k == "realsize") {
+        BRK_TRYV(v, parse_u64_dec(val));
+        kv.sparse_realsize = v;
+      } else if (k == "major") {
+        BRK_TRYV(v, parse_u64_dec(val));
+        kv.sparse_major = v;
+      } else if (k == "map") {
+        BRK_TRYV(m, parse_sparse_map_csv(val));
+        kv.sparse_map = std::move(m);
+      } else if (k == "offset") {
+        // PAX 0.0 repeats offset/numbytes pairs in order.
+        BRK_TRYV(v, parse_u64_dec(val));
+        if (!kv.sparse_map) kv.sparse_map.emplace();
+        kv.sparse_map->push_back(SparseExtent{v, 0});
+      } else if (k == "numbytes") {
+        BRK_TRYV(v, parse_u64_dec(val));
+        if (!kv.sparse_map || kv.sparse_map->empty())
+          return brokkr::core::fail("PAX: GNU.sparse.numbytes without offset");
+        kv.sparse_map->back().size = v;
+      }
     }
   }
 
   return kv;
 }
 
-brokkr::core::Status TarArchive::scan_() noexcept {
-  std::ifstream in(path_, std::ios::binary);
-  if (!in.is_open()) return brokkr::core::failf("TarArchive: cannot open: {}", path_);
-
+brokkr::core::Status TarArchive::scan_(TarStream& in) noexcept {
   entries_.clear();
   payload_size_bytes_.reset();
 
@@ -239,52 +429,105 @@ brokkr::core::Status TarArchive::scan_() noexcept {
   std::vector<PendingHardlink> pending_hardlinks;
 
   auto read_exact = [&](std::byte* dst, std::size_t n) -> brokkr::core::Status {
-    in.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(n));
-    if (!in.good()) return brokkr::core::failf("TarArchive: short read: {}", path_);
+    BRK_TRYV(got, in.read(std::span<std::byte>(dst, n)));
+    if (got != n) return brokkr::core::failf("TarArchive: short read: {}", path_);
     pos += n;
     return {};
   };
 
   auto skip_exact = [&](std::uint64_t n) -> brokkr::core::Status {
     if (n == 0) return {};
-    if (n > static_cast<std::uint64_t>(std::numeric_limits<std::streamoff>::max()))
-      return brokkr::core::fail("TarArchive: entry too large for seekg");
-    in.seekg(static_cast<std::streamoff>(n), std::ios::cur);
-    if (!in.good()) return brokkr::core::failf("TarArchive: seek failed: {}", path_);
+    BRK_TRY(in.skip(n));
     pos += n;
     return {};
   };
 
-  auto apply_name_overrides = [&](std::string full_name, std::uint64_t& size) -> std::string {
+  auto apply_name_overrides = [&](std::string full_name, std::uint64_t& size, PaxKV& eff) -> std::string {
     if (have_gnu_longname_next) {
       full_name = std::move(gnu_longname_next);
       gnu_longname_next.clear();
       have_gnu_longname_next = false;
     }
 
-    PaxKV eff = pax_global;
+    eff = pax_global;
     eff.merge_from(pax_next);
     pax_next.clear();
 
     if (eff.path) full_name = *eff.path;
     if (eff.size) size = *eff.size;
+    if (eff.sparse_name) full_name = *eff.sparse_name;
 
     return full_name;
   };
 
+  // Old GNU 'S': four map slots in the header, then 512-byte extension headers of 21 slots each.
+  auto read_old_gnu_sparse = [&](const char* h, std::vector<SparseExtent>& map) -> brokkr::core::Status {
+    auto take_slots = [&](const char* p, std::size_t slots) -> brokkr::core::Result<bool> {
+      for (std::size_t i = 0; i < slots; ++i, p += 24) {
+        if (p[0] == '\0') return false;
+        BRK_TRYV(off, parse_tar_number(p, 12));
+        BRK_TRYV(len, parse_tar_number(p + 12, 12));
+        map.push_back(SparseExtent{off, len});
+      }
+      return true;
+    };
+
+    BRK_TRYV(more, take_slots(h + 386, 4));
+    bool extended = more && h[482] != '\0';
+
+    std::array<std::byte, 512> ext{};
+    while (extended) {
+      BRK_TRY(read_exact(ext.data(), ext.size()));
+      const char* e = reinterpret_cast<const char*>(ext.data());
+      BRK_TRYV(more2, take_slots(e, 21));
+      extended = more2 && e[504] != '\0';
+    }
+    return {};
+  };
+
+  // PAX 1.0: a decimal map ("count\n" then "offset\nsize\n" pairs) padded to 512 bytes precedes the data.
+  auto read_pax_sparse_1_0 = [&](std::vector<SparseExtent>& map, std::uint64_t& consumed) -> brokkr::core::Status {
+    std::string text;
+    std::array<std::byte, 512> blk{};
+    std::size_t at = 0;
+
+    auto next_number = [&]() -> brokkr::core::Result<std::uint64_t> {
+      for (;;) {
+        const auto nl = text.find('\n', at);
+        if (nl != std::string::npos) {
+          BRK_TRYV(v, parse_u64_dec(std::string_view(text).substr(at, nl - at)));
+          at = nl + 1;
+          return v;
+        }
+        if (text.size() > 1024ull * 1024ull) return brokkr::core::fail("Tar: PAX 1.0 sparse map too large");
+        BRK_TRY(read_exact(blk.data(), blk.size()));
+        consumed += blk.size();
+        text.append(reinterpret_cast<const char*>(blk.data()), blk.size());
+      }
+    };
+
+    BRK_TRYV(count, next_number());
+    if (count > (1u << 20)) return brokkr::core::fail("Tar: PAX 1.0 sparse map too large");
+    for (std::uint64_t i = 0; i < count; ++i) {
+      BRK_TRYV(off, next_number());
+      BRK_TRYV(len, next_number());
+      map.push_back(SparseExtent{off, len});
+    }
+    return {};
+  };
+
   for (;;) {
     BRK_TRY(read_exact(header.data(), header.size()));
 
     if (header_all_zero(std::span<const std::byte, 512>(header))) {
       std::array<std::byte, 512> hdr2{};
-      in.read(reinterpret_cast<char*>(hdr2.data()), static_cast<std::streamsize>(hdr2.size()));
-      const auto got2 = in.gcount();
+      BRK_TRYV(got2, in.read(hdr2));
 
-      if (got2 == static_cast<std::streamsize>(hdr2.size()) && header_all_zero(std::span<const std::byte, 512>(hdr2))) {
+      if (got2 == hdr2.size() && header_all_zero(std::span<const std::byte, 512>(hdr2))) {
         pos += hdr2.size();
         payload_size_bytes_ = pos;
       } else {
-        if (got2 > 0) pos += static_cast<std::uint64_t>(got2);
+        pos += got2;
       }
       break;
     }
@@ -337,29 +580,58 @@ brokkr::core::Status TarArchive::scan_() noexcept {
       continue;
     }
 
+    PaxKV eff;
     std::string full_name = join_ustar_name(prefix, name);
-    full_name = apply_name_overrides(std::move(full_name), size);
+    full_name = apply_name_overrides(std::move(full_name), size, eff);
+
+    const bool is_payload = (typeflag == '0' || typeflag == '\0' || typeflag == '7' || typeflag == 'S');
+
+    std::vector<SparseExtent> sparse;
+    std::uint64_t real_size = size;
+    std::uint64_t consumed = 0;
+
+    if (typeflag == 'S') {
+      BRK_TRY(read_old_gnu_sparse(h, sparse));
+      BRK_TRYV(rs, parse_tar_number(h + 483, 12));
+      real_size = rs;
+    } else if (is_payload && eff.sparse_realsize) {
+      if (eff.sparse_major.value_or(0) == 1)
+        BRK_TRY(read_pax_sparse_1_0(sparse, consumed));
+      else if (eff.sparse_map)
+        sparse = std::move(*eff.sparse_map);
+      real_size = *eff.sparse_realsize;
+    }
 
     const std::uint64_t data_offset = pos;
-
-    const bool is_payload = (typeflag == '0' || typeflag == '\0' || typeflag == '7');
+    const bool sparse_member = typeflag == 'S' || (is_payload && eff.sparse_realsize);
+
+    if (sparse_member) {
+      if (consumed > size) return brokkr::core::failf("TarArchive: sparse map overruns member: {}", full_name);
+      BRK_TRY(validate_sparse_map(sparse, real_size, size - consumed));
+      // Keep an explicit terminator so an all-hole member still reads as sparse.
+      if (sparse.empty() || sparse.back().offset + sparse.back().size != real_size)
+        sparse.push_back(SparseExtent{real_size, 0});
+    }
 
     if (is_payload && !full_name.empty()) {
-      TarEntry e{full_name, size, data_offset};
-      entries_.push_back(e);
+      TarEntry e{full_name, real_size, data_offset, std::move(sparse)};
+      in.on_member(e);
       payload_by_name.emplace(e.name, e);
+      entries_.push_back(std::move(e));
     } else if (typeflag == '1') {
       std::string target = trim_cstr_field(h + 157, 100);
       if (!full_name.empty() && !target.empty()) pending_hardlinks.push_back(PendingHardlink{full_name, target});
     }
 
-    BRK_TRY(skip_exact(round_up_512(size)));
+    BRK_TRY(skip_exact(round_up_512(size) - consumed));
   }
 
   for (const auto& hl : pending_hardlinks) {
     auto it = payload_by_name.find(hl.target);
     if (it == payload_by_name.end()) continue;
-    entries_.push_back(TarEntry{hl.name, it->second.size, it->second.data_offset});
+    TarEntry e = it->second;
+    e.name = hl.name;
+    entries_.push_back(std::move(e));
   }
 
   spdlog::debug("TarArchive: scanned {} entries in {}", entries_.size(), path_);
@@ -25,19 +25,53 @@
 #include <span>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace brokkr::io {
 
+struct SparseExtent {
+  std::uint64_t offset = 0;
+  std::uint64_t size = 0;
+};
+
 struct TarEntry {
   std::string name;
   std::uint64_t size = 0;
   std::uint64_t data_offset = 0;
+
+  // GNU/PAX sparse members: data extents stored back to back from data_offset, in logical order.
+  // Everything outside them reads as zero. Empty for regular members.
+  std::vector<SparseExtent> sparse;
+
+  bool is_sparse() const noexcept { return !sparse.empty(); }
+};
+
+// Forward-only input for TarArchive::scan(). open() reads the file through one; package ingest feeds
+// the blocks it is already hashing.
+class TarStream {
+ public:
+  virtual ~TarStream() = default;
+
+  // Fills up to dst.size() bytes; fewer only at the end of the input.
+  virtual brokkr::core::Result<std::size_t> read(std::span<std::byte> dst) noexcept = 0;
+  virtual brokkr::core::Status skip(std::uint64_t n) noexcept = 0;
+
+  // The payload of `e` comes next.
+  virtual void on_member(const TarEntry& e) noexcept { (void)e; }
 };
 
 class TarArchive {
  public:
+  // Returns the remembered index instead when the file's size and mtime still match.
   static brokkr::core::Result<TarArchive> open(std::string path, bool validate_header_checksums = true) noexcept;
+  // Indexes `in`, which yields the bytes of `path` from offset 0; the file itself is not touched.
+  static brokkr::core::Result<TarArchive> scan(std::string path, TarStream& in,
+                                               bool validate_header_checksums = true) noexcept;
+
+  // Keeps the index (and its heads) for open() and is_tar_file() of the same path. The identity is the
+  // size and mtime the caller saw before reading, so a file replaced since then is scanned again.
+  static void remember(const TarArchive& t, std::uint64_t file_size, std::int64_t write_time) noexcept;
 
   const std::string& path() const noexcept { return path_; }
   const std::vector<TarEntry>& entries() const noexcept { return entries_; }
@@ -48,6 +82,10 @@ class TarArchive {
 
   std::optional<std::uint64_t> payload_size_bytes() const noexcept { return payload_size_bytes_; }
 
+  // Leading payload bytes of `e` captured during a scan (LZ4 frame header, download-list.txt); empty if none.
+  std::span<const std::byte> head(const TarEntry& e) const noexcept;
+  void set_head(std::uint64_t data_offset, std::vector<std::byte> bytes);
+
  private:
   TarArchive() = default;
 
@@ -63,25 +101,33 @@ class TarArchive {
   struct PaxKV {
     std::optional<std::string> path;
     std::optional<std::uint64_t> size;
-    void clear() {
-      path.reset();
-      size.reset();
-    }
+
+    std::optional<std::string> sparse_name;
+    std::optional<std::uint64_t> sparse_realsize;
+    std::optional<std::uint64_t> sparse_major;
+    std::optional<std::vector<SparseExtent>> sparse_map;
+
+    void clear() { *this = PaxKV{}; }
     void merge_from(const PaxKV& o) {
       if (o.path) path = *o.path;
       if (o.size) size = *o.size;
+      if (o.sparse_name) sparse_name = *o.sparse_name;
+      if (o.sparse_realsize) sparse_realsize = *o.sparse_realsize;
+      if (o.sparse_major) sparse_major = *o.sparse_major;
+      if (o.sparse_map) sparse_map = *o.sparse_map;
     }
   };
 
   static brokkr::core::Result<PaxKV> parse_pax_payload(std::string_view payload) noexcept;
 
-  brokkr::core::Status scan_() noexcept;
+  brokkr::core::Status scan_(TarStream& in) noexcept;
 
  private:
   std::string path_;
   bool validate_ = true;
   std::vector<TarEntry> entries_;
   std::optional<std::uint64_t> payload_size_bytes_;
+  std::unordered_map<std::uint64_t, std::vector<std::byte>> heads_; // by data_offset
 };
 
 } // namespace brokkr::io
@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "io/zstd_seekable.hpp"
+
+#include "core/endian.hpp"
+#include "third_party/xxhash/xxhash_vendor.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <utility>
+
+#if defined(BROKKR_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+#include <spdlog/spdlog.h>
+
+namespace brokkr::io {
+
+namespace {
+
+constexpr std::uint32_t kZstdFrameMagic = 0xFD2FB528u;
+constexpr std::uint32_t kSkippableMagic = 0x184D2A5Eu;
+constexpr std::uint32_t kSeekableMagic = 0x8F92EAB1u;
+
+constexpr std::size_t kFooterBytes = 4 + 1 + 4;
+constexpr std::size_t kSkippableHeaderBytes = 4 + 4;
+constexpr std::uint8_t kDescChecksumFlag = 0x80;
+constexpr std::uint8_t kDescReservedMask = 0x7C;
+
+// Decoded frames are held whole, so a table with larger frames is rejected rather than buffered.
+constexpr std::uint32_t kMaxFrameBytes = 256u * 1024u * 1024u;
+constexpr std::size_t kMaxLanes = 8;
+constexpr std::uint64_t kWindowBudgetBytes = 64ull * 1024ull * 1024ull;
+
+inline std::uint32_t load_le32(const std::byte* p) noexcept {
+  std::uint32_t v = 0;
+  std::memcpy(&v, p, sizeof(v));
+  return brokkr::core::le_to_host(v);
+}
+
+bool read_at(std::ifstream& in, std::uint64_t off, std::span<std::byte> dst) noexcept {
+  if (off > static_cast<std::uint64_t>(std::numeric_limits<std::streamoff>::max())) return false;
+  in.clear();
+  in.seekg(static_cast<std::streamoff>(off), std::ios::beg);
+  in.read(reinterpret_cast<char*>(dst.data()), static_cast<std::streamsize>(dst.size()));
+  return in.gcount() == static_cast<std::streamsize>(dst.size());
+}
+
+brokkr::core::Status decode_frame(const std::filesystem::path& path, const ZstdSeekFrame& f,
+                                  std::span<const std::byte> src, std::span<std::byte> dst) noexcept {
+#if defined(BROKKR_HAVE_ZSTD)
+  const std::size_t n = ZSTD_decompress(dst.data(), dst.size(), src.data(), src.size());
+  if (ZSTD_isError(n))
+    return brokkr::core::failf("zstd: frame at {} of {}: {}", f.c_offset, path.string(), ZSTD_getErrorName(n));
+  if (n != f.d_size)
+    return brokkr::core::failf("zstd: frame at {} of {} decoded to {} bytes, seek table says {}", f.c_offset,
+                               path.string(), n, f.d_size);
+  if (f.checksum && static_cast<std::uint32_t>(XXH64(dst.data(), n, 0)) != *f.checksum)
+    return brokkr::core::failf("zstd: checksum mismatch in frame at {} of {}", f.c_offset, path.string());
+  return {};
+#else
+  (void)f;
+  (void)src;
+  (void)dst;
+  return brokkr::core::failf("zstd: cannot decode {}: built without zstd support", path.string());
+#endif
+}
+
+} // namespace
+
+brokkr::core::Result<ZstdSeekTable> ZstdSeekTable::read(const std::filesystem::path& path) noexcept {
+  std::error_code ec;
+  const auto file_size = static_cast<std::uint64_t>(std::filesystem::file_size(path, ec));
+  if (ec) return brokkr::core::failf("zstd: stat failed: {}", path.string());
+  if (file_size < kSkippableHeaderBytes + kFooterBytes)
+    return brokkr::core::failf("zstd: no seek table in {}", path.string());
+
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open()) return brokkr::core::failf("zstd: cannot open: {}", path.string());
+
+  std::array<std::byte, kFooterBytes> footer{};
+  if (!read_at(in, file_size - kFooterBytes, footer)) return brokkr::core::failf("zstd: read failed: {}", path.string());
+  if (load_le32(footer.data() + 5) != kSeekableMagic)
+    return brokkr::core::failf("zstd: no seek table in {}", path.string());
+
+  const std::uint64_t count = load_le32(footer.data());
+  const auto desc = static_cast<std::uint8_t>(footer[4]);
+  if (desc & kDescReservedMask) return brokkr::core::failf("zstd: reserved seek table bits set in {}", path.string());
+
+  const bool checksums = (desc & kDescChecksumFlag) != 0;
+  const std::uint64_t entry_bytes = checksums ? 12 : 8;
+  const std::uint64_t table_bytes = count * entry_bytes + kFooterBytes;
+  if (table_bytes + kSkippableHeaderBytes > file_size)
+    return brokkr::core::failf("zstd: seek table larger than {}", path.string());
+
+  const std::uint64_t table_at = file_size - table_bytes - kSkippableHeaderBytes;
+  std::vector<std::byte> raw(static_cast<std::size_t>(table_bytes - kFooterBytes + kSkippableHeaderBytes));
+  if (!read_at(in, table_at, raw)) return brokkr::core::failf("zstd: read failed: {}", path.string());
+  if (load_le32(raw.data()) != kSkippableMagic || load_le32(raw.data() + 4) != table_bytes)
+    return brokkr::core::failf("zstd: malformed seek table frame in {}", path.string());
+
+  ZstdSeekTable t;
+  t.frames_.reserve(static_cast<std::size_t>(count));
+
+  std::uint64_t c_off = 0;
+  std::uint64_t d_off = 0;
+  const std::byte* p = raw.data() + kSkippableHeaderBytes;
+  for (std::uint64_t i = 0; i < count; ++i, p += entry_bytes) {
+    ZstdSeekFrame f;
+    f.c_offset = c_off;
+    f.d_offset = d_off;
+    f.c_size = load_le32(p);
+    f.d_size = load_le32(p + 4);
+    if (checksums) f.checksum = load_le32(p + 8);
+
+    if (!f.c_size) return brokkr::core::failf("zstd: empty frame {} in seek table of {}", i, path.string());
+    if (f.d_size > kMaxFrameBytes)
+      return brokkr::core::failf("zstd: frame {} of {} is {} bytes; at most {} supported", i, path.string(), f.d_size,
+                                 kMaxFrameBytes);
+
+    c_off += f.c_size;
+    d_off += f.d_size;
+    t.max_d_ = std::max(t.max_d_, f.d_size);
+    t.frames_.push_back(f);
+  }
+
+  if (c_off != table_at)
+    return brokkr::core::failf("zstd: seek table does not match the frames of {}", path.string());
+
+  t.d_size_ = d_off;
+  return t;
+}
+
+std::size_t ZstdSeekTable::frame_at(std::uint64_t pos) const noexcept {
+  if (pos >= d_size_) return frames_.size();
+  const auto it = std::upper_bound(frames_.begin(), frames_.end(), pos,
+                                   [](std::uint64_t v, const ZstdSeekFrame& f) { return v < f.d_offset; });
+  return static_cast<std::size_t>(it - frames_.begin()) - 1;
+}
+
+bool is_seekable_zstd(const std::filesystem::path& path) noexcept {
+  std::error_code ec;
+  const auto file_size = static_cast<std::uint64_t>(std::filesystem::file_size(path, ec));
+  if (ec || file_size < 4 + kSkippableHeaderBytes + kFooterBytes) return false;
+
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open()) return false;
+
+  std::array<std::byte, 4> magic{};
+  std::array<std::byte, kFooterBytes> footer{};
+  if (!read_at(in, 0, magic) || !read_at(in, file_size - kFooterBytes, footer)) return false;
+  return load_le32(magic.data()) == kZstdFrameMagic && load_le32(footer.data() + 5) == kSeekableMagic;
+}
+
+bool zstd_decode_available() noexcept {
+#if defined(BROKKR_HAVE_ZSTD)
+  return true;
+#else
+  return false;
+#endif
+}
+
+ZstdSeekableReader::ZstdSeekableReader(std::filesystem::path path, ZstdSeekTable table, std::size_t lanes)
+    : path_(std::move(path)), in_(path_, std::ios::binary), table_(std::move(table)), lanes_(lanes) {
+  if (lanes_ > 1) pool_ = std::make_unique<brokkr::core::ThreadPool>(lanes_);
+  window_.resize(lanes_);
+}
+
+ZstdSeekableReader::~ZstdSeekableReader() = default;
+
+brokkr::core::Result<std::unique_ptr<ZstdSeekableReader>> ZstdSeekableReader::open(const std::filesystem::path& path,
+                                                                                   std::size_t lanes) noexcept {
+  BRK_TRYV(table, ZstdSeekTable::read(path));
+  if (!zstd_decode_available())
+    return brokkr::core::failf("zstd: {} is compressed, but this build has no zstd support", path.string());
+
+  if (!lanes) {
+    lanes = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, kMaxLanes);
+    const auto fit = kWindowBudgetBytes / std::max<std::uint64_t>(1, table.max_frame_size());
+    lanes = std::min<std::size_t>(lanes, static_cast<std::size_t>(std::max<std::uint64_t>(1, fit)));
+  }
+  lanes = std::max<std::size_t>(1, std::min(lanes, table.frames().size()));
+
+  auto r = std::unique_ptr<ZstdSeekableReader>(new ZstdSeekableReader(path, std::move(table), lanes));
+  if (!r->in_.is_open()) return brokkr::core::failf("zstd: cannot open: {}", path.string());
+
+  spdlog::debug("zstd: {}: {} frames, {} bytes, {} decode lanes", path.string(), r->table_.frames().size(), r->size(),
+                r->lanes_);
+  return r;
+}
+
+brokkr::core::Status ZstdSeekableReader::seek(std::uint64_t pos) noexcept {
+  if (pos > size()) return brokkr::core::failf("zstd: seek past end of {}", path_.string());
+  pos_ = pos;
+  return {};
+}
+
+// Reads the compressed bytes of the next frames in one go (they are contiguous) and decodes them side by side.
+brokkr::core::Status ZstdSeekableReader::fill_(std::size_t first) noexcept {
+  const auto& frames = table_.frames();
+  std::size_t end = frames.size();
+  if (limit_ > table_.frames()[first].d_offset && limit_ < size()) end = table_.frame_at(limit_ - 1) + 1;
+  const std::size_t count = std::min(lanes_, end - first);
+  window_count_ = 0;
+
+  const std::uint64_t c_begin = frames[first].c_offset;
+  const std::uint64_t c_end = frames[first + count - 1].c_offset + frames[first + count - 1].c_size;
+  compressed_.resize(static_cast<std::size_t>(c_end - c_begin));
+  if (!read_at(in_, c_begin, compressed_)) return brokkr::core::failf("zstd: read failed: {}", path_.string());
+
+  for (std::size_t k = 0; k < count; ++k) {
+    const auto& f = frames[first + k];
+    auto& slot = window_[k];
+    slot.frame = first + k;
+    slot.data.resize(f.d_size);
+
+    const std::span<const std::byte> src(compressed_.data() + (f.c_offset - c_begin), f.c_size);
+    if (!pool_) {
+      BRK_TRY(decode_frame(path_, f, src, slot.data));
+      continue;
+    }
+    BRK_TRY(pool_->submit([this, &f, src, &slot]() { return decode_frame(path_, f, src, slot.data); }));
+  }
+  if (pool_) BRK_TRY(pool_->wait());
+
+  window_first_ = first;
+  window_count_ = count;
+  return {};
+}
+
+brokkr::core::Result<std::size_t> ZstdSeekableReader::read(std::span<std::byte> dst) noexcept {
+  const auto& frames = table_.frames();
+  std::size_t done = 0;
+
+  while (done < dst.size() && pos_ < size()) {
+    const std::size_t i = table_.frame_at(pos_);
+    if (!window_count_ || i < window_first_ || i >= window_first_ + window_count_) BRK_TRY(fill_(i));
+
+    const auto& data = window_[i - window_first_].data;
+    const auto off = static_cast<std::size_t>(pos_ - frames[i].d_offset);
+    const std::size_t n = std::min(data.size() - off, dst.size() - done);
+    std::memcpy(dst.data() + done, data.data() + off, n);
+    done += n;
+    pos_ += n;
+  }
+  return done;
+}
+
+} // namespace brokkr::io
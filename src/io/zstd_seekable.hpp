@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "core/status.hpp"
+#include "core/thread_pool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace brokkr::io {
+
+// Zstandard seekable format: independently compressed frames followed by a seek table in a skippable
+// frame, so any offset of the decompressed stream is reached by decoding only the frames covering it.
+struct ZstdSeekFrame {
+  std::uint64_t c_offset = 0;
+  std::uint64_t d_offset = 0;
+  std::uint32_t c_size = 0;
+  std::uint32_t d_size = 0;
+  std::optional<std::uint32_t> checksum; // low 32 bits of XXH64 over the decompressed frame
+};
+
+class ZstdSeekTable {
+ public:
+  // Parses the trailing seek table only; does not need libzstd.
+  static brokkr::core::Result<ZstdSeekTable> read(const std::filesystem::path& path) noexcept;
+
+  const std::vector<ZstdSeekFrame>& frames() const noexcept { return frames_; }
+  std::uint64_t decompressed_size() const noexcept { return d_size_; }
+  std::uint32_t max_frame_size() const noexcept { return max_d_; }
+
+  // Index of the frame holding decompressed offset `pos`; frames().size() at or past the end.
+  std::size_t frame_at(std::uint64_t pos) const noexcept;
+
+ private:
+  std::vector<ZstdSeekFrame> frames_;
+  std::uint64_t d_size_ = 0;
+  std::uint32_t max_d_ = 0;
+};
+
+// Zstd frame magic at offset 0 and the seekable footer at the end.
+bool is_seekable_zstd(const std::filesystem::path& path) noexcept;
+
+// False when built without libzstd: seek tables still parse, but nothing can be decoded.
+bool zstd_decode_available() noexcept;
+
+// Random-access reader over the decompressed stream. Frames are decoded `lanes` at a time on a thread pool
+// and served from that window, so sequential reads keep every lane busy and a seek costs at most one window.
+class ZstdSeekableReader {
+ public:
+  // lanes == 0 picks one per core, bounded so the window stays within a fixed memory budget.
+  static brokkr::core::Result<std::unique_ptr<ZstdSeekableReader>> open(const std::filesystem::path& path,
+                                                                        std::size_t lanes = 0) noexcept;
+  ~ZstdSeekableReader();
+
+  ZstdSeekableReader(const ZstdSeekableReader&) = delete;
+  ZstdSeekableReader& operator=(const ZstdSeekableReader&) = delete;
+
+  const ZstdSeekTable& table() const noexcept { return table_; }
+  std::uint64_t size() const noexcept { return table_.decompressed_size(); }
+  std::uint64_t position() const noexcept { return pos_; }
+  std::size_t lanes() const noexcept { return lanes_; }
+
+  // Decoding ahead stops at the frame holding `end` - 1, e.g. the last byte of one tar member.
+  void set_read_ahead_limit(std::uint64_t end) noexcept { limit_ = end; }
+
+  brokkr::core::Status seek(std::uint64_t pos) noexcept;
+  // Fills up to dst.size() bytes; fewer only at the end of the stream.
+  brokkr::core::Result<std::size_t> read(std::span<std::byte> dst) noexcept;
+
+ private:
+  ZstdSeekableReader(std::filesystem::path path, ZstdSeekTable table, std::size_t lanes);
+
+  brokkr::core::Status fill_(std::size_t first) noexcept;
+
+ private:
+  struct Decoded {
+    std::size_t frame = 0;
+    std::vector<std::byte> data;
+  };
+
+  std::filesystem::path path_;
+  std::ifstream in_;
+  ZstdSeekTable table_;
+  std::size_t lanes_ = 1;
+  std::unique_ptr<brokkr::core::ThreadPool> pool_;
+
+  std::vector<std::byte> compressed_;
+  std::vector<Decoded> window_;
+  std::size_t window_first_ = 0;
+  std::size_t window_count_ = 0;
+
+  std::uint64_t pos_ = 0;
+  std::uint64_t limit_ = 0;
+};
+
+} // namespace brokkr::io
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "platform/linux/block_storage.hpp"
+
+#include <charconv>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+
+#include <fmt/format.h>
+
+namespace brokkr::linux {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::optional<unsigned> read_uint(const fs::path& p) {
+  std::ifstream in(p);
+  if (!in.is_open()) return std::nullopt;
+  std::string s;
+  std::getline(in, s);
+  while (!s.empty() && (s.back() == '\n' || s.back() == ' ')) s.pop_back();
+
+  unsigned v = 0;
+  auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), v, 10);
+  if (ec != std::errc{} || ptr != s.data() + s.size()) return std::nullopt;
+  return v;
+}
+
+} // namespace
+
+StorageInfo storage_info(const fs::path& file, const fs::path& sys_root) noexcept {
+  StorageInfo out;
+
+  struct stat st {};
+  if (::stat(file.c_str(), &st) != 0) return out;
+  out.device = static_cast<std::uint64_t>(st.st_dev);
+
+  std::error_code ec;
+  auto dir = fs::canonical(sys_root / "dev" / "block" / fmt::format("{}:{}", major(st.st_dev), minor(st.st_dev)), ec);
+  if (ec) return out;
+  if (fs::exists(dir / "partition", ec)) dir = dir.parent_path();
+
+  const auto rotational = read_uint(dir / "queue" / "rotational");
+  if (!rotational) return out;
+
+  out.kind = *rotational ? StorageKind::Rotational : StorageKind::Solid;
+  out.name = dir.filename().string();
+  out.usb = dir.generic_string().find("/usb") != std::string::npos;
+  out.queue_depth = read_uint(dir / "queue" / "nr_requests").value_or(0);
+  return out;
+}
+
+} // namespace brokkr::linux
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace brokkr::linux {
+
+enum class StorageKind { Unknown, Rotational, Solid };
+
+// The block device a file lives on, as far as the OS tells us.
+struct StorageInfo {
+  StorageKind kind = StorageKind::Unknown;
+  std::uint64_t device = 0; // files with the same non-zero id share a disk
+  std::string name;         // "sda", "nvme0n1"
+  bool usb = false;         // behind a USB mass-storage bridge
+  unsigned queue_depth = 0; // 0 = unknown
+};
+
+// Reads queue/rotational and queue/nr_requests of the whole disk behind `file` (partitions resolve to
+// their parent). Filesystems without a backing block device (tmpfs, NFS, btrfs subvolumes) give Unknown.
+StorageInfo storage_info(const std::filesystem::path& file, const std::filesystem::path& sys_root = "/sys") noexcept;
+
+} // namespace brokkr::linux
@@ -18,15 +18,25 @@
 #include "platform/linux/sysfs_usb.hpp"
 
 #include <algorithm>
+#include <cerrno>
 #include <charconv>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <optional>
+#include <set>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
 #include <spdlog/spdlog.h>
 
 namespace brokkr::linux {
@@ -36,6 +46,14 @@ namespace fs = std::filesystem;
 namespace {
 
 constexpr std::string_view kSysUsbDevices = "/sys/bus/usb/devices";
+constexpr std::string_view kSuddlmod = "AT+SUDDLMOD=0,0\r";
+constexpr std::uint16_t kOdinPids[] = {0x6601, 0x685D, 0x68C3};
+
+using Clock = std::chrono::steady_clock;
+
+bool is_odin_pid(std::uint16_t pid) {
+  return std::find(std::begin(kOdinPids), std::end(kOdinPids), pid) != std::end(kOdinPids);
+}
 
 std::string read_text_file(const fs::path& p) {
   std::ifstream in(p);
@@ -109,6 +127,71 @@ std::optional<UsbDeviceSysfsInfo> load_one(const fs::path& dir, std::string sysn
   return out;
 }
 
+int ms_left(Clock::time_point deadline) {
+  const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+  return left > 0 ? static_cast<int>(left) : 0;
+}
+
+std::string errno_text(const char* what) { return std::string(what) + ": " + std::strerror(errno); }
+
+// "ttyACM9" before "ttyACM10".
+bool tty_less(const SerialPortInfo& a, const SerialPortInfo& b) {
+  if (a.tty.size() != b.tty.size()) return a.tty.size() < b.tty.size();
+  return a.tty < b.tty;
+}
+
+std::optional<std::string> send_suddlmod_tty(const fs::path& node, std::chrono::milliseconds timeout) {
+  const auto deadline = Clock::now() + timeout;
+
+  // O_NONBLOCK: an ACM open otherwise waits for carrier, and writes must honour the deadline.
+  const int fd = ::open(node.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) return errno_text("open failed");
+
+  auto fail = [fd](std::string msg) -> std::optional<std::string> {
+    (void)::tcflush(fd, TCIOFLUSH);
+    ::close(fd);
+    return msg;
+  };
+
+  termios tio{};
+  if (::tcgetattr(fd, &tio) != 0) return fail(errno_text("tcgetattr failed"));
+  ::cfmakeraw(&tio);
+  ::cfsetispeed(&tio, B115200);
+  ::cfsetospeed(&tio, B115200);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cflag &= ~CRTSCTS;
+  if (::tcsetattr(fd, TCSANOW, &tio) != 0) return fail(errno_text("tcsetattr failed"));
+
+  // Modems ignore AT commands until DTR is up; ptys have no modem lines, hence no error check.
+  int dtr = TIOCM_DTR;
+  (void)::ioctl(fd, TIOCMBIS, &dtr);
+
+  std::size_t off = 0;
+  while (off < kSuddlmod.size()) {
+    const ssize_t n = ::write(fd, kSuddlmod.data() + off, kSuddlmod.size() - off);
+    if (n > 0) {
+      off += static_cast<std::size_t>(n);
+      continue;
+    }
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0 && errno != EAGAIN) return fail(errno_text("write failed"));
+
+    pollfd p{.fd = fd, .events = POLLOUT, .revents = 0};
+    const int left = ms_left(deadline);
+    if (left == 0 || ::poll(&p, 1, left) == 0) return fail("write timed out");
+  }
+
+  // Wait for the command to leave the output queue, but only until the deadline: close() on a port
+  // with pending output blocks for the driver's closing_wait (30 s by default) otherwise.
+  for (int queued = 0; ::ioctl(fd, TIOCOUTQ, &queued) == 0 && queued > 0;) {
+    if (ms_left(deadline) == 0) return fail("write did not drain before the timeout");
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+
+  ::close(fd);
+  return std::nullopt;
+}
+
 } // namespace
 
 std::string UsbDeviceSysfsInfo::devnode() const { return fmt::format("/dev/bus/usb/{:03d}/{:03d}", busnum, devnum); }
@@ -153,4 +236,72 @@ std::optional<UsbDeviceSysfsInfo> find_by_sysname(std::string_view sysname) {
   return load_one(dir, std::string(sysname));
 }
 
+std::vector<SerialPortInfo> enumerate_cdc_acm_ports(std::uint16_t vendor, const SerialScanRoots& roots) {
+  std::vector<SerialPortInfo> out;
+
+  const fs::path base = roots.sys / "class" / "tty";
+  if (!fs::exists(base) || !fs::is_directory(base)) return out;
+
+  for (const auto& entry : fs::directory_iterator(base)) {
+    const auto tty = entry.path().filename().string();
+    if (!tty.starts_with("ttyACM")) continue;
+
+    // class/tty/ttyACMn/device is the USB interface ("1-1.4:1.0"); its parent is the device.
+    std::error_code ec;
+    const auto iface = fs::canonical(entry.path() / "device", ec);
+    if (ec) continue;
+    const auto usb = iface.parent_path();
+
+    const auto vend = parse_u16_hex(read_text_file(usb / "idVendor"));
+    const auto prod = parse_u16_hex(read_text_file(usb / "idProduct"));
+    if (!vend || !prod || *vend != vendor) continue;
+
+    spdlog::debug("Found CDC-ACM port: {} on {} (VID: 0x{:04x}, PID: 0x{:04x})", tty, usb.filename().string(), *vend,
+                  *prod);
+    out.push_back(SerialPortInfo{.tty = tty, .usb_sysname = usb.filename().string(), .vendor = *vend, .product = *prod});
+  }
+
+  std::ranges::sort(out, tty_less);
+  return out;
+}
+
+SuddlmodResult send_suddlmod_to_samsung_serial(std::uint16_t vendor, int maxTargets, const SerialScanRoots& roots,
+                                               std::chrono::milliseconds timeout) {
+  SuddlmodResult out;
+
+  // Phones may expose more than one ACM function; the modem answers on the first.
+  std::vector<SerialPortInfo> ports;
+  std::set<std::string> devices;
+  for (auto& p : enumerate_cdc_acm_ports(vendor, roots)) {
+    if (is_odin_pid(p.product)) continue;
+    if (!devices.insert(p.usb_sysname).second) continue;
+    ports.push_back(std::move(p));
+  }
+
+  if (maxTargets > 0 && static_cast<int>(ports.size()) > maxTargets) {
+    ports.resize(static_cast<std::size_t>(maxTargets));
+  }
+  out.ports_seen = static_cast<int>(ports.size());
+
+  std::vector<std::optional<std::string>> errors(ports.size());
+  std::vector<std::thread> workers;
+  workers.reserve(ports.size());
+
+  for (std::size_t i = 0; i < ports.size(); ++i) {
+    workers.emplace_back([&, i]() { errors[i] = send_suddlmod_tty(roots.dev / ports[i].tty, timeout); });
+  }
+  for (auto& t : workers)
+    if (t.joinable()) t.join();
+
+  for (std::size_t i = 0; i < ports.size(); ++i) {
+    if (errors[i]) {
+      out.failures.push_back(ports[i].tty + " (" + ports[i].usb_sysname + "): " + *errors[i]);
+      continue;
+    }
+    ++out.sent_ok;
+  }
+
+  return out;
+}
+
 } // namespace brokkr::linux
@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstdint>
+#include <filesystem>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -42,7 +44,35 @@ struct EnumerateFilter {
   std::vector<std::uint16_t> products;
 };
 
+struct SuddlmodResult {
+  int ports_seen = 0;
+  int sent_ok = 0;
+  std::vector<std::string> failures;
+};
+
+// A CDC-ACM tty and the USB device it belongs to.
+struct SerialPortInfo {
+  std::string tty;         // "ttyACM0"
+  std::string usb_sysname; // "1-1.4"
+  std::uint16_t vendor = 0;
+  std::uint16_t product = 0;
+};
+
+// Where the serial scan looks; tests point these at a fake sysfs tree and pty links.
+struct SerialScanRoots {
+  std::filesystem::path sys = "/sys";
+  std::filesystem::path dev = "/dev";
+};
+
 std::vector<UsbDeviceSysfsInfo> enumerate_usb_devices_sysfs(const EnumerateFilter& filter);
 std::optional<UsbDeviceSysfsInfo> find_by_sysname(std::string_view sysname);
 
+std::vector<SerialPortInfo> enumerate_cdc_acm_ports(std::uint16_t vendor, const SerialScanRoots& roots = {});
+
+// Sends AT+SUDDLMOD to one ACM port per non-Odin device, all ports at once; each port gets `timeout`
+// for open + write + drain so a wedged modem cannot hold up the others.
+SuddlmodResult send_suddlmod_to_samsung_serial(std::uint16_t vendor = 0x04E8, int maxTargets = -1,
+                                               const SerialScanRoots& roots = {},
+                                               std::chrono::milliseconds timeout = std::chrono::milliseconds(1500));
+
 } // namespace brokkr::linux
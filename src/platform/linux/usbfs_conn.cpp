@@ -17,6 +17,8 @@
 
 #include "platform/linux/usbfs_conn.hpp"
 
+#include "core/trace.hpp"
+
 #include <algorithm>
 #include <cerrno>
 #include <cstdint>
@@ -82,7 +84,9 @@ int UsbFsConnection::send(std::span<const std::uint8_t> data, unsigned retries)
 
     unsigned attempt = 0;
     for (;;) {
+      BRK_TRACE(usb_bulk_submit, dev_.fd(), bulk.ep, want);
       const int rc = ::ioctl(dev_.fd(), USBDEVFS_BULK, &bulk);
+      BRK_TRACE(usb_bulk_reap, dev_.fd(), bulk.ep, rc);
       if (rc >= 0) {
         if (rc == 0 && want != 0) {
           spdlog::error("bulk OUT returned 0 for {} byte request", want);
@@ -159,7 +163,9 @@ int UsbFsConnection::recv(std::span<std::uint8_t> data, unsigned retries) {
     int retBytes = 0;
     unsigned attempt = 0;
     for (;;) {
+      BRK_TRACE(usb_bulk_submit, dev_.fd(), bulk.ep, xfer);
       retBytes = ::ioctl(dev_.fd(), USBDEVFS_BULK, &bulk);
+      BRK_TRACE(usb_bulk_reap, dev_.fd(), bulk.ep, retBytes);
       if (retBytes >= 0) break;
       const int e = errno;
       if (e == ENODEV || e == ESHUTDOWN || e == ENOENT) {
@@ -20,7 +20,9 @@
   #include "platform/posix-common/signal_shield.hpp"
   #include "platform/posix-common/single_instance.hpp"
   #include "platform/posix-common/tcp_transport.hpp"
+  #include "platform/posix-common/unix_socket.hpp"
 
+  #include "platform/linux/block_storage.hpp"
   #include "platform/linux/sysfs_usb.hpp"
   #include "platform/linux/usbfs_conn.hpp"
   #include "platform/linux/usbfs_device.hpp"
@@ -30,8 +32,12 @@ using namespace linux;
 using namespace posix_common;
 } // namespace brokkr::platform
 
+  // send_suddlmod_to_samsung_serial(): AT reboot into Download Mode over the phone's USB serial port.
+  #define BROKKR_HAS_SUDDLMOD 1
+
 #elif defined(BROKKR_PLATFORM_WINDOWS)
   #include "platform/windows/app_dirs.hpp"
+  #include "platform/windows/block_storage.hpp"
   #include "platform/windows/signal_shield.hpp"
   #include "platform/windows/single_instance.hpp"
   #include "platform/windows/sysfs_usb.hpp"
@@ -43,12 +49,16 @@ namespace brokkr::platform {
 using namespace windows;
 } // namespace brokkr::platform
 
+  #define BROKKR_HAS_SUDDLMOD 1
+
 #elif defined(BROKKR_PLATFORM_MACOS)
   #include "platform/posix-common/app_dirs.hpp"
   #include "platform/posix-common/signal_shield.hpp"
   #include "platform/posix-common/single_instance.hpp"
   #include "platform/posix-common/tcp_transport.hpp"
+  #include "platform/posix-common/unix_socket.hpp"
 
+  #include "platform/macos/block_storage.hpp"
   #include "platform/macos/sysfs_usb.hpp"
   #include "platform/macos/usbfs_conn.hpp"
   #include "platform/macos/usbfs_device.hpp"
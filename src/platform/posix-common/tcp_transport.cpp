@@ -24,6 +24,8 @@
 #include <utility>
 
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <poll.h>
@@ -49,6 +51,58 @@ TcpConnection::TcpConnection(int fd, std::string peer_ip, std::uint16_t peer_por
 
 TcpConnection::~TcpConnection() { close_(); }
 
+brokkr::core::Result<TcpConnection> TcpConnection::connect(const std::string& host, std::uint16_t port,
+                                                           int timeout_ms) noexcept {
+  addrinfo hints{};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo* res = nullptr;
+  const std::string port_s = std::to_string(port);
+  if (const int gai = ::getaddrinfo(host.c_str(), port_s.c_str(), &hints, &res); gai != 0 || !res) {
+    return brokkr::core::failf("Cannot resolve {}: {}", host, ::gai_strerror(gai));
+  }
+
+  sockaddr_in addr{};
+  std::memcpy(&addr, res->ai_addr, sizeof(addr));
+  ::freeaddrinfo(res);
+
+  FileHandle fd{do_socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+  if (!fd.valid()) return brokkr::core::failf("socket: {}", std::strerror(errno));
+
+  const int fl = ::fcntl(fd.fd, F_GETFL, 0);
+  (void)::fcntl(fd.fd, F_SETFL, fl | O_NONBLOCK);
+
+  if (::connect(fd.fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+    if (errno != EINPROGRESS) return brokkr::core::failf("connect {}:{}: {}", host, port, std::strerror(errno));
+
+    pollfd pfd{};
+    pfd.fd = fd.fd;
+    pfd.events = POLLOUT;
+    int pr = 0;
+    do {
+      pr = ::poll(&pfd, 1, timeout_ms);
+    } while (pr < 0 && errno == EINTR);
+    if (pr == 0) return brokkr::core::failf("connect {}:{}: timeout", host, port);
+
+    int soerr = 0;
+    socklen_t len = sizeof(soerr);
+    if (pr < 0 || ::getsockopt(fd.fd, SOL_SOCKET, SO_ERROR, &soerr, &len) != 0 || soerr != 0) {
+      return brokkr::core::failf("connect {}:{}: {}", host, port, std::strerror(soerr ? soerr : errno));
+    }
+  }
+
+  (void)::fcntl(fd.fd, F_SETFL, fl);
+
+  char ipbuf[INET_ADDRSTRLEN]{};
+  const char* ip = ::inet_ntop(AF_INET, &addr.sin_addr, ipbuf, sizeof(ipbuf));
+  spdlog::debug("TcpConnection: connected to {}:{}", ip ? ip : host.c_str(), port);
+
+  const int raw = fd.fd;
+  fd.fd = -1;
+  return TcpConnection(raw, ip ? std::string(ip) : host, port);
+}
+
 TcpConnection::TcpConnection(TcpConnection&& o) noexcept { *this = std::move(o); }
 
 TcpConnection& TcpConnection::operator=(TcpConnection&& o) noexcept {
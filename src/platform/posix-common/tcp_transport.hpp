@@ -43,6 +43,9 @@ class TcpConnection final : public brokkr::core::IByteTransport {
 
   ~TcpConnection();
 
+  static brokkr::core::Result<TcpConnection> connect(const std::string& host, std::uint16_t port,
+                                                     int timeout_ms = 3000) noexcept;
+
   bool connected() const noexcept override;
 
   void set_timeout_ms(int ms) noexcept override;
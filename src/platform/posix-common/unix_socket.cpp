@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "platform/posix-common/unix_socket.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+#ifndef SOCK_CLOEXEC
+  #define SOCK_CLOEXEC 0
+#endif
+#ifndef MSG_NOSIGNAL
+  #define MSG_NOSIGNAL 0
+#endif
+
+namespace brokkr::posix_common {
+
+namespace {
+
+constexpr std::size_t kMaxLineBytes = 16u * 1024u * 1024u;
+
+brokkr::core::Result<sockaddr_un> make_addr(const std::filesystem::path& path) noexcept {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  const std::string s = path.string();
+  if (s.empty() || s.size() >= sizeof(addr.sun_path)) return brokkr::core::failf("Socket path too long: {}", s);
+  std::memcpy(addr.sun_path, s.data(), s.size());
+  return addr;
+}
+
+void no_sigpipe(const brokkr::FileHandle& fd) noexcept {
+#if defined(SO_NOSIGPIPE)
+  int one = 1;
+  (void)do_setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#else
+  (void)fd;
+#endif
+}
+
+} // namespace
+
+brokkr::core::Result<UnixStream> UnixStream::connect(const std::filesystem::path& path) noexcept {
+  BRK_TRYV(addr, make_addr(path));
+
+  brokkr::FileHandle fd{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+  if (!fd.valid()) return brokkr::core::failf("socket: {}", std::strerror(errno));
+
+  for (;;) {
+    if (::connect(fd.fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0) break;
+    if (errno == EINTR) continue;
+    return brokkr::core::failf("connect {}: {}", path.string(), std::strerror(errno));
+  }
+
+  no_sigpipe(fd);
+  return UnixStream(std::exchange(fd.fd, -1));
+}
+
+brokkr::core::Status UnixStream::write_line(std::string_view line) noexcept {
+  if (!fd_.valid()) return brokkr::core::fail("UnixStream: closed");
+
+  std::string buf;
+  buf.reserve(line.size() + 1);
+  buf.append(line);
+  buf.push_back('\n');
+
+  const char* p = buf.data();
+  std::size_t left = buf.size();
+  while (left) {
+    const ssize_t n = ::send(fd_.fd, p, left, MSG_NOSIGNAL);
+    if (n > 0) {
+      p += n;
+      left -= static_cast<std::size_t>(n);
+      continue;
+    }
+    if (n < 0 && errno == EINTR) continue;
+    return brokkr::core::failf("UnixStream: send: {}", n == 0 ? "peer closed" : std::strerror(errno));
+  }
+  return {};
+}
+
+brokkr::core::Result<std::optional<std::string>> UnixStream::read_line(int timeout_ms) noexcept {
+  if (!fd_.valid()) return brokkr::core::fail("UnixStream: closed");
+
+  for (;;) {
+    if (const auto nl = rbuf_.find('\n'); nl != std::string::npos) {
+      std::string line = rbuf_.substr(0, nl);
+      rbuf_.erase(0, nl + 1);
+      return std::optional<std::string>(std::move(line));
+    }
+    if (rbuf_.size() > kMaxLineBytes) return brokkr::core::fail("UnixStream: line too long");
+
+    pollfd pfd{};
+    pfd.fd = fd_.fd;
+    pfd.events = POLLIN;
+    const int pr = ::poll(&pfd, 1, timeout_ms);
+    if (pr == 0) return brokkr::core::fail("UnixStream: timeout");
+    if (pr < 0) {
+      if (errno == EINTR) continue;
+      return brokkr::core::failf("UnixStream: poll: {}", std::strerror(errno));
+    }
+
+    char tmp[4096];
+    const ssize_t n = ::recv(fd_.fd, tmp, sizeof(tmp), 0);
+    if (n > 0) {
+      rbuf_.append(tmp, static_cast<std::size_t>(n));
+      continue;
+    }
+    if (n == 0) return std::optional<std::string>{};
+    if (errno == EINTR || errno == EAGAIN) continue;
+    return brokkr::core::failf("UnixStream: recv: {}", std::strerror(errno));
+  }
+}
+
+UnixListener::~UnixListener() { close(); }
+
+void UnixListener::close() noexcept {
+  if (!fd_.valid()) return;
+  spdlog::debug("UnixListener: close {}", path_.string());
+  fd_.close();
+  std::error_code ec;
+  std::filesystem::remove(path_, ec);
+}
+
+brokkr::core::Status UnixListener::bind_and_listen(std::filesystem::path path, int backlog) noexcept {
+  close();
+  BRK_TRYV(addr, make_addr(path));
+
+  std::error_code ec;
+  if (std::filesystem::exists(path, ec)) {
+    // A live daemon answers; anything else is a stale socket from a crashed run.
+    if (UnixStream::connect(path)) return brokkr::core::failf("{} is already in use", path.string());
+    std::filesystem::remove(path, ec);
+  }
+  std::filesystem::create_directories(path.parent_path(), ec);
+
+  fd_.take(do_socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+  if (!fd_.valid()) return brokkr::core::failf("socket: {}", std::strerror(errno));
+
+  const mode_t old_mask = ::umask(0077);
+  const int brc = do_bind(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+  const int berr = errno;
+  ::umask(old_mask);
+  if (brc != 0) {
+    fd_.close();
+    return brokkr::core::failf("bind {}: {}", path.string(), std::strerror(berr));
+  }
+
+  path_ = std::move(path);
+  if (do_listen(fd_, backlog) != 0) {
+    const int e = errno;
+    close();
+    return brokkr::core::failf("listen: {}", std::strerror(e));
+  }
+
+  spdlog::debug("UnixListener: listening on {}", path_.string());
+  return {};
+}
+
+brokkr::core::Result<UnixStream> UnixListener::accept_one() noexcept {
+  if (!fd_.valid()) return brokkr::core::fail("UnixListener: not listening");
+
+  pollfd pfd{};
+  pfd.fd = fd_.fd;
+  pfd.events = POLLIN;
+
+  for (;;) {
+    const int pr = ::poll(&pfd, 1, 100);
+    if (pr == 0) return brokkr::core::fail("accept: timeout");
+    if (pr < 0) {
+      if (errno == EINTR) return brokkr::core::fail("accept: timeout");
+      return brokkr::core::failf("poll: {}", std::strerror(errno));
+    }
+    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) return brokkr::core::fail("accept: listener closed");
+    break;
+  }
+
+  for (;;) {
+    const int cfd = do_accept(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (cfd >= 0) {
+      brokkr::FileHandle h{cfd};
+      no_sigpipe(h);
+      return UnixStream(std::exchange(h.fd, -1));
+    }
+    const int e = errno;
+    if (e == EINTR) continue;
+    if (e == EAGAIN || e == EWOULDBLOCK) return brokkr::core::fail("accept: timeout");
+    return brokkr::core::failf("accept: {}", std::strerror(e));
+  }
+}
+
+} // namespace brokkr::posix_common
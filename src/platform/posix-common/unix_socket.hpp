@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "core/status.hpp"
+#include "filehandle.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace brokkr::posix_common {
+
+// Line-oriented stream over an AF_UNIX socket; used by the local control daemon.
+class UnixStream {
+ public:
+  UnixStream() = default;
+  explicit UnixStream(int fd) : fd_(fd) {}
+
+  UnixStream(UnixStream&&) noexcept = default;
+  UnixStream& operator=(UnixStream&&) noexcept = default;
+
+  static brokkr::core::Result<UnixStream> connect(const std::filesystem::path& path) noexcept;
+
+  bool valid() const noexcept { return fd_.valid(); }
+
+  brokkr::core::Status write_line(std::string_view line) noexcept;
+
+  // Returns std::nullopt on orderly EOF; timeout_ms < 0 waits forever.
+  brokkr::core::Result<std::optional<std::string>> read_line(int timeout_ms = -1) noexcept;
+
+  void close() noexcept { fd_.close(); }
+
+ private:
+  brokkr::FileHandle fd_;
+  std::string rbuf_;
+};
+
+class UnixListener {
+ public:
+  UnixListener() = default;
+  ~UnixListener();
+
+  UnixListener(const UnixListener&) = delete;
+  UnixListener& operator=(const UnixListener&) = delete;
+
+  brokkr::core::Status bind_and_listen(std::filesystem::path path, int backlog = 16) noexcept;
+  brokkr::core::Result<UnixStream> accept_one() noexcept;
+
+  void close() noexcept;
+
+ private:
+  brokkr::FileHandle fd_;
+  std::filesystem::path path_;
+};
+
+} // namespace brokkr::posix_common
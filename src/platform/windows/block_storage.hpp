@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace brokkr::windows {
+
+enum class StorageKind { Unknown, Rotational, Solid };
+
+// The block device a file lives on, as far as the OS tells us.
+struct StorageInfo {
+  StorageKind kind = StorageKind::Unknown;
+  std::uint64_t device = 0; // files with the same non-zero id share a disk
+  std::string name;         // "sda", "nvme0n1"
+  bool usb = false;         // behind a USB mass-storage bridge
+  unsigned queue_depth = 0; // 0 = unknown
+};
+
+// Not probed on this platform yet; always Unknown.
+StorageInfo storage_info(const std::filesystem::path& file) noexcept;
+
+} // namespace brokkr::windows
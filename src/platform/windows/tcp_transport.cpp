@@ -92,6 +92,54 @@ TcpConnection::~TcpConnection() {
   if (wsa_init_) WsaScope::release();
 }
 
+brokkr::core::Result<TcpConnection> TcpConnection::connect(const std::string& host, std::uint16_t port,
+                                                           int timeout_ms) noexcept {
+  WsaScope::acquire();
+  struct Release {
+    ~Release() { WsaScope::release(); }
+  } release;
+
+  addrinfo hints{};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo* res = nullptr;
+  const std::string port_s = std::to_string(port);
+  if (::getaddrinfo(host.c_str(), port_s.c_str(), &hints, &res) != 0 || !res) {
+    return brokkr::core::failf("Cannot resolve {}: {}", host, WSAGetLastError());
+  }
+
+  sockaddr_in addr{};
+  std::memcpy(&addr, res->ai_addr, sizeof(addr));
+  ::freeaddrinfo(res);
+
+  SOCKET s = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (s == INVALID_SOCKET) return brokkr::core::failf("socket failed: {}", WSAGetLastError());
+
+  set_nonblocking_(s, true);
+  if (::connect(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+    const int err = WSAGetLastError();
+    if (err != WSAEWOULDBLOCK) {
+      ::closesocket(s);
+      return brokkr::core::failf("connect {}:{} failed: {}", host, port, err);
+    }
+
+    WSAPOLLFD pfd{};
+    pfd.fd = s;
+    pfd.events = POLLWRNORM;
+    const int pr = WSAPoll(&pfd, 1, timeout_ms);
+    if (pr <= 0 || (pfd.revents & (POLLERR | POLLHUP))) {
+      ::closesocket(s);
+      return brokkr::core::failf("connect {}:{} failed: {}", host, port, pr == 0 ? "timeout" : "refused");
+    }
+  }
+
+  char ipbuf[INET_ADDRSTRLEN]{};
+  const char* ip = ::inet_ntop(AF_INET, &addr.sin_addr, ipbuf, sizeof(ipbuf));
+  spdlog::debug("TcpConnection: connected to {}:{}", ip ? ip : host.c_str(), port);
+  return TcpConnection(s, ip ? std::string(ip) : host, port);
+}
+
 TcpConnection::TcpConnection(TcpConnection&& o) noexcept { *this = std::move(o); }
 
 TcpConnection& TcpConnection::operator=(TcpConnection&& o) noexcept {
@@ -35,6 +35,29 @@ namespace brokkr::odin {
 
 namespace {
 
+constexpr std::size_t kDownloadListMaxBytes = 128 * 1024;
+
+// Serves bytes captured during ingest to the parsers that otherwise read the archive.
+class HeadSource final : public io::ByteSource {
+ public:
+  HeadSource(std::string name, std::span<const std::byte> bytes) : name_(std::move(name)), bytes_(bytes) {}
+
+  std::string display_name() const override { return name_; }
+  std::uint64_t size() const override { return bytes_.size(); }
+
+  std::size_t read(std::span<std::byte> out) override {
+    const std::size_t n = std::min(out.size(), bytes_.size() - pos_);
+    std::copy_n(bytes_.begin() + static_cast<std::ptrdiff_t>(pos_), n, out.begin());
+    pos_ += n;
+    return n;
+  }
+
+ private:
+  std::string name_;
+  std::span<const std::byte> bytes_;
+  std::size_t pos_ = 0;
+};
+
 static bool is_lz4_name(std::string_view base) { return brokkr::core::ends_with_ci(base, ".lz4"); }
 
 static std::string strip_lz4_suffix(std::string s) {
@@ -102,7 +125,14 @@ static bool lists_equal(const std::vector<std::string>& a, const std::vector<std
   return true;
 }
 
-static brokkr::core::Result<std::uint64_t> lz4_content_size(const ImageSpec& spec) noexcept {
+static brokkr::core::Result<std::uint64_t> lz4_content_size(const ImageSpec& spec,
+                                                             std::span<const std::byte> head) noexcept {
+  if (head.size() >= io::kLz4FrameHeaderBytes) {
+    HeadSource src(spec.display, head);
+    BRK_TRYV(h, io::parse_lz4_frame_header(src));
+    return h.content_size;
+  }
+
   BRK_TRYV(src, spec.open());
   BRK_TRYV(h, io::parse_lz4_frame_header(*src));
   return h.content_size;
@@ -110,7 +140,8 @@ static brokkr::core::Result<std::uint64_t> lz4_content_size(const ImageSpec& spe
 
 static brokkr::core::Result<ImageSpec> make_spec(ImageSpec::Kind kind, std::filesystem::path path, io::TarEntry entry,
                                                  std::string display, std::string source_basename,
-                                                 std::uint64_t disk_size) noexcept {
+                                                 std::uint64_t disk_size,
+                                                 std::span<const std::byte> head = {}) noexcept {
   ImageSpec spec;
   spec.kind = kind;
   spec.path = std::move(path);
@@ -124,7 +155,7 @@ static brokkr::core::Result<ImageSpec> make_spec(ImageSpec::Kind kind, std::file
   spec.basename = spec.lz4 ? strip_lz4_suffix(spec.source_basename) : spec.source_basename;
 
   if (spec.lz4) {
-    BRK_TRYV(sz, lz4_content_size(spec));
+    BRK_TRYV(sz, lz4_content_size(spec, head));
     spec.size = sz;
   } else {
     spec.size = spec.disk_size;
@@ -135,6 +166,15 @@ static brokkr::core::Result<ImageSpec> make_spec(ImageSpec::Kind kind, std::file
 
 } // namespace
 
+std::size_t spec_head_bytes(const io::TarEntry& e) noexcept {
+  if (e.is_sparse()) return 0;
+  if (is_download_list_name(e.name)) return e.size <= kDownloadListMaxBytes ? static_cast<std::size_t>(e.size) : 0;
+  if (is_lz4_name(io::basename(e.name))) {
+    return static_cast<std::size_t>(std::min<std::uint64_t>(e.size, io::kLz4FrameHeaderBytes));
+  }
+  return 0;
+}
+
 brokkr::core::Result<std::unique_ptr<io::ByteSource>> ImageSpec::open() const noexcept {
   switch (kind) {
     case Kind::RawFile: return io::open_raw_file(path);
@@ -157,8 +197,14 @@ brokkr::core::Result<std::vector<ImageSpec>> expand_inputs_tar_or_raw(
     BRK_TRYV(tar, io::TarArchive::open(p.string(), true));
 
     if (auto e = find_download_list_entry(tar)) {
-      BRK_TRYV(src, io::open_tar_entry(p, *e));
-      BRK_TRYV(txt, read_text(*src, 128 * 1024, "download-list.txt"));
+      std::unique_ptr<io::ByteSource> src;
+      if (const auto head = tar.head(*e); head.size() == e->size) {
+        src = std::make_unique<HeadSource>(e->name, head);
+      } else {
+        BRK_TRYV(opened, io::open_tar_entry(p, *e));
+        src = std::move(opened);
+      }
+      BRK_TRYV(txt, read_text(*src, kDownloadListMaxBytes, "download-list.txt"));
       BRK_TRYV(names, parse_download_list(txt));
 
       if (!dl)
@@ -235,7 +281,8 @@ brokkr::core::Result<std::vector<ImageSpec>> expand_inputs_tar_or_raw(
           continue;
         }
 
-        BRK_TRYV(spec, make_spec(ImageSpec::Kind::TarEntry, p, e, p.string() + ":" + e.name, sb, e.size));
+        BRK_TRYV(spec, make_spec(ImageSpec::Kind::TarEntry, p, e, p.string() + ":" + e.name, sb, e.size,
+                                 tars[i]->head(e)));
         if (is_pit) {
           pit_specs.push_back(std::move(spec));
         } else {
@@ -66,6 +66,9 @@ struct FlashItem {
 
 brokkr::core::Result<std::vector<ImageSpec>> expand_inputs_tar_or_raw(
     const std::vector<std::filesystem::path>& inputs) noexcept;
+// Leading bytes of a tar member that expand_inputs_tar_or_raw() reads (LZ4 frame header, download-list.txt);
+// ingest keeps them in the archive index so expansion needs no reads of its own.
+std::size_t spec_head_bytes(const io::TarEntry& e) noexcept;
 brokkr::core::Result<std::vector<FlashItem>> map_to_pit(const pit::PitTable& pit_table,
                                                         const std::vector<ImageSpec>& sources) noexcept;
 
@@ -92,6 +95,12 @@ inline std::size_t lz4_nonfinal_block_limit(std::uint64_t buffer_bytes) noexcept
   return std::min<std::size_t>(want, kMaxNonFinalLz4Blocks);
 }
 
+// Compressed windows carry whole 1 MiB LZ4 blocks, so a window never drops below that.
+inline std::size_t window_bytes(std::size_t buffer_bytes, std::size_t window_packets, std::size_t pkt) noexcept {
+  if (!window_packets || !pkt) return buffer_bytes;
+  return std::max<std::size_t>(pkt * window_packets, static_cast<std::size_t>(kOneMiB));
+}
+
 struct PreparedLz4Window {
   std::uint64_t comp_size = 0;
   std::uint64_t rounded_size = 0;
@@ -17,7 +17,10 @@
 
 #include "protocol/odin/group_flasher.hpp"
 
-#include "core/prefetcher.hpp"
+#include "core/buffer_pool.hpp"
+#include "core/pipeline.hpp"
+#include "core/trace.hpp"
+#include "io/lz4_compress.hpp"
 #include "io/lz4_frame.hpp"
 #include "io/read_exact.hpp"
 #include "protocol/odin/pit_transfer.hpp"
@@ -31,7 +34,9 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <stop_token>
+#include <string>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -121,6 +126,12 @@ static bool any_lz4(const std::vector<ImageSpec>& v) {
   return std::any_of(v.begin(), v.end(), [](const ImageSpec& s) { return s.lz4; });
 }
 
+static bool is_sparse_raw(const ImageSpec& s) {
+  return s.kind == ImageSpec::Kind::TarEntry && !s.lz4 && s.entry.is_sparse();
+}
+
+static bool any_sparse(const std::vector<ImageSpec>& v) { return std::any_of(v.begin(), v.end(), is_sparse_raw); }
+
 static brokkr::core::Result<std::vector<ImageSpec>> sources_common_mapping_or_empty(
     const std::vector<Target*>& devs, const std::vector<ImageSpec>& sources) noexcept {
   std::vector<ImageSpec> out;
@@ -176,12 +187,252 @@ static Step st_end(bool comp, u64 end_sz, std::int32_t part_id, std::int32_t dev
   return Step{.op = Step::Op::End, .comp = comp, .a = end_sz, .part_id = part_id, .dev_type = dev_type, .last = last};
 }
 
-template <class PF, class MakeContrib>
-static brokkr::core::Status send_prefetched(PF& pf, std::barrier<>& sync, Step& cur, const std::size_t pkt,
-                                            const bool comp, const std::int32_t part_id, const std::int32_t dev_type,
-                                            const u64 total_bytes, const u64 item_total, u64& overall_done,
-                                            u64& item_done, const Ui& ui, std::atomic_uint32_t& failed_count,
-                                            const std::size_t ndevs, MakeContrib make_contrib) noexcept {
+// The End step follows the last packet's ACK, so its round trip is the device's flush of that window.
+static void note_flush(std::vector<PartFlush>& out, const Step& end, u64 wire, std::chrono::steady_clock::duration dt) {
+  if (out.empty() || out.back().part_id != end.part_id) out.push_back(PartFlush{.part_id = end.part_id});
+  auto& p = out.back();
+  p.bytes += end.a;
+  p.wire_bytes += wire;
+  ++p.windows;
+  p.flush += std::chrono::duration_cast<std::chrono::nanoseconds>(dt);
+}
+
+// One unit of the data phase. Raw and device-compressed items travel as whole
+// download windows; host-decoded LZ4 travels as block-sized chunks so the
+// decode stage can fan out, with opens/closes marking the window edges.
+struct Window {
+  brokkr::core::PooledBytes bytes;
+  u64 begin = 0, end = 0, rounded = 0;
+  u64 payload = 0;
+  bool opens = true, closes = true;
+  bool last = false;
+  const std::byte* data() const { return bytes->data(); }
+};
+
+using WindowPipe = brokkr::core::Pipeline<Window>;
+
+static brokkr::core::Result<Window> pad_window(Window w) noexcept {
+  w.bytes->resize(static_cast<std::size_t>(w.rounded), std::byte{0});
+  return w;
+}
+
+static std::size_t decode_workers(const Cfg& cfg) noexcept {
+  if (cfg.decode_workers) return cfg.decode_workers;
+  const unsigned hw = std::thread::hardware_concurrency();
+  return std::clamp<std::size_t>(hw > 1 ? hw - 1 : 1, 1, 3);
+}
+
+static brokkr::core::Result<WindowPipe> raw_windows(std::unique_ptr<io::ByteSource> src, std::size_t window,
+                                                    std::size_t pkt, std::size_t depth, const std::string& display) {
+  const u64 file_sz = src->size();
+  if (!file_sz) return brokkr::core::fail("Empty source: " + display);
+
+  const auto max_rounded =
+      static_cast<std::size_t>(detail::round_up64(static_cast<u64>(window), static_cast<u64>(pkt)));
+
+  return WindowPipe::source([src = std::move(src), file_sz, window, pkt, max_rounded,
+                             sent = u64{0}](std::stop_token st) mutable -> brokkr::core::Result<std::optional<Window>> {
+           if (st.stop_requested() || sent >= file_sz) return std::optional<Window>{};
+
+           const u64 actual = std::min<u64>(file_sz - sent, window);
+
+           Window w{.bytes = brokkr::core::PooledBytes(max_rounded)};
+           w.bytes->resize(static_cast<std::size_t>(actual));
+           BRK_TRY(io::read_exact(*src, *w.bytes));
+
+           w.rounded = detail::round_up64(actual, pkt);
+           w.begin = w.rounded;
+           w.end = actual;
+           w.payload = actual;
+
+           sent += actual;
+           w.last = sent >= file_sz;
+           return std::optional<Window>{std::move(w)};
+         })
+      .then(1, pad_window, depth);
+}
+
+static brokkr::core::Result<WindowPipe> lz4_stream_windows(std::unique_ptr<io::ByteSource> src, std::size_t window,
+                                                           std::size_t pkt, std::size_t depth,
+                                                           const std::string& display) {
+  BRK_TRYV(reader, io::Lz4BlockStreamReader::open(std::move(src)));
+
+  const u64 total = reader.content_size();
+  if (!total) return brokkr::core::fail("LZ4 content size is zero: " + display);
+
+  const std::size_t max_blocks = detail::lz4_nonfinal_block_limit(window);
+  if (!max_blocks) return brokkr::core::fail("buffer_bytes too small for compressed download (needs >= 1MiB)");
+
+  const std::size_t cap = max_blocks * (static_cast<std::size_t>(detail::kOneMiB) + 4);
+
+  return WindowPipe::source([reader = std::move(reader), total, max_blocks, pkt, cap,
+                             sent = u64{0}](std::stop_token st) mutable -> brokkr::core::Result<std::optional<Window>> {
+           if (st.stop_requested() || sent >= total) return std::optional<Window>{};
+
+           const u64 rem = total - sent;
+           const bool last = rem <= static_cast<u64>(max_blocks) * detail::kOneMiB;
+           const u64 decomp_sz = last ? rem : static_cast<u64>(max_blocks) * detail::kOneMiB;
+           const std::size_t blocks =
+               !last ? static_cast<std::size_t>(decomp_sz / detail::kOneMiB) : reader.blocks_remaining_1m();
+
+           Window w{.bytes = brokkr::core::PooledBytes(cap)};
+           BRK_TRYV(comp, reader.read_n_blocks(blocks, *w.bytes));
+
+           w.begin = static_cast<u64>(comp);
+           w.end = decomp_sz;
+           w.rounded = detail::round_up64(w.begin, pkt);
+           w.payload = w.begin;
+           w.last = last;
+
+           sent += decomp_sz;
+           return std::optional<Window>{std::move(w)};
+         })
+      .then(1, pad_window, depth);
+}
+
+static brokkr::core::Result<WindowPipe> lz4_decoded_windows(std::unique_ptr<io::ByteSource> src, std::size_t window,
+                                                            std::size_t pkt, std::size_t workers, std::size_t depth,
+                                                            const std::string& display) {
+  BRK_TRYV(reader, io::Lz4BlockStreamReader::open(std::move(src)));
+
+  const u64 total = reader.content_size();
+  if (!total) return brokkr::core::fail("LZ4 content size is zero: " + display);
+
+  const u64 win_cap = std::max<u64>(1, window / detail::kOneMiB) * detail::kOneMiB;
+  // Interior chunks go out unpadded, so they must be whole packets.
+  const u64 chunk_cap = (detail::kOneMiB % pkt) ? win_cap : detail::kOneMiB;
+
+  struct State {
+    io::Lz4BlockStreamReader reader;
+    u64 sent = 0;
+    u64 win_size = 0, win_left = 0;
+  };
+
+  return WindowPipe::source(
+             [s = State{std::move(reader)}, total, win_cap, chunk_cap,
+              pkt](std::stop_token st) mutable -> brokkr::core::Result<std::optional<Window>> {
+               if (st.stop_requested() || s.sent >= total) return std::optional<Window>{};
+
+               Window w{};
+               w.opens = !s.win_left;
+               if (w.opens) {
+                 s.win_size = s.win_left = std::min<u64>(total - s.sent, win_cap);
+                 w.begin = detail::round_up64(s.win_size, pkt);
+               }
+
+               const u64 n = std::min<u64>(s.win_left, chunk_cap);
+               const auto blocks = static_cast<std::size_t>((n + detail::kOneMiB - 1) / detail::kOneMiB);
+
+               w.bytes = brokkr::core::PooledBytes(blocks * (static_cast<std::size_t>(detail::kOneMiB) + 4));
+               BRK_TRY(s.reader.read_n_blocks(blocks, *w.bytes));
+
+               s.win_left -= n;
+               s.sent += n;
+
+               w.payload = n;
+               w.closes = !s.win_left;
+               w.end = w.closes ? s.win_size : 0;
+               w.rounded = w.closes ? detail::round_up64(n, pkt) : n;
+               w.last = s.sent >= total;
+               return std::optional<Window>{std::move(w)};
+             },
+             workers)
+      .then(
+          workers,
+          [](Window in) -> brokkr::core::Result<Window> {
+            Window out = std::move(in);
+            brokkr::core::PooledBytes comp = std::move(out.bytes);
+            out.bytes = brokkr::core::PooledBytes(static_cast<std::size_t>(out.rounded));
+            out.bytes->resize(static_cast<std::size_t>(out.payload));
+            BRK_TRY(io::decode_lz4_blocks(*comp, *out.bytes));
+            return out;
+          })
+      .then(1, pad_window, depth);
+}
+
+// Sparse members on devices with compressed download: hole blocks become a
+// precomputed zero LZ4 block and only stored extents are read and compressed.
+struct SparseChunk {
+  brokkr::core::PooledBytes data;
+  std::vector<std::uint8_t> hole;
+  u64 decomp = 0;
+  bool last = false;
+};
+
+static brokkr::core::Result<Window> compress_sparse_chunk(SparseChunk c, std::size_t pkt) noexcept {
+  Window w{.bytes = brokkr::core::PooledBytes(c.hole.size() * (io::lz4_compress_bound(detail::kOneMiB) + 4))};
+
+  std::size_t in = 0;
+  u64 left = c.decomp;
+  for (const auto hole : c.hole) {
+    const auto len = static_cast<std::size_t>(std::min<u64>(left, detail::kOneMiB));
+    left -= len;
+    if (hole) {
+      io::lz4_append_zero_block(len, *w.bytes);
+    } else {
+      io::lz4_append_frame_block({c.data->data() + in, len}, *w.bytes);
+      in += len;
+    }
+  }
+
+  w.begin = w.bytes->size();
+  w.end = c.decomp;
+  w.rounded = detail::round_up64(w.begin, pkt);
+  w.payload = w.begin;
+  w.last = c.last;
+  return w;
+}
+
+static brokkr::core::Result<WindowPipe> sparse_lz4_windows(std::unique_ptr<io::SparseTarEntrySource> src,
+                                                           std::size_t window, std::size_t pkt, std::size_t workers,
+                                                           std::size_t depth, const std::string& display) {
+  const u64 total = src->size();
+  if (!total) return brokkr::core::fail("Empty source: " + display);
+
+  const std::size_t max_blocks = detail::lz4_nonfinal_block_limit(window);
+  if (!max_blocks) return brokkr::core::fail("buffer_bytes too small for compressed download (needs >= 1MiB)");
+
+  return brokkr::core::Pipeline<SparseChunk>::source(
+             [src = std::move(src), total, max_blocks,
+              sent = u64{0}](std::stop_token st) mutable -> brokkr::core::Result<std::optional<SparseChunk>> {
+               if (st.stop_requested() || sent >= total) return std::optional<SparseChunk>{};
+
+               const u64 n = std::min<u64>(total - sent, static_cast<u64>(max_blocks) * detail::kOneMiB);
+
+               SparseChunk c{};
+               c.data = brokkr::core::PooledBytes(static_cast<std::size_t>(n));
+               for (u64 done = 0; done < n;) {
+                 const auto len = static_cast<std::size_t>(std::min<u64>(n - done, detail::kOneMiB));
+                 done += len;
+
+                 const bool hole = src->hole_ahead(len);
+                 c.hole.push_back(hole ? 1 : 0);
+                 if (hole) {
+                   src->skip(len);
+                   continue;
+                 }
+
+                 const std::size_t at = c.data->size();
+                 c.data->resize(at + len);
+                 BRK_TRY(io::read_exact(*src, {c.data->data() + at, len}));
+               }
+
+               sent += n;
+               c.decomp = n;
+               c.last = sent >= total;
+               return std::optional<SparseChunk>{std::move(c)};
+             },
+             workers)
+      .then(workers, [pkt](SparseChunk c) { return compress_sparse_chunk(std::move(c), pkt); })
+      .then(1, pad_window, depth);
+}
+
+template <class MakeContrib>
+static brokkr::core::Status send_windows(WindowPipe& pf, std::barrier<>& sync, Step& cur, const std::size_t pkt,
+                                         const bool comp, const std::int32_t part_id, const std::int32_t dev_type,
+                                         const u64 total_bytes, const u64 item_total, u64& overall_done,
+                                         u64& item_done, const Ui& ui, std::atomic_uint32_t& failed_count,
+                                         const std::size_t ndevs, MakeContrib make_contrib) noexcept {
   const u64 pkt64 = static_cast<u64>(pkt);
 
   auto emit = [&](Step s) {
@@ -193,20 +444,18 @@ static brokkr::core::Status send_prefetched(PF& pf, std::barrier<>& sync, Step&
   for (;;) {
     if (failed_count.load(std::memory_order_relaxed) >= ndevs) break;
 
-    auto lease = pf.next();
-    if (!lease) break;
+    auto w = pf.next();
+    if (!w) break;
 
-    auto& w = lease->get();
-    const u64 rounded = static_cast<u64>(w.rounded);
-    const u64 packets = rounded / pkt64;
+    const u64 packets = w->rounded / pkt64;
 
-    emit(st_begin(comp, w.begin));
-    auto contrib = make_contrib(w, packets);
+    if (w->opens) emit(st_begin(comp, w->begin));
+    auto contrib = make_contrib(*w, packets);
 
     for (u64 p = 0; p < packets; ++p) {
       if (failed_count.load(std::memory_order_relaxed) >= ndevs) break;
 
-      emit(st_data(comp, w.data(), p * pkt64, pkt));
+      emit(st_data(comp, w->data(), p * pkt64, pkt));
       const u64 add = contrib(p);
 
       item_done += add;
@@ -214,524 +463,453 @@ static brokkr::core::Status send_prefetched(PF& pf, std::barrier<>& sync, Step&
       if (ui.on_progress) ui.on_progress(overall_done, total_bytes, item_done, item_total);
     }
 
-    emit(st_end(comp, w.end, part_id, dev_type, w.last));
-    if (w.last || (failed_count.load(std::memory_order_relaxed) >= ndevs)) break;
+    if (!w->closes) continue;
+    emit(st_end(comp, w->end, part_id, dev_type, w->last));
+    if (w->last || (failed_count.load(std::memory_order_relaxed) >= ndevs)) break;
   }
 
-  auto pst = pf.status();
-  return pst ? brokkr::core::Status{} : pst;
+  pf.cancel();
+  return pf.status();
 }
 
-} // namespace
-
-brokkr::core::Status flash(std::vector<Target*>& devs, const std::vector<ImageSpec>& sources,
-                           std::shared_ptr<const std::vector<std::byte>> pit_to_upload, const Cfg& cfg,
-                           Ui ui) noexcept {
-  if (devs.empty()) return brokkr::core::fail("flash: no devices");
-  for (auto* d : devs)
-    if (!d || !d->link || !d->link->connected()) return brokkr::core::fail("flash: transport not connected");
-
-  const bool has_sources = !sources.empty();
-  const bool has_pit = pit_to_upload && !pit_to_upload->empty();
-
-  if (!has_sources && !has_pit) return brokkr::core::fail("flash: nothing to do (no sources, no PIT)");
-
-  const std::size_t total_devices = devs.size();
-  std::size_t failed_total = 0;
-
-  FirstError first_err;
-  const auto sm_final = shutdown_mode_final(cfg);
-
-  auto stage = [&](std::string_view s) {
-    if (ui.on_stage) ui.on_stage(std::string(s));
-  };
-
-  std::vector<Target*> active = devs;
-  std::vector<std::size_t> active_idx;
-  active_idx.reserve(devs.size());
-  for (std::size_t i = 0; i < devs.size(); ++i) active_idx.push_back(i);
+// Runs fn on every active device in parallel and drops the ones that fail.
+template <class Fn>
+static brokkr::core::Status fanout_keep(PreparedGroup& g, const Ui& ui, Fn&& fn) {
+  if (g.active.empty()) return brokkr::core::fail("No active devices");
 
-  auto fanout_keep = [&](auto&& fn) -> brokkr::core::Status {
-    if (active.empty()) return brokkr::core::fail("No active devices");
+  std::vector<brokkr::core::Status> sts(g.active.size(), brokkr::core::Status{});
+  std::vector<std::jthread> ts;
+  ts.reserve(g.active.size());
 
-    std::vector<brokkr::core::Status> sts(active.size(), brokkr::core::Status{});
-    std::vector<std::jthread> ts;
-    ts.reserve(active.size());
+  for (std::size_t i = 0; i < g.active.size(); ++i) ts.emplace_back([&, i] { sts[i] = fn(*g.active[i]); });
+  for (auto& t : ts)
+    if (t.joinable()) t.join();
 
-    for (std::size_t i = 0; i < active.size(); ++i) ts.emplace_back([&, i] { sts[i] = fn(*active[i]); });
-    for (auto& t : ts)
-      if (t.joinable()) t.join();
-
-    std::vector<Target*> next;
-    std::vector<std::size_t> next_idx;
-    next.reserve(active.size());
-    next_idx.reserve(active.size());
-
-    for (std::size_t i = 0; i < active.size(); ++i) {
-      if (sts[i]) {
-        next.push_back(active[i]);
-        next_idx.push_back(active_idx[i]);
-        continue;
-      }
+  std::vector<Target*> next;
+  std::vector<std::size_t> next_idx;
+  next.reserve(g.active.size());
+  next_idx.reserve(g.active.size());
 
-      ++failed_total;
-      const auto msg = sts[i].error();
-      first_err.set(std::move(sts[i]));
-      emit_devfail(ui, active_idx[i], msg);
+  for (std::size_t i = 0; i < g.active.size(); ++i) {
+    if (sts[i]) {
+      next.push_back(g.active[i]);
+      next_idx.push_back(g.active_idx[i]);
+      continue;
     }
 
-    active.swap(next);
-    active_idx.swap(next_idx);
+    ++g.failed;
+    const auto msg = sts[i].error();
+    if (!g.first_error) g.first_error = msg;
+    emit_devfail(ui, g.active_idx[i], msg);
+  }
 
-    if (active.empty()) {
-      auto st = first_err.status_or_ok();
-      if (st) st = brokkr::core::fail("All devices failed");
-      return st;
-    }
+  g.active.swap(next);
+  g.active_idx.swap(next_idx);
 
-    return {};
-  };
-
-  auto finish = [&](brokkr::core::Status st, bool call_done_always) -> brokkr::core::Status {
-    if (!st) {
-      log_summary(total_devices, total_devices);
-      return st;
-    }
-    if (call_done_always && ui.on_done) ui.on_done();
-    log_summary(total_devices, failed_total);
-    return (failed_total > 0 || first_err.has_error())
-               ? first_err.status_or_ok()
-               : (ui.on_done ? (ui.on_done(), brokkr::core::Status{}) : brokkr::core::Status{});
-  };
+  if (g.active.empty()) {
+    if (g.first_error) return brokkr::core::Status{std::unexpect, *g.first_error};
+    return brokkr::core::fail("All devices failed");
+  }
 
-  auto set_flash_timeout_active = [&] {
-    for (auto* d : active) link(*d).set_timeout_ms(cfg.flash_timeout_ms);
-  };
+  return {};
+}
 
-  std::size_t pkt = 0;
-  std::vector<PlanItem> plan;
-  std::vector<FlashItem> items;
-  std::vector<ImageSpec> effective_sources;
-  u64 total = 0;
+static void set_flash_timeout(PreparedGroup& g, const Cfg& cfg) {
+  for (auto* d : g.active) link(*d).set_timeout_ms(cfg.flash_timeout_ms);
+}
 
-  auto shutdown_active = [&](OdinCommands::ShutdownMode m, std::string_view stg) -> brokkr::core::Status {
-    log_shutdown_action(m);
-    stage(stg);
-    return fanout_keep([&](Target& d) { return OdinCommands(link(d)).shutdown(m); });
-  };
+static bool same_items(const std::vector<FlashItem>& a, const std::vector<FlashItem>& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const FlashItem& x, const FlashItem& y) {
+    return x.part.id == y.part.id && x.part.dev_type == y.part.dev_type && x.spec.path == y.spec.path &&
+           x.spec.basename == y.spec.basename && x.spec.size == y.spec.size && x.spec.lz4 == y.spec.lz4;
+  });
+}
 
-  auto steps = std::vector<std::move_only_function<brokkr::core::Status()>>{};
+static bool all_compressed(const std::vector<Target*>& v) {
+  return std::all_of(v.begin(), v.end(), [](Target* d) { return d->init.supports_compressed_download(); });
+}
 
-  steps.emplace_back([&] {
-    spdlog::info("> Odin");
-    stage(stage_label::kHandshake);
+} // namespace
 
-    auto st = fanout_keep([&](Target& d) -> brokkr::core::Status {
-      auto& c = link(d);
-      c.set_timeout_ms(cfg.preflash_timeout_ms);
-      OdinCommands odin(c);
+brokkr::core::Result<PreparedGroup> prepare_flash(std::vector<Target*>& devs, const std::vector<ImageSpec>& sources,
+                                                  std::shared_ptr<const std::vector<std::byte>> pit_to_upload,
+                                                  const Cfg& cfg, const Ui& ui) noexcept {
+  if (devs.empty()) return brokkr::core::fail("flash: no devices");
+  for (auto* d : devs)
+    if (!d || !d->link || !d->link->connected()) return brokkr::core::fail("flash: transport not connected");
 
-      BRK_TRY(odin.handshake(cfg.preflash_retries));
-      BRK_TRYV(vr, odin.get_version(cfg.preflash_retries));
+  const bool has_pit = pit_to_upload && !pit_to_upload->empty();
+  if (sources.empty() && !has_pit) return brokkr::core::fail("flash: nothing to do (no sources, no PIT)");
 
-      d.init = vr;
-      d.proto = d.init.protocol();
-      return {};
-    });
-    if (st) spdlog::info("< Loke");
-    return st;
-  });
+  PreparedGroup g;
+  g.active = devs;
+  g.active_idx.reserve(devs.size());
+  for (std::size_t i = 0; i < devs.size(); ++i) g.active_idx.push_back(i);
+  g.total_devices = devs.size();
+  g.pit = std::move(pit_to_upload);
 
-  steps.emplace_back([&] -> brokkr::core::Status {
-    if (active.empty()) return brokkr::core::fail("No active devices");
+  auto stage = [&](std::string_view s) {
+    if (ui.on_stage) ui.on_stage(std::string(s));
+  };
 
-    pkt = choose_pkt(active, cfg);
-    stage(stage_label::kPktFlash);
+  spdlog::info("> Odin");
+  stage(stage_label::kHandshake);
+  BRK_TRY(fanout_keep(g, ui, [&](Target& d) -> brokkr::core::Status {
+    auto& c = link(d);
+    c.set_timeout_ms(cfg.preflash_timeout_ms);
+    OdinCommands odin(c);
 
-    auto st = fanout_keep([&](Target& d) -> brokkr::core::Status {
-      if (d.proto < ProtocolVersion::PROTOCOL_VER2) return {};
-      auto& c = link(d);
-      c.set_timeout_ms(cfg.preflash_timeout_ms);
-      return OdinCommands(c).setup_transfer_options(static_cast<std::int32_t>(pkt), cfg.preflash_retries);
-    });
-    if (!st) return st;
+    BRK_TRY(odin.handshake(cfg.preflash_retries));
+    BRK_TRYV(vr, odin.get_version(cfg.preflash_retries));
 
-    set_flash_timeout_active();
+    d.init = vr;
+    d.proto = d.init.protocol();
     return {};
-  });
+  }));
+  spdlog::info("< Loke");
+
+  g.pkt = choose_pkt(g.active, cfg);
+  stage(stage_label::kPktFlash);
+  BRK_TRY(fanout_keep(g, ui, [&](Target& d) -> brokkr::core::Status {
+    if (d.proto < ProtocolVersion::PROTOCOL_VER2) return {};
+    auto& c = link(d);
+    c.set_timeout_ms(cfg.preflash_timeout_ms);
+    return OdinCommands(c).setup_transfer_options(static_cast<std::int32_t>(g.pkt), cfg.preflash_retries);
+  }));
+  set_flash_timeout(g, cfg);
 
   if (has_pit) {
-    steps.emplace_back([&] {
-      spdlog::info("Uploading PIT");
-      stage(stage_label::kPitUp);
-      return fanout_keep([&](Target& d) {
-        return OdinCommands(link(d)).set_pit({pit_to_upload->data(), pit_to_upload->size()}, cfg.preflash_retries);
-      });
-    });
+    spdlog::info("Uploading PIT");
+    stage(stage_label::kPitUp);
+    BRK_TRY(fanout_keep(g, ui, [&](Target& d) {
+      return OdinCommands(link(d)).set_pit({g.pit->data(), g.pit->size()}, cfg.preflash_retries);
+    }));
   }
 
-  steps.emplace_back([&] {
-    spdlog::info("Get PIT for mapping");
-    stage(stage_label::kPitDl);
-    set_flash_timeout_active();
-
-    return fanout_keep([&](Target& d) -> brokkr::core::Status {
-      OdinCommands odin(link(d));
-      BRK_TRYV(bytes, download_pit_bytes(odin));
-      d.pit_bytes = std::move(bytes);
-      BRK_TRYV(t, pit::parse({d.pit_bytes.data(), d.pit_bytes.size()}));
-      d.pit_table = std::move(t);
-      return {};
-    });
-  });
-
-  steps.emplace_back([&] -> brokkr::core::Status {
-    if (active.empty()) return brokkr::core::fail("No active devices");
-
-    stage(stage_label::kCpuCheck);
-    const std::string ref = active.front()->pit_table.cpu_bl_id;
-    if (ref.empty()) return brokkr::core::fail("PIT cpu_bl_id missing");
-    for (auto* d : active)
-      if (d->pit_table.cpu_bl_id != ref) return brokkr::core::fail("cpu_bl_id mismatch across devices");
-    if (ui.on_model) ui.on_model(ref);
+  spdlog::info("Get PIT for mapping");
+  stage(stage_label::kPitDl);
+  set_flash_timeout(g, cfg);
+  BRK_TRY(fanout_keep(g, ui, [&](Target& d) -> brokkr::core::Status {
+    OdinCommands odin(link(d));
+    BRK_TRYV(bytes, download_pit_bytes(odin));
+    d.pit_bytes = std::move(bytes);
+    BRK_TRYV(t, pit::parse({d.pit_bytes.data(), d.pit_bytes.size()}));
+    d.pit_table = std::move(t);
     return {};
-  });
+  }));
 
-  steps.emplace_back([&] -> brokkr::core::Status {
-    spdlog::info("Verifying PIT mapping");
-    stage(stage_label::kMapCheck);
+  stage(stage_label::kCpuCheck);
+  const std::string ref = g.active.front()->pit_table.cpu_bl_id;
+  if (ref.empty()) return brokkr::core::fail("PIT cpu_bl_id missing");
+  for (auto* d : g.active)
+    if (d->pit_table.cpu_bl_id != ref) return brokkr::core::fail("cpu_bl_id mismatch across devices");
+  if (ui.on_model) ui.on_model(ref);
 
-    BRK_TRYV(eff, sources_common_mapping_or_empty(active, sources));
-    effective_sources = std::move(eff);
+  spdlog::info("Verifying PIT mapping");
+  stage(stage_label::kMapCheck);
 
-    if (effective_sources.empty() && !sources.empty())
-      spdlog::debug("No sources matched any PIT partition — nothing to flash from sources");
-    else if (effective_sources.size() < sources.size())
-      spdlog::debug("{} of {} source(s) matched PIT entries", effective_sources.size(), sources.size());
+  BRK_TRYV(eff, sources_common_mapping_or_empty(g.active, sources));
+  g.sources = std::move(eff);
 
-    BRK_TRYV(items2, map_to_pit(active.front()->pit_table, effective_sources));
-    items = std::move(items2);
+  if (g.sources.empty() && !sources.empty())
+    spdlog::debug("No sources matched any PIT partition — nothing to flash from sources");
+  else if (g.sources.size() < sources.size())
+    spdlog::debug("{} of {} source(s) matched PIT entries", g.sources.size(), sources.size());
 
-    total = 0;
-    for (const auto& it : items) BRK_TRY(detail::checked_add_u64(total, it.spec.size, "TOTALSIZE"));
+  BRK_TRYV(items, map_to_pit(g.active.front()->pit_table, g.sources));
+  g.items = std::move(items);
 
-    plan.clear();
-    plan.reserve(items.size() + (has_pit ? 1u : 0u));
+  for (const auto& it : g.items) BRK_TRY(detail::checked_add_u64(g.total, it.spec.size, "TOTALSIZE"));
 
-    if (has_pit)
-      plan.push_back(PlanItem{.kind = PlanItem::Kind::Pit,
+  g.plan.reserve(g.items.size() + (has_pit ? 1u : 0u));
+  if (has_pit)
+    g.plan.push_back(PlanItem{.kind = PlanItem::Kind::Pit,
                               .part_name = "PIT",
                               .pit_file_name = "PIT",
                               .source_base = "PIT",
-                              .size = pit_to_upload->size()});
-    for (const auto& it : items) {
-      plan.push_back(
-          PlanItem{.kind = PlanItem::Kind::Part,
-                   .part_id = it.part.id,
-                   .dev_type = it.part.dev_type,
-                   .part_name = !it.part.name.empty() ? it.part.name : it.part.file_name,
-                   .pit_file_name = it.part.file_name,
-                   .source_base = it.spec.source_basename.empty() ? it.spec.basename : it.spec.source_basename,
-                   .size = it.spec.size});
-    }
-
-    if (ui.on_plan) ui.on_plan(plan, total);
-    return {};
-  });
+                              .size = g.pit->size()});
+  for (const auto& it : g.items) {
+    g.plan.push_back(
+        PlanItem{.kind = PlanItem::Kind::Part,
+                 .part_id = it.part.id,
+                 .dev_type = it.part.dev_type,
+                 .part_name = !it.part.name.empty() ? it.part.name : it.part.file_name,
+                 .pit_file_name = it.part.file_name,
+                 .source_base = it.spec.source_basename.empty() ? it.spec.basename : it.spec.source_basename,
+                 .size = it.spec.size});
+  }
+  if (ui.on_plan) ui.on_plan(g.plan, g.total);
 
-  steps.emplace_back([&] -> brokkr::core::Status {
-    if (items.empty()) return {};
+  if (!g.items.empty()) {
     stage(stage_label::kTotalSend);
-    return fanout_keep(
-        [&](Target& d) { return OdinCommands(link(d)).send_total_size(total, d.proto, cfg.preflash_retries); });
-  });
+    BRK_TRY(fanout_keep(g, ui, [&](Target& d) {
+      return OdinCommands(link(d)).send_total_size(g.total, d.proto, cfg.preflash_retries);
+    }));
+  }
 
-  steps.emplace_back([&] -> brokkr::core::Status {
-    const bool use_lz4 = any_lz4(effective_sources) && std::all_of(active.begin(), active.end(), [](Target* d) {
-                           return d->init.supports_compressed_download();
-                         });
-
-    stage(use_lz4 ? stage_label::kFlashFast : stage_label::kFlashNorm);
-    spdlog::info("Flashing has begun!");
-
-    const std::size_t ndevs = active.size();
-    if (!ndevs) return brokkr::core::fail("No active devices");
-
-    Step cur{};
-    std::barrier sync(static_cast<std::ptrdiff_t>(ndevs + 1));
-    FirstError berr;
-    std::atomic_uint32_t failed_count{0};
-    std::vector<std::uint8_t> dead(ndevs, 0);
-
-    auto exec = [&](OdinCommands& odin, const Step& s) -> brokkr::core::Status {
-      if (s.op == Step::Op::Begin)
-        return s.comp ? odin.begin_download_compressed(static_cast<std::int32_t>(s.a))
-                      : odin.begin_download(static_cast<std::int32_t>(s.a));
-      if (s.op == Step::Op::Data) {
-        BRK_TRY(odin.send_raw({s.base + static_cast<std::ptrdiff_t>(s.off), s.n}));
-        BRK_TRYV(_, odin.recv_checked_response(static_cast<std::int32_t>(RqtCommandType::RQT_EMPTY), nullptr));
-        return {};
-      }
-      if (s.op == Step::Op::End)
-        return s.comp ? odin.end_download_compressed(static_cast<std::int32_t>(s.a), s.part_id, s.dev_type, s.last)
-                      : odin.end_download(static_cast<std::int32_t>(s.a), s.part_id, s.dev_type, s.last);
-      return {};
-    };
-
-    std::vector<std::jthread> workers;
-    workers.reserve(ndevs);
-
-    for (std::size_t i = 0; i < ndevs; ++i) {
-      auto* d = active[i];
-      const std::size_t orig = active_idx[i];
-
-      workers.emplace_back([&, d, i, orig](std::stop_token stt) {
-        OdinCommands odin(link(*d));
-        bool dead_local = false;
-
-        for (;;) {
-          sync.arrive_and_wait();
-          const Step s = cur;
-
-          const bool quit = (s.op == Step::Op::Quit) || stt.stop_requested();
-          if (!quit && !dead_local) {
-            auto rst = exec(odin, s);
-            if (!rst) {
-              dead[i] = 1;
-              failed_count.fetch_add(1, std::memory_order_relaxed);
-              const auto msg = rst.error();
-              berr.set(std::move(rst));
-              emit_devfail(ui, orig, msg);
-              dead_local = true;
-            }
-          }
+  return g;
+}
 
-          sync.arrive_and_wait();
-          if (quit) break;
-        }
-      });
+bool merge_prepared(PreparedGroup& into, PreparedGroup&& other) noexcept {
+  if (into.active.empty() || other.active.empty()) return false;
+  if (into.pkt != other.pkt || into.total != other.total) return false;
+  if ((into.pit != nullptr) != (other.pit != nullptr) || (into.pit && *into.pit != *other.pit)) return false;
+  if (all_compressed(into.active) != all_compressed(other.active)) return false;
+  if (!same_items(into.items, other.items)) return false;
+
+  for (std::size_t i = 0; i < other.active.size(); ++i) {
+    into.active.push_back(other.active[i]);
+    into.active_idx.push_back(into.total_devices + other.active_idx[i]);
+  }
+  into.total_devices += other.total_devices;
+  into.failed += other.failed;
+  if (!into.first_error) into.first_error = std::move(other.first_error);
+
+  other = PreparedGroup{};
+  return true;
+}
+
+brokkr::core::Status flash_prepared(PreparedGroup& g, const Cfg& cfg, const Ui& ui) noexcept {
+  auto finish = [&](brokkr::core::Status st) -> brokkr::core::Status {
+    if (!st) {
+      g.active.clear();
+      g.active_idx.clear();
+      g.failed = g.total_devices;
+      log_summary(g.total_devices, g.total_devices);
+      return st;
+    }
+    log_summary(g.total_devices, g.failed);
+    if (g.failed > 0 || g.first_error) {
+      return g.first_error ? brokkr::core::Status{std::unexpect, *g.first_error} : brokkr::core::Status{};
+    }
+    if (ui.on_done) ui.on_done();
+    return {};
+  };
+
+  if (g.active.empty()) return finish(brokkr::core::fail("No active devices"));
+
+  const auto& items = g.items;
+  const std::size_t pkt = g.pkt;
+  const u64 total = g.total;
+  const bool has_pit = g.pit && !g.pit->empty();
+  const bool use_lz4 =
+      cfg.compressed_download && all_compressed(g.active) && (any_lz4(g.sources) || any_sparse(g.sources));
+
+  if (ui.on_stage) ui.on_stage(std::string(use_lz4 ? stage_label::kFlashFast : stage_label::kFlashNorm));
+  spdlog::info("Flashing has begun!");
+
+  const std::size_t ndevs = g.active.size();
+  const std::size_t window = detail::window_bytes(cfg.buffer_bytes, cfg.window_packets, pkt);
+  const std::size_t decoders = decode_workers(cfg);
+  const std::size_t depth = std::max<std::size_t>(cfg.pipeline_depth, 1);
+  spdlog::debug("Stream window: {} bytes, {} LZ4 decode workers, {} windows ahead", window, decoders, depth);
+
+  g.flush.assign(g.total_devices, {});
+
+  Step cur{};
+  std::barrier sync(static_cast<std::ptrdiff_t>(ndevs + 1));
+  FirstError berr;
+  std::atomic_uint32_t failed_count{0};
+  std::vector<std::uint8_t> dead(ndevs, 0);
+
+  // dev is the device's index in the plan, the key the data_send/data_ack probes are correlated on.
+  auto exec = [&](OdinCommands& odin, const Step& s, std::size_t dev) -> brokkr::core::Status {
+    if (s.op == Step::Op::Begin)
+      return s.comp ? odin.begin_download_compressed(static_cast<std::int32_t>(s.a))
+                    : odin.begin_download(static_cast<std::int32_t>(s.a));
+    if (s.op == Step::Op::Data) {
+      BRK_TRACE(data_send, dev, s.off, s.n);
+      BRK_TRY(odin.send_raw({s.base + static_cast<std::ptrdiff_t>(s.off), s.n}));
+      auto ack = odin.recv_checked_response(static_cast<std::int32_t>(RqtCommandType::RQT_EMPTY), nullptr);
+      BRK_TRACE(data_ack, dev, ack.has_value());
+      return ack ? brokkr::core::Status{} : brokkr::core::fail(std::move(ack.error()));
     }
+    if (s.op == Step::Op::End)
+      return s.comp ? odin.end_download_compressed(static_cast<std::int32_t>(s.a), s.part_id, s.dev_type, s.last)
+                    : odin.end_download(static_cast<std::int32_t>(s.a), s.part_id, s.dev_type, s.last);
+    return {};
+  };
 
-    auto emit = [&](Step s) {
-      cur = s;
-      sync.arrive_and_wait();
-      sync.arrive_and_wait();
-    };
-
-    auto coordinator = [&]() -> brokkr::core::Status {
-      u64 overall_done = 0;
-
-      std::size_t plan_off = 0;
-      if (has_pit) {
-        if (ui.on_item_active) ui.on_item_active(0);
-        if (items.empty() && ui.on_progress) {
-          const auto n = static_cast<u64>(pit_to_upload->size());
-          ui.on_progress(0, n, 0, n);
-          ui.on_progress(n, n, n, n);
+  std::vector<std::jthread> workers;
+  workers.reserve(ndevs);
+
+  for (std::size_t i = 0; i < ndevs; ++i) {
+    auto* d = g.active[i];
+    const std::size_t orig = g.active_idx[i];
+
+    workers.emplace_back([&, d, i, orig](std::stop_token stt) {
+      OdinCommands odin(link(*d));
+      bool dead_local = false;
+      u64 wire = 0;
+
+      for (;;) {
+        sync.arrive_and_wait();
+        const Step s = cur;
+
+        const bool quit = (s.op == Step::Op::Quit) || stt.stop_requested();
+        if (!quit && !dead_local) {
+          const bool end = s.op == Step::Op::End;
+          const auto t0 = end ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+          auto rst = exec(odin, s, orig);
+          if (rst && s.op == Step::Op::Begin) wire = s.a;
+          if (rst && end) note_flush(g.flush[orig], s, wire, std::chrono::steady_clock::now() - t0);
+          if (!rst) {
+            dead[i] = 1;
+            failed_count.fetch_add(1, std::memory_order_relaxed);
+            const auto msg = rst.error();
+            berr.set(std::move(rst));
+            emit_devfail(ui, orig, msg);
+            dead_local = true;
+          }
         }
-        if (ui.on_item_done) ui.on_item_done(0);
-        plan_off = 1;
+
+        sync.arrive_and_wait();
+        if (quit) break;
       }
+    });
+  }
 
-      for (std::size_t idx = 0; idx < items.size(); ++idx) {
-        if (failed_count.load(std::memory_order_relaxed) >= ndevs) break;
-
-        const auto& item = items[idx];
-        const std::size_t plan_idx = plan_off + idx;
-
-        const std::string& file_name =
-            item.spec.source_basename.empty() ? item.spec.basename : item.spec.source_basename;
-        if (!file_name.empty()) spdlog::info("{}", file_name);
-
-        if (ui.on_item_active) ui.on_item_active(plan_idx);
-
-        const u64 item_total = item.spec.size;
-        u64 item_done = 0;
-
-        if (item.spec.lz4 && use_lz4) {
-          struct Slot {
-            std::vector<std::byte> stream;
-            u64 begin = 0, end = 0, rounded = 0;
-            bool last = false;
-            const std::byte* data() const { return stream.data(); }
-          };
-
-          BRK_TRYV(src0, item.spec.open());
-          BRK_TRYV(reader, io::Lz4BlockStreamReader::open(std::move(src0)));
-
-          const u64 total_decomp = reader.content_size();
-          if (!total_decomp) return brokkr::core::fail("LZ4 content size is zero: " + item.spec.display);
-
-          const std::size_t max_blocks = detail::lz4_nonfinal_block_limit(cfg.buffer_bytes);
-          if (!max_blocks)
-            return brokkr::core::fail("buffer_bytes too small for compressed download (needs >= 1MiB)");
-
-          u64 sent = 0;
-
-          brokkr::core::TwoSlotPrefetcher<Slot> pf(
-              [&](Slot& s, std::stop_token stt) -> brokkr::core::Result<bool> {
-                if (stt.stop_requested() || sent >= total_decomp) return false;
-
-                const u64 rem = total_decomp - sent;
-                const bool last = rem <= static_cast<u64>(max_blocks) * detail::kOneMiB;
-                const u64 decomp_sz = last ? rem : static_cast<u64>(max_blocks) * detail::kOneMiB;
-
-                const std::size_t blocks = !last ? static_cast<std::size_t>(decomp_sz / detail::kOneMiB)
-                                                 : reader.blocks_remaining_1m();
-
-                s.stream.clear();
-                s.stream.reserve(blocks * (static_cast<std::size_t>(detail::kOneMiB) + 4));
-
-                BRK_TRYV(comp, reader.read_n_blocks(blocks, s.stream));
-                const u64 comp_sz = static_cast<u64>(comp);
-                const u64 rounded_sz = detail::round_up64(comp_sz, pkt);
-
-                s.stream.resize(static_cast<std::size_t>(rounded_sz), std::byte{0});
-                s.begin = comp_sz;
-                s.end = decomp_sz;
-                s.rounded = rounded_sz;
-                s.last = last;
-
-                sent += decomp_sz;
-                return true;
-              },
-              [&](Slot& s) { s.stream.reserve(max_blocks * (static_cast<std::size_t>(detail::kOneMiB) + 4)); });
-
-          if (ui.on_progress) ui.on_progress(overall_done, total, item_done, item_total);
-
-          BRK_TRY(send_prefetched(pf, sync, cur, pkt, true, item.part.id, item.part.dev_type, total, item_total,
-                                  overall_done, item_done, ui, failed_count, ndevs, [&](const Slot& w, u64 packets) {
-                                    return [end = w.end, packets](u64 p) {
-                                      const auto c1 = ((p + 1) * end) / packets;
-                                      const auto c0 = (p * end) / packets;
-                                      return c1 - c0;
-                                    };
-                                  }));
-
-        } else {
-          struct Slot {
-            std::vector<std::byte> buf;
-            u64 begin = 0, end = 0;
-            std::size_t rounded = 0;
-            bool last = false;
-            const std::byte* data() const { return buf.data(); }
-          };
-
-          std::unique_ptr<io::ByteSource> src;
-
-          if (item.spec.lz4) {
-            BRK_TRYV(s0, item.spec.open());
-            BRK_TRYV(d0, io::open_lz4_decompressed(std::move(s0)));
-            src = std::move(d0);
-          } else {
-            BRK_TRYV(s0, item.spec.open());
-            src = std::move(s0);
-          }
+  auto emit = [&](Step s) {
+    cur = s;
+    sync.arrive_and_wait();
+    sync.arrive_and_wait();
+  };
 
-          const u64 file_sz = src->size();
-          if (!file_sz) return brokkr::core::fail("Empty source: " + item.spec.display);
-
-          const std::size_t max_rounded =
-              static_cast<std::size_t>(detail::round_up64(static_cast<u64>(cfg.buffer_bytes), static_cast<u64>(pkt)));
-          u64 sent = 0;
-
-          brokkr::core::TwoSlotPrefetcher<Slot> pf(
-              [&](Slot& s, std::stop_token stt) -> brokkr::core::Result<bool> {
-                if (stt.stop_requested() || sent >= file_sz) return false;
-
-                const u64 rem = file_sz - sent;
-                const u64 actual = std::min<u64>(rem, cfg.buffer_bytes);
-                const u64 rounded_u64 = detail::round_up64(actual, pkt);
-                const auto rounded = static_cast<std::size_t>(rounded_u64);
-
-                s.buf.resize(rounded);
-
-                auto rst = io::read_exact(*src, std::span<std::byte>(s.buf.data(), static_cast<std::size_t>(actual)));
-                if (!rst) return brokkr::core::fail(std::move(rst.error()));
-
-                if (rounded_u64 > actual)
-                  std::memset(s.buf.data() + static_cast<std::size_t>(actual), 0,
-                              rounded - static_cast<std::size_t>(actual));
-
-                s.rounded = rounded;
-                s.begin = rounded_u64;
-                s.end = actual;
-                s.last = (sent + actual >= file_sz);
-
-                sent += actual;
-                return true;
-              },
-              [&](Slot& s) { s.buf.reserve(max_rounded); });
-
-          if (ui.on_progress) ui.on_progress(overall_done, total, item_done, item_total);
-
-          BRK_TRY(send_prefetched(pf, sync, cur, pkt, false, item.part.id, item.part.dev_type, total, item_total,
-                                  overall_done, item_done, ui, failed_count, ndevs,
-                                  [&](const Slot& w, u64 /*packets*/) {
-                                    u64 rem2 = w.end;
-                                    const u64 pkt64 = static_cast<u64>(pkt);
-                                    return [rem2, pkt64](u64 /*p*/) mutable {
-                                      const u64 add = std::min<u64>(pkt64, rem2);
-                                      rem2 -= add;
-                                      return add;
-                                    };
-                                  }));
-        }
+  auto coordinator = [&]() -> brokkr::core::Status {
+    u64 overall_done = 0;
 
-        if (ui.on_item_done) ui.on_item_done(plan_idx);
+    std::size_t plan_off = 0;
+    if (has_pit) {
+      if (ui.on_item_active) ui.on_item_active(0);
+      if (items.empty() && ui.on_progress) {
+        const auto n = static_cast<u64>(g.pit->size());
+        ui.on_progress(0, n, 0, n);
+        ui.on_progress(n, n, n, n);
       }
+      if (ui.on_item_done) ui.on_item_done(0);
+      plan_off = 1;
+    }
+
+    for (std::size_t idx = 0; idx < items.size(); ++idx) {
+      if (failed_count.load(std::memory_order_relaxed) >= ndevs) break;
 
-      return {};
-    };
+      const auto& item = items[idx];
+      const std::size_t plan_idx = plan_off + idx;
 
-    auto cst = coordinator();
-    if (!cst) berr.set(std::move(cst));
+      const std::string& file_name =
+          item.spec.source_basename.empty() ? item.spec.basename : item.spec.source_basename;
+      if (!file_name.empty()) spdlog::info("{}", file_name);
 
-    emit({.op = Step::Op::Quit});
-    for (auto& t : workers)
-      if (t.joinable()) t.join();
+      if (ui.on_item_active) ui.on_item_active(plan_idx);
 
-    const std::size_t bad_in_flash = static_cast<std::size_t>(failed_count.load(std::memory_order_relaxed));
-    failed_total += bad_in_flash;
-    if (bad_in_flash) first_err.set(berr.status_or_ok());
+      const u64 item_total = item.spec.size;
+      u64 item_done = 0;
 
-    {
-      std::vector<Target*> survivors;
-      std::vector<std::size_t> survivors_idx;
-      survivors.reserve(active.size());
-      survivors_idx.reserve(active.size());
+      const bool sparse = use_lz4 && is_sparse_raw(item.spec);
+      const bool comp = (item.spec.lz4 || sparse) && use_lz4;
 
-      for (std::size_t i = 0; i < active.size(); ++i)
-        if (!dead[i]) {
-          survivors.push_back(active[i]);
-          survivors_idx.push_back(active_idx[i]);
+      auto open_windows = [&]() -> brokkr::core::Result<WindowPipe> {
+        if (sparse) {
+          BRK_TRYV(sp, io::SparseTarEntrySource::open(item.spec.path, item.spec.entry));
+          return sparse_lz4_windows(std::move(sp), window, pkt, decoders, depth, item.spec.display);
         }
-      active.swap(survivors);
-      active_idx.swap(survivors_idx);
+        BRK_TRYV(src, item.spec.open());
+        if (comp) return lz4_stream_windows(std::move(src), window, pkt, depth, item.spec.display);
+        if (item.spec.lz4) return lz4_decoded_windows(std::move(src), window, pkt, decoders, depth, item.spec.display);
+        return raw_windows(std::move(src), window, pkt, depth, item.spec.display);
+      };
+      BRK_TRYV(pf, open_windows());
+
+      if (ui.on_progress) ui.on_progress(overall_done, total, item_done, item_total);
+
+      if (comp) {
+        BRK_TRY(send_windows(pf, sync, cur, pkt, true, item.part.id, item.part.dev_type, total, item_total,
+                             overall_done, item_done, ui, failed_count, ndevs, [](const Window& w, u64 packets) {
+                               return [end = w.end, packets](u64 p) {
+                                 const auto c1 = ((p + 1) * end) / packets;
+                                 const auto c0 = (p * end) / packets;
+                                 return c1 - c0;
+                               };
+                             }));
+      } else {
+        BRK_TRY(send_windows(pf, sync, cur, pkt, false, item.part.id, item.part.dev_type, total, item_total,
+                             overall_done, item_done, ui, failed_count, ndevs, [&](const Window& w, u64 /*packets*/) {
+                               u64 rem = w.payload;
+                               const u64 pkt64 = static_cast<u64>(pkt);
+                               return [rem, pkt64](u64 /*p*/) mutable {
+                                 const u64 add = std::min<u64>(pkt64, rem);
+                                 rem -= add;
+                                 return add;
+                               };
+                             }));
+      }
+
+      if (ui.on_item_done) ui.on_item_done(plan_idx);
     }
 
     return {};
-  });
+  };
 
-  steps.emplace_back([&] -> brokkr::core::Status {
-    if (!active.empty()) {
-      auto st = shutdown_active(sm_final, final_stage(sm_final));
-      if (!st) {
-        first_err.set(st);
-        for (auto idx : active_idx) emit_devfail(ui, idx, st.error());
-        failed_total += active.size();
-        return st;
-      }
+  auto cst = coordinator();
+  if (!cst) berr.set(std::move(cst));
+
+  emit({.op = Step::Op::Quit});
+  for (auto& t : workers)
+    if (t.joinable()) t.join();
+
+  for (auto& parts : g.flush)
+    for (auto& p : parts) {
+      const auto it = std::ranges::find(items, p.part_id, [](const FlashItem& x) { return x.part.id; });
+      if (it != items.end()) p.part_name = it->part.name;
     }
-    return {};
-  });
 
-  for (auto& fn : steps) {
-    auto st = fn();
-    if (!st) return finish(st, false);
+  const std::size_t bad_in_flash = static_cast<std::size_t>(failed_count.load(std::memory_order_relaxed));
+  g.failed += bad_in_flash;
+  if (bad_in_flash) {
+    auto st = berr.status_or_ok();
+    if (!st && !g.first_error) g.first_error = st.error();
+  }
+
+  {
+    std::vector<Target*> survivors;
+    std::vector<std::size_t> survivors_idx;
+    survivors.reserve(g.active.size());
+    survivors_idx.reserve(g.active.size());
+
+    for (std::size_t i = 0; i < g.active.size(); ++i)
+      if (!dead[i]) {
+        survivors.push_back(g.active[i]);
+        survivors_idx.push_back(g.active_idx[i]);
+      }
+    g.active.swap(survivors);
+    g.active_idx.swap(survivors_idx);
   }
 
-  return finish({}, false);
+  if (!g.active.empty()) {
+    const auto sm_final = shutdown_mode_final(cfg);
+    log_shutdown_action(sm_final);
+    if (ui.on_stage) ui.on_stage(std::string(final_stage(sm_final)));
+    auto st = fanout_keep(g, ui, [&](Target& d) { return OdinCommands(link(d)).shutdown(sm_final); });
+    if (!st) {
+      if (!g.first_error) g.first_error = st.error();
+      for (auto idx : g.active_idx) emit_devfail(ui, idx, st.error());
+      g.failed += g.active.size();
+      return finish(st);
+    }
+  }
+
+  return finish({});
+}
+
+brokkr::core::Status flash(std::vector<Target*>& devs, const std::vector<ImageSpec>& sources,
+                           std::shared_ptr<const std::vector<std::byte>> pit_to_upload, const Cfg& cfg,
+                           Ui ui) noexcept {
+  auto g = prepare_flash(devs, sources, std::move(pit_to_upload), cfg, ui);
+  if (!g) {
+    log_summary(devs.size(), devs.size());
+    return brokkr::core::Status{std::unexpect, std::move(g.error())};
+  }
+  return flash_prepared(*g, cfg, ui);
 }
 
 } // namespace brokkr::odin
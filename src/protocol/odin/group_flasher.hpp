@@ -1,103 +1,158 @@
-/*
- * Copyright (c) 2026 Gabriel2392
- *
- * This program is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with this program.  If not, see <https://www.gnu.org/licenses/>.
- */
-
-#pragma once
-
-#include "core/byte_transport.hpp"
-#include "core/status.hpp"
-#include "platform/platform_all.hpp"
-#include "protocol/odin/flash.hpp"
-#include "protocol/odin/odin_cmd.hpp"
-#include "protocol/odin/pit.hpp"
-
-#include <cstddef>
-#include <cstdint>
-#include <functional>
-#include <memory>
-#include <string>
-#include <vector>
-
-namespace brokkr::odin {
-
-struct UsbTarget {
-  std::string devnode;
-  brokkr::platform::UsbFsDevice dev;
-  brokkr::platform::UsbFsConnection conn;
-
-  InitTargetInfo init{};
-  ProtocolVersion proto = ProtocolVersion::PROTOCOL_NONE;
-
-  std::vector<std::byte> pit_bytes{};
-  pit::PitTable pit_table{};
-
-  explicit UsbTarget(std::string devnode_path) : devnode(std::move(devnode_path)), dev(devnode), conn(dev) {}
-};
-
-struct Target {
-  std::string id;
-  brokkr::core::IByteTransport* link = nullptr;
-
-  InitTargetInfo init{};
-  ProtocolVersion proto = ProtocolVersion::PROTOCOL_NONE;
-
-  std::vector<std::byte> pit_bytes{};
-  pit::PitTable pit_table{};
-};
-
-struct PlanItem {
-  enum class Kind { Pit, Part };
-  Kind kind = Kind::Part;
-
-  std::int32_t part_id = -1;
-  std::int32_t dev_type = 0;
-
-  std::string part_name, pit_file_name, source_base;
-  std::uint64_t size = 0;
-};
-
-struct Cfg {
-  std::size_t buffer_bytes = 30ull * 1024 * 1024;
-  std::size_t pkt_all_v2plus = 1ull * 1024 * 1024;
-  std::size_t pkt_any_old = 128ull * 1024;
-
-  int preflash_timeout_ms = 1000;
-  unsigned preflash_retries = 2;
-
-  int flash_timeout_ms = 45'000;
-
-  bool reboot_after = true;
-};
-
-struct Ui {
-  std::function<void(std::size_t, const std::vector<std::string>&)> on_devices;
-  std::function<void(const std::string&)> on_model;
-  std::function<void(const std::string&)> on_stage;
-
-  std::function<void(const std::vector<PlanItem>&, std::uint64_t)> on_plan;
-  std::function<void(std::size_t)> on_item_active;
-  std::function<void(std::size_t)> on_item_done;
-
-  std::function<void(std::uint64_t, std::uint64_t, std::uint64_t, std::uint64_t)> on_progress;
-
-  std::function<void(const std::string&)> on_error;
-  std::function<void()> on_done;
-};
-
-brokkr::core::Status flash(std::vector<Target*>& devs, const std::vector<ImageSpec>& sources,
-                           std::shared_ptr<const std::vector<std::byte>> pit_to_upload, const Cfg& cfg, Ui ui) noexcept;
-
-} // namespace brokkr::odin
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "core/byte_transport.hpp"
+#include "core/status.hpp"
+#include "platform/platform_all.hpp"
+#include "protocol/odin/flash.hpp"
+#include "protocol/odin/odin_cmd.hpp"
+#include "protocol/odin/pit.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace brokkr::odin {
+
+struct UsbTarget {
+  std::string devnode;
+  brokkr::platform::UsbFsDevice dev;
+  brokkr::platform::UsbFsConnection conn;
+
+  InitTargetInfo init{};
+  ProtocolVersion proto = ProtocolVersion::PROTOCOL_NONE;
+
+  std::vector<std::byte> pit_bytes{};
+  pit::PitTable pit_table{};
+
+  explicit UsbTarget(std::string devnode_path) : devnode(std::move(devnode_path)), dev(devnode), conn(dev) {}
+};
+
+struct Target {
+  std::string id;
+  brokkr::core::IByteTransport* link = nullptr;
+
+  InitTargetInfo init{};
+  ProtocolVersion proto = ProtocolVersion::PROTOCOL_NONE;
+
+  std::vector<std::byte> pit_bytes{};
+  pit::PitTable pit_table{};
+};
+
+struct PlanItem {
+  enum class Kind { Pit, Part };
+  Kind kind = Kind::Part;
+
+  std::int32_t part_id = -1;
+  std::int32_t dev_type = 0;
+
+  std::string part_name, pit_file_name, source_base;
+  std::uint64_t size = 0;
+};
+
+struct Cfg {
+  std::size_t buffer_bytes = 30ull * 1024 * 1024;
+  // Non-zero: each stream window holds this many packets instead of buffer_bytes (low-memory profile).
+  std::size_t window_packets = 0;
+  // Threads decoding LZ4 on the host for devices without compressed download; 0 picks from the core count.
+  std::size_t decode_workers = 0;
+  std::size_t pkt_all_v2plus = 1ull * 1024 * 1024;
+  std::size_t pkt_any_old = 128ull * 1024;
+  // Windows read and decoded ahead of the one on the wire.
+  std::size_t pipeline_depth = 2;
+  // Off: LZ4 images are decoded on the host even for devices that accept compressed download.
+  bool compressed_download = true;
+
+  int preflash_timeout_ms = 1000;
+  unsigned preflash_retries = 2;
+
+  int flash_timeout_ms = 45'000;
+
+  bool reboot_after = true;
+};
+
+struct Ui {
+  std::function<void(std::size_t, const std::vector<std::string>&)> on_devices;
+  std::function<void(const std::string&)> on_model;
+  std::function<void(const std::string&)> on_stage;
+
+  std::function<void(const std::vector<PlanItem>&, std::uint64_t)> on_plan;
+  std::function<void(std::size_t)> on_item_active;
+  std::function<void(std::size_t)> on_item_done;
+
+  std::function<void(std::uint64_t, std::uint64_t, std::uint64_t, std::uint64_t)> on_progress;
+
+  std::function<void(const std::string&)> on_error;
+  std::function<void()> on_done;
+};
+
+brokkr::core::Status flash(std::vector<Target*>& devs, const std::vector<ImageSpec>& sources,
+                           std::shared_ptr<const std::vector<std::byte>> pit_to_upload, const Cfg& cfg, Ui ui) noexcept;
+
+// How long one device took to acknowledge end_download after the last packet of each window of a partition,
+// i.e. to commit the data to eMMC/UFS. Slow or worn storage shows up here first.
+struct PartFlush {
+  std::int32_t part_id = -1;
+  std::string part_name{};
+  std::uint64_t bytes = 0;      // written to storage, after decompression
+  std::uint64_t wire_bytes = 0; // sent over the link
+  std::size_t windows = 0;
+  std::chrono::nanoseconds flush{0};
+
+  double write_mbps() const noexcept {
+    const double s = std::chrono::duration<double>(flush).count();
+    return s > 0 ? static_cast<double>(bytes) / s / 1e6 : 0.0;
+  }
+};
+
+// flash() in two halves. The pre-flash half (handshake, packet size, PIT upload and download, cpu_bl_id and
+// mapping checks, total size) leaves the devices waiting for their first BEGIN; the data half streams the
+// images and shuts them down. Afterwards `active` holds only the devices that made it through.
+struct PreparedGroup {
+  std::vector<Target*> active;
+  std::vector<std::size_t> active_idx; // DEVFAIL indices: positions in the devs given to prepare_flash()
+  std::size_t total_devices = 0;
+  std::size_t failed = 0;
+  std::optional<brokkr::core::Error> first_error;
+
+  std::size_t pkt = 0;
+  std::vector<ImageSpec> sources; // those every device's PIT maps
+  std::vector<FlashItem> items;
+  std::vector<PlanItem> plan;
+  std::uint64_t total = 0;
+  std::shared_ptr<const std::vector<std::byte>> pit;
+
+  std::vector<std::vector<PartFlush>> flush; // by DEVFAIL index, filled by flash_prepared()
+};
+
+brokkr::core::Result<PreparedGroup> prepare_flash(std::vector<Target*>& devs, const std::vector<ImageSpec>& sources,
+                                                  std::shared_ptr<const std::vector<std::byte>> pit_to_upload,
+                                                  const Cfg& cfg, const Ui& ui) noexcept;
+brokkr::core::Status flash_prepared(PreparedGroup& g, const Cfg& cfg, const Ui& ui) noexcept;
+
+// Moves `other`'s devices into `into` when both would stream identical windows: same items, packet size, PIT
+// and compressed-download support. `other`'s indices continue after `into`'s.
+bool merge_prepared(PreparedGroup& into, PreparedGroup&& other) noexcept;
+
+} // namespace brokkr::odin
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "protocol/odin/station.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+namespace brokkr::odin {
+
+namespace {
+
+struct Batch {
+  std::vector<Target*> devs;
+  std::size_t variant = 0;
+  brokkr::core::Result<PreparedGroup> prepared{std::unexpect, "not prepared"};
+  brokkr::core::Status flashed{};
+  bool prepare_done = false;
+  bool flash_done = false;
+  std::chrono::nanoseconds data_time{0};
+  std::jthread worker;
+};
+
+using BatchPtr = std::shared_ptr<Batch>;
+
+Ui ui_for(const StationHooks& hooks, const std::vector<Target*>& devs) { return hooks.ui_for ? hooks.ui_for(devs) : Ui{}; }
+
+} // namespace
+
+StationStats run_station(const std::vector<ImageSpec>& sources, std::shared_ptr<const std::vector<std::byte>> pit,
+                         const Cfg& cfg, const StationCfg& scfg, const StationHooks& hooks,
+                         std::stop_token stop) noexcept {
+  StationStats stats;
+  std::mutex m;
+  std::condition_variable cv;
+  std::size_t events = 0; // bumped by workers and by stop, so the loop wakes before the poll interval
+
+  std::stop_callback on_stop(stop, [&] {
+    std::lock_guard s_lk(m);
+    ++events;
+    cv.notify_all();
+  });
+
+  std::list<BatchPtr> preparing; // arrival order
+  BatchPtr flashing;
+
+  auto cfg_for = [&](std::size_t variant) -> const Cfg& {
+    return scfg.variants.empty() ? cfg : scfg.variants[variant];
+  };
+  auto pick = [&](const Target& d) -> std::size_t {
+    if (scfg.variants.empty() || !hooks.variant) return 0;
+    const auto v = hooks.variant(d);
+    return v < scfg.variants.size() ? v : 0;
+  };
+
+  auto done = [&](const BatchPtr& b, const brokkr::core::Status& st, std::size_t failed) {
+    if (b->worker.joinable()) b->worker.join();
+    ++stats.batches;
+    stats.devices += b->devs.size();
+    stats.failed += failed;
+    if (!st) spdlog::error("Station batch of {} device(s): {}", b->devs.size(), st.error());
+    if (hooks.on_device_done) {
+      const PreparedGroup* g = b->flash_done ? &*b->prepared : nullptr;
+      for (std::size_t i = 0; i < b->devs.size(); ++i) {
+        DeviceOutcome o{.dev = b->devs[i], .variant = b->variant, .batch_devices = b->devs.size()};
+        if (g) {
+          o.ok = std::ranges::find(g->active_idx, i) != g->active_idx.end();
+          o.bytes = g->total;
+          o.data_time = b->data_time;
+          if (i < g->flush.size()) o.flush = g->flush[i];
+        }
+        hooks.on_device_done(o);
+      }
+    }
+    if (hooks.on_batch_done) hooks.on_batch_done(b->devs, st);
+  };
+
+  std::unique_lock lk(m);
+  for (;;) {
+    if (!stop.stop_requested() && hooks.poll) {
+      lk.unlock();
+      auto devs = hooks.poll();
+      lk.lock();
+      if (!devs.empty()) spdlog::info("Station: {} new device(s), preparing", devs.size());
+
+      std::vector<std::vector<Target*>> arms(std::max<std::size_t>(scfg.variants.size(), 1));
+      for (auto* d : devs) arms[pick(*d)].push_back(d);
+
+      for (std::size_t v = 0; v < arms.size(); ++v) {
+        if (arms[v].empty()) continue;
+        auto b = std::make_shared<Batch>();
+        b->devs = std::move(arms[v]);
+        b->variant = v;
+        b->worker = std::jthread([&, b] {
+          const auto ui = ui_for(hooks, b->devs);
+          auto g = prepare_flash(b->devs, sources, pit, cfg_for(b->variant), ui);
+          std::lock_guard g_lk(m);
+          b->prepared = std::move(g);
+          b->prepare_done = true;
+          ++events;
+          cv.notify_all();
+        });
+        preparing.push_back(std::move(b));
+      }
+    }
+
+    if (flashing && flashing->flash_done) {
+      auto b = std::move(flashing);
+      lk.unlock();
+      done(b, b->flashed, b->prepared->failed);
+      lk.lock();
+    }
+
+    for (auto it = preparing.begin(); it != preparing.end();) {
+      if (!(*it)->prepare_done || (*it)->prepared) {
+        ++it;
+        continue;
+      }
+      auto b = *it;
+      it = preparing.erase(it);
+      const brokkr::core::Status st{std::unexpect, b->prepared.error()};
+      lk.unlock();
+      done(b, st, b->devs.size());
+      lk.lock();
+    }
+
+    if (!flashing) {
+      auto first = std::find_if(preparing.begin(), preparing.end(), [](const BatchPtr& b) { return b->prepare_done; });
+      if (first != preparing.end()) {
+        auto b = *first;
+        preparing.erase(first);
+        if (b->worker.joinable()) b->worker.join();
+
+        for (auto it = preparing.begin(); it != preparing.end();) {
+          auto& o = *it;
+          const bool fits = !scfg.max_devices || b->devs.size() + o->devs.size() <= scfg.max_devices;
+          if (!o->prepare_done || o->variant != b->variant || !fits ||
+              !merge_prepared(*b->prepared, std::move(*o->prepared))) {
+            ++it;
+            continue;
+          }
+          if (o->worker.joinable()) o->worker.join();
+          b->devs.insert(b->devs.end(), o->devs.begin(), o->devs.end());
+          it = preparing.erase(it);
+        }
+
+        spdlog::info("Station: flashing {} device(s)", b->prepared->active.size());
+        b->worker = std::jthread([&, b] {
+          const auto ui = ui_for(hooks, b->devs);
+          const auto t0 = std::chrono::steady_clock::now();
+          auto st = flash_prepared(*b->prepared, cfg_for(b->variant), ui);
+          const auto dt = std::chrono::steady_clock::now() - t0;
+          std::lock_guard f_lk(m);
+          b->flashed = std::move(st);
+          b->data_time = std::chrono::duration_cast<std::chrono::nanoseconds>(dt);
+          b->flash_done = true;
+          ++events;
+          cv.notify_all();
+        });
+        flashing = std::move(b);
+      }
+    }
+
+    if (stop.stop_requested() && !flashing && preparing.empty()) break;
+    const auto seen = events;
+    cv.wait_for(lk, scfg.poll_interval, [&] { return events != seen; });
+  }
+
+  return stats;
+}
+
+} // namespace brokkr::odin
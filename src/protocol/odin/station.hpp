@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "core/status.hpp"
+#include "protocol/odin/flash.hpp"
+#include "protocol/odin/group_flasher.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stop_token>
+#include <vector>
+
+namespace brokkr::odin {
+
+// Flashing line: devices are plugged in while earlier ones are still being written. Each newly attached
+// set runs prepare_flash() on its own thread right away; prepared sets wait for the running data phase to
+// end and then start theirs. Sets that are ready together and agree on the plan are merged into one data
+// phase, so their image windows are read and decoded once.
+struct StationCfg {
+  std::chrono::milliseconds poll_interval{500};
+  std::size_t max_devices = 0; // per data phase; 0 = no limit
+  // Experiment arms. When set, StationHooks::variant assigns each new device one of them and its batch is
+  // prepared and flashed with that Cfg instead of run_station()'s; batches of different arms never merge.
+  std::vector<Cfg> variants{};
+};
+
+// How one device's session went, reported when its batch ends.
+struct DeviceOutcome {
+  Target* dev = nullptr;
+  std::size_t variant = 0;
+  bool ok = false;
+  std::uint64_t bytes = 0;               // data phase size; 0 if the batch never got there
+  std::chrono::nanoseconds data_time{0}; // wall time of that data phase
+  std::size_t batch_devices = 0;         // devices that shared it
+  std::vector<PartFlush> flush{};        // storage flush timing per partition written
+};
+
+struct StationHooks {
+  // Devices attached since the last call; they must stay valid until on_batch_done() hands them back.
+  std::function<std::vector<Target*>()> poll;
+  // Called once per batch with every device it held, whether it was flashed or failed before that.
+  std::function<void(const std::vector<Target*>&, const brokkr::core::Status&)> on_batch_done;
+  // Ui for one batch; DEVFAIL indices refer to `devs`. Prepare and data phases of different batches
+  // run concurrently, so the callbacks must be thread-safe.
+  std::function<Ui(const std::vector<Target*>& devs)> ui_for;
+  // Index into StationCfg::variants for a newly attached device; unset or out of range picks 0.
+  std::function<std::size_t(const Target&)> variant;
+  // Called for each device of a batch right before on_batch_done().
+  std::function<void(const DeviceOutcome&)> on_device_done;
+};
+
+struct StationStats {
+  std::size_t batches = 0;
+  std::size_t devices = 0;
+  std::size_t failed = 0;
+};
+
+// Runs until `stop` is requested, then finishes the batches it already holds.
+StationStats run_station(const std::vector<ImageSpec>& sources, std::shared_ptr<const std::vector<std::byte>> pit,
+                         const Cfg& cfg, const StationCfg& scfg, const StationHooks& hooks,
+                         std::stop_token stop) noexcept;
+
+} // namespace brokkr::odin
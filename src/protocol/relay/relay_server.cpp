@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "protocol/relay/relay_server.hpp"
+
+#include "protocol/relay/relay_wire.hpp"
+#include "third_party/lz4/lz4.h"
+
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+namespace brokkr::relay {
+
+namespace {
+
+brokkr::core::Status reply(brokkr::core::IByteTransport& conn, std::int32_t rc, std::span<const std::uint8_t> payload) {
+  return write_frame(conn, FrameHeader{.op = Op::Reply, .len = static_cast<std::uint32_t>(payload.size()), .arg = rc},
+                     payload);
+}
+
+brokkr::core::Status reply_text(brokkr::core::IByteTransport& conn, std::int32_t rc, std::string_view text) {
+  return reply(conn, rc, {reinterpret_cast<const std::uint8_t*>(text.data()), text.size()});
+}
+
+// Distinguishes an idle controller (socket timeout) from a closed one while waiting for the next frame.
+brokkr::core::Result<std::optional<FrameHeader>> next_frame(brokkr::core::IByteTransport& conn) noexcept {
+  HeaderBuf hb{};
+  std::size_t off = 0;
+  while (off < hb.size()) {
+    const int got = conn.recv(std::span(hb).subspan(off));
+    if (got > 0) {
+      off += static_cast<std::size_t>(got);
+      continue;
+    }
+    if (off == 0 && conn.connected()) continue;
+    if (off == 0) return std::optional<FrameHeader>{};
+    return brokkr::core::fail("relay: connection lost");
+  }
+
+  FrameHeader h;
+  if (!decode_header(hb, h)) return brokkr::core::fail("relay: bad frame header");
+  return std::optional<FrameHeader>(h);
+}
+
+} // namespace
+
+brokkr::core::Status serve_relay_session(brokkr::core::IByteTransport& conn, const RelayHooks& hooks) noexcept {
+  std::shared_ptr<brokkr::core::IByteTransport> dev;
+  std::optional<std::string> pending_err;
+
+  std::vector<std::uint8_t> buf;
+  std::vector<char> zbuf;
+
+  for (;;) {
+    BRK_TRYV(hopt, next_frame(conn));
+    if (!hopt) return {};
+    const FrameHeader h = *hopt;
+
+    switch (h.op) {
+      case Op::List: {
+        std::string text;
+        if (hooks.list)
+          for (const auto& line : hooks.list()) text += line + "\n";
+        BRK_TRY(reply_text(conn, 0, text));
+        break;
+      }
+
+      case Op::Open: {
+        std::string devnode(h.len, '\0');
+        BRK_TRY(read_full(conn, {reinterpret_cast<std::uint8_t*>(devnode.data()), devnode.size()}));
+        if (dev) {
+          BRK_TRY(reply_text(conn, -1, "device already open on this connection"));
+          break;
+        }
+        auto r = hooks.open ? hooks.open(devnode) : brokkr::core::fail("agent cannot open devices");
+        if (!r) {
+          BRK_TRY(reply_text(conn, -1, r.error()));
+          break;
+        }
+        dev = std::move(*r);
+        spdlog::info("Relay: {} attached", devnode);
+        BRK_TRY(reply_text(conn, 0, {}));
+        break;
+      }
+
+      case Op::Send: {
+        if (h.flags & kFlagLz4) {
+          zbuf.resize(h.len);
+          BRK_TRY(read_full(conn, {reinterpret_cast<std::uint8_t*>(zbuf.data()), zbuf.size()}));
+          if (h.arg < 0 || static_cast<std::uint32_t>(h.arg) > kMaxPayload) return brokkr::core::fail("relay: bad size");
+          buf.resize(static_cast<std::size_t>(h.arg));
+          const int d = LZ4_decompress_safe(zbuf.data(), reinterpret_cast<char*>(buf.data()), static_cast<int>(h.len),
+                                            h.arg);
+          if (d != h.arg) return brokkr::core::fail("relay: LZ4 payload corrupt");
+        } else {
+          buf.resize(h.len);
+          BRK_TRY(read_full(conn, buf));
+        }
+
+        if (pending_err) break;
+        if (!dev) {
+          pending_err = "no device open";
+          break;
+        }
+        for (std::size_t off = 0; off < buf.size();) {
+          const int sent = dev->send(std::span<const std::uint8_t>(buf).subspan(off));
+          if (sent <= 0) {
+            pending_err = "USB send failed";
+            break;
+          }
+          off += static_cast<std::size_t>(sent);
+        }
+        break;
+      }
+
+      case Op::Recv: {
+        if (pending_err || !dev) {
+          BRK_TRY(reply_text(conn, -1, pending_err ? *pending_err : "no device open"));
+          pending_err.reset();
+          break;
+        }
+        if (h.arg < 0 || static_cast<std::uint32_t>(h.arg) > kMaxPayload) return brokkr::core::fail("relay: bad size");
+        buf.resize(static_cast<std::size_t>(h.arg));
+        const int got = dev->recv(buf);
+        if (got < 0) {
+          BRK_TRY(reply_text(conn, got, "USB receive failed"));
+        } else {
+          BRK_TRY(reply(conn, got, std::span<const std::uint8_t>(buf).first(static_cast<std::size_t>(got))));
+        }
+        break;
+      }
+
+      case Op::RecvZlp: {
+        const int rc = dev ? dev->recv_zlp() : -1;
+        BRK_TRY(reply(conn, rc < 0 ? 0 : rc, {}));
+        break;
+      }
+
+      case Op::SetTimeout:
+        if (dev) dev->set_timeout_ms(h.arg);
+        break;
+
+      case Op::PacketHint:
+        if (dev && h.arg > 0) dev->set_packet_size_hint(static_cast<std::size_t>(h.arg));
+        break;
+
+      default: return brokkr::core::failf("relay: unknown op {}", static_cast<int>(h.op));
+    }
+  }
+}
+
+} // namespace brokkr::relay
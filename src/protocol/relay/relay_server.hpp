@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "core/byte_transport.hpp"
+#include "core/status.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace brokkr::relay {
+
+struct RelayHooks {
+  // "devnode\tsysname" per device the agent is willing to expose.
+  std::function<std::vector<std::string>()> list;
+  std::function<brokkr::core::Result<std::shared_ptr<brokkr::core::IByteTransport>>(const std::string& devnode)> open;
+};
+
+// Serves one controller connection until it disconnects; at most one device per connection.
+brokkr::core::Status serve_relay_session(brokkr::core::IByteTransport& conn, const RelayHooks& hooks) noexcept;
+
+} // namespace brokkr::relay
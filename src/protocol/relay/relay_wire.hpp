@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "core/byte_transport.hpp"
+#include "core/endian.hpp"
+#include "core/status.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace brokkr::relay {
+
+// USB-over-TCP relay between a controller (RemoteTransport) and `brokkr agent`.
+// Every frame is a 16-byte little-endian header followed by `len` payload bytes.
+// Send/SetTimeout/PacketHint are fire-and-forget; a failed Send is reported on
+// the next Reply so the controller never waits an extra round trip per packet.
+inline constexpr std::uint32_t kMagic = 0x594C5242; // "BRLY"
+inline constexpr std::uint16_t kDefaultPort = 13580;
+inline constexpr std::uint32_t kMaxPayload = 64u * 1024u * 1024u;
+
+enum class Op : std::uint8_t {
+  List = 1,       // -> Reply, payload "devnode\tsysname\n"...
+  Open = 2,       // payload devnode -> Reply
+  Send = 3,       // payload bytes (kFlagLz4: compressed, arg = raw size)
+  Recv = 4,       // arg = max bytes -> Reply with data
+  RecvZlp = 5,    // -> Reply
+  SetTimeout = 6, // arg = ms
+  PacketHint = 7, // arg = bytes
+  Reply = 0x80,   // arg = rc (< 0 on failure, payload = message)
+};
+
+inline constexpr std::uint8_t kFlagLz4 = 0x01;
+
+struct FrameHeader {
+  Op op = Op::Reply;
+  std::uint8_t flags = 0;
+  std::uint32_t len = 0;
+  std::int32_t arg = 0;
+};
+
+inline constexpr std::size_t kHeaderBytes = 16;
+using HeaderBuf = std::array<std::uint8_t, kHeaderBytes>;
+
+inline HeaderBuf encode_header(const FrameHeader& h) noexcept {
+  HeaderBuf b{};
+  const std::uint32_t magic = brokkr::core::host_to_le(kMagic);
+  const std::uint32_t len = brokkr::core::host_to_le(h.len);
+  const std::int32_t arg = brokkr::core::host_to_le(h.arg);
+  std::memcpy(b.data(), &magic, 4);
+  b[4] = static_cast<std::uint8_t>(h.op);
+  b[5] = h.flags;
+  std::memcpy(b.data() + 8, &len, 4);
+  std::memcpy(b.data() + 12, &arg, 4);
+  return b;
+}
+
+inline bool decode_header(const HeaderBuf& b, FrameHeader& out) noexcept {
+  std::uint32_t magic = 0, len = 0;
+  std::int32_t arg = 0;
+  std::memcpy(&magic, b.data(), 4);
+  std::memcpy(&len, b.data() + 8, 4);
+  std::memcpy(&arg, b.data() + 12, 4);
+  if (brokkr::core::le_to_host(magic) != kMagic) return false;
+
+  out.op = static_cast<Op>(b[4]);
+  out.flags = b[5];
+  out.len = brokkr::core::le_to_host(len);
+  out.arg = brokkr::core::le_to_host(arg);
+  return out.len <= kMaxPayload;
+}
+
+inline brokkr::core::Status read_full(brokkr::core::IByteTransport& t, std::span<std::uint8_t> out) noexcept {
+  for (std::size_t off = 0; off < out.size();) {
+    const int got = t.recv(out.subspan(off));
+    if (got <= 0) return brokkr::core::fail("relay: connection lost");
+    off += static_cast<std::size_t>(got);
+  }
+  return {};
+}
+
+inline brokkr::core::Status write_frame(brokkr::core::IByteTransport& t, const FrameHeader& h,
+                                        std::span<const std::uint8_t> payload = {}) noexcept {
+  const HeaderBuf hb = encode_header(h);
+  if (t.send(hb) != static_cast<int>(hb.size())) return brokkr::core::fail("relay: send failed");
+  // The payload goes out straight from the caller's buffer.
+  if (!payload.empty() && t.send(payload) != static_cast<int>(payload.size()))
+    return brokkr::core::fail("relay: send failed");
+  return {};
+}
+
+inline brokkr::core::Result<FrameHeader> read_frame_header(brokkr::core::IByteTransport& t) noexcept {
+  HeaderBuf hb{};
+  BRK_TRY(read_full(t, hb));
+  FrameHeader h;
+  if (!decode_header(hb, h)) return brokkr::core::fail("relay: bad frame header");
+  return h;
+}
+
+} // namespace brokkr::relay
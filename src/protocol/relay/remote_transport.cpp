@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "protocol/relay/remote_transport.hpp"
+
+#include "io/lz4_compress.hpp"
+#include "protocol/relay/relay_wire.hpp"
+
+#include <string_view>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+namespace brokkr::relay {
+
+namespace {
+
+// Local socket waits must outlive the agent's own USB timeout.
+constexpr int kTcpSlackMs = 5000;
+
+constexpr std::size_t kMinCompressBytes = 4096;
+constexpr unsigned kLz4MissLimit = 4;
+constexpr unsigned kLz4Backoff = 64;
+
+brokkr::core::Result<std::string> read_reply_text(brokkr::core::IByteTransport& t, const FrameHeader& h) noexcept {
+  std::string s(h.len, '\0');
+  BRK_TRY(read_full(t, {reinterpret_cast<std::uint8_t*>(s.data()), s.size()}));
+  return s;
+}
+
+std::span<const std::uint8_t> as_u8(std::string_view s) noexcept {
+  return {reinterpret_cast<const std::uint8_t*>(s.data()), s.size()};
+}
+
+} // namespace
+
+brokkr::core::Result<std::vector<RemoteDevice>> list_remote_devices(const std::string& host,
+                                                                    std::uint16_t port) noexcept {
+  BRK_TRYV(conn, brokkr::platform::TcpConnection::connect(host, port));
+  conn.set_timeout_ms(kTcpSlackMs);
+
+  BRK_TRY(write_frame(conn, FrameHeader{.op = Op::List}));
+  BRK_TRYV(h, read_frame_header(conn));
+  if (h.op != Op::Reply) return brokkr::core::fail("relay: unexpected frame");
+  BRK_TRYV(text, read_reply_text(conn, h));
+  if (h.arg < 0) return brokkr::core::failf("{}:{}: {}", host, port, text);
+
+  std::vector<RemoteDevice> out;
+  std::string_view rest = text;
+  while (!rest.empty()) {
+    const auto nl = rest.find('\n');
+    const std::string_view line = rest.substr(0, nl);
+    rest = nl == std::string_view::npos ? std::string_view{} : rest.substr(nl + 1);
+    if (line.empty()) continue;
+
+    const auto tab = line.find('\t');
+    out.push_back(RemoteDevice{.devnode = std::string(line.substr(0, tab)),
+                               .sysname = tab == std::string_view::npos ? std::string{}
+                                                                        : std::string(line.substr(tab + 1))});
+  }
+  return out;
+}
+
+RemoteTransport::RemoteTransport(brokkr::platform::TcpConnection conn, std::string label, bool wire_lz4)
+    : conn_(std::move(conn)), label_(std::move(label)), wire_lz4_(wire_lz4) {}
+
+brokkr::core::Result<RemoteTransport> RemoteTransport::open(const std::string& host, std::uint16_t port,
+                                                            const std::string& devnode, bool wire_lz4) noexcept {
+  BRK_TRYV(conn, brokkr::platform::TcpConnection::connect(host, port));
+  conn.set_timeout_ms(kTcpSlackMs);
+
+  BRK_TRY(write_frame(conn, FrameHeader{.op = Op::Open, .len = static_cast<std::uint32_t>(devnode.size())},
+                      as_u8(devnode)));
+  BRK_TRYV(h, read_frame_header(conn));
+  if (h.op != Op::Reply) return brokkr::core::fail("relay: unexpected frame");
+  BRK_TRYV(text, read_reply_text(conn, h));
+  if (h.arg < 0) return brokkr::core::failf("{}:{}{}: {}", host, port, devnode, text);
+
+  spdlog::debug("RemoteTransport: opened {}:{}{}", host, port, devnode);
+  return RemoteTransport(std::move(conn), fmt::format("{}:{}{}", host, port, devnode), wire_lz4);
+}
+
+void RemoteTransport::set_timeout_ms(int ms) noexcept {
+  timeout_ms_ = (ms <= 0) ? 1 : ms;
+  conn_.set_timeout_ms(timeout_ms_ + kTcpSlackMs);
+  if (!write_frame(conn_, FrameHeader{.op = Op::SetTimeout, .arg = timeout_ms_})) broken_ = true;
+}
+
+void RemoteTransport::set_packet_size_hint(std::size_t bytes) noexcept {
+  if (!write_frame(conn_, FrameHeader{.op = Op::PacketHint, .arg = static_cast<std::int32_t>(bytes)})) broken_ = true;
+}
+
+bool RemoteTransport::try_compress_(std::span<const std::uint8_t> data) noexcept {
+  if (!wire_lz4_ || data.size() < kMinCompressBytes) return false;
+  if (lz4_backoff_) {
+    --lz4_backoff_;
+    return false;
+  }
+
+  zbuf_.resize(io::lz4_compress_bound(data.size()));
+  const std::size_t c = io::lz4_compress_block(std::as_bytes(data), std::as_writable_bytes(std::span(zbuf_)));
+
+  // Already-compressed payloads (LZ4 images) do not shrink; stop trying for a while.
+  if (!c || c + c / 8 >= data.size()) {
+    if (++lz4_misses_ >= kLz4MissLimit) {
+      lz4_misses_ = 0;
+      lz4_backoff_ = kLz4Backoff;
+    }
+    return false;
+  }
+
+  lz4_misses_ = 0;
+  zbuf_.resize(c);
+  return true;
+}
+
+int RemoteTransport::send(std::span<const std::uint8_t> data, unsigned /*retries*/) {
+  if (broken_) return -1;
+
+  brokkr::core::Status st;
+  if (try_compress_(data)) {
+    st = write_frame(conn_,
+                     FrameHeader{.op = Op::Send,
+                                 .flags = kFlagLz4,
+                                 .len = static_cast<std::uint32_t>(zbuf_.size()),
+                                 .arg = static_cast<std::int32_t>(data.size())},
+                     {reinterpret_cast<const std::uint8_t*>(zbuf_.data()), zbuf_.size()});
+  } else {
+    st = write_frame(conn_, FrameHeader{.op = Op::Send, .len = static_cast<std::uint32_t>(data.size())}, data);
+  }
+
+  if (!st) {
+    spdlog::warn("RemoteTransport {}: {}", label_, st.error());
+    broken_ = true;
+    return -1;
+  }
+  return static_cast<int>(data.size());
+}
+
+brokkr::core::Result<std::int32_t> RemoteTransport::reply_(std::span<std::uint8_t> data) noexcept {
+  BRK_TRYV(h, read_frame_header(conn_));
+  if (h.op != Op::Reply) return brokkr::core::fail("relay: unexpected frame");
+
+  if (h.arg < 0) {
+    BRK_TRYV(text, read_reply_text(conn_, h));
+    spdlog::warn("RemoteTransport {}: {}", label_, text);
+    return h.arg;
+  }
+  if (h.len > data.size()) return brokkr::core::fail("relay: reply larger than requested");
+
+  BRK_TRY(read_full(conn_, data.first(h.len)));
+  return h.len ? static_cast<std::int32_t>(h.len) : h.arg;
+}
+
+int RemoteTransport::recv(std::span<std::uint8_t> data, unsigned /*retries*/) {
+  if (broken_) return -1;
+
+  auto st = write_frame(conn_, FrameHeader{.op = Op::Recv, .arg = static_cast<std::int32_t>(data.size())});
+  auto r = st ? reply_(data) : brokkr::core::Result<std::int32_t>(std::unexpect, std::move(st.error()));
+  if (!r) {
+    spdlog::warn("RemoteTransport {}: {}", label_, r.error());
+    broken_ = true;
+    return -1;
+  }
+  return *r;
+}
+
+int RemoteTransport::recv_zlp(unsigned /*retries*/) {
+  if (broken_) return -1;
+
+  auto st = write_frame(conn_, FrameHeader{.op = Op::RecvZlp});
+  auto r = st ? reply_({}) : brokkr::core::Result<std::int32_t>(std::unexpect, std::move(st.error()));
+  if (!r) {
+    broken_ = true;
+    return -1;
+  }
+  return *r;
+}
+
+} // namespace brokkr::relay
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "core/byte_transport.hpp"
+#include "core/status.hpp"
+#include "platform/platform_all.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace brokkr::relay {
+
+struct RemoteDevice {
+  std::string devnode;
+  std::string sysname;
+};
+
+brokkr::core::Result<std::vector<RemoteDevice>> list_remote_devices(const std::string& host,
+                                                                    std::uint16_t port) noexcept;
+
+// A device attached to a `brokkr agent`; behaves like the agent's local UsbFsConnection.
+class RemoteTransport final : public brokkr::core::IByteTransport {
+ public:
+  Kind kind() const noexcept override { return Kind::UsbBulk; }
+
+  static brokkr::core::Result<RemoteTransport> open(const std::string& host, std::uint16_t port,
+                                                    const std::string& devnode, bool wire_lz4 = false) noexcept;
+
+  RemoteTransport(RemoteTransport&&) noexcept = default;
+  RemoteTransport& operator=(RemoteTransport&&) noexcept = default;
+
+  bool connected() const noexcept override { return !broken_ && conn_.connected(); }
+
+  void set_timeout_ms(int ms) noexcept override;
+  int timeout_ms() const noexcept override { return timeout_ms_; }
+  void set_packet_size_hint(std::size_t bytes) noexcept override;
+
+  int send(std::span<const std::uint8_t> data, unsigned retries = 8) override;
+  int recv(std::span<std::uint8_t> data, unsigned retries = 8) override;
+  int recv_zlp(unsigned retries = 0) override;
+
+  const std::string& label() const noexcept { return label_; }
+
+ private:
+  RemoteTransport(brokkr::platform::TcpConnection conn, std::string label, bool wire_lz4);
+
+  brokkr::core::Result<std::int32_t> reply_(std::span<std::uint8_t> data) noexcept;
+  bool try_compress_(std::span<const std::uint8_t> data) noexcept;
+
+ private:
+  brokkr::platform::TcpConnection conn_;
+  std::string label_;
+  int timeout_ms_ = 1000;
+  bool broken_ = false;
+
+  bool wire_lz4_ = false;
+  std::vector<char> zbuf_;
+  unsigned lz4_misses_ = 0;
+  unsigned lz4_backoff_ = 0;
+};
+
+} // namespace brokkr::relay
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "core/byte_transport.hpp"
+#include "core/endian.hpp"
+#include "protocol/odin/odin_wire.hpp"
+#include "protocol/odin/pit.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+// In-memory Odin bootloader for tests and benchmarks. Speaks enough of the protocol for
+// OdinCommands/flash(): handshake, INIT, PIT get/set, XMIT (plain and compressed) and CLOSE.
+namespace brokkr::testing {
+
+struct FakePart {
+  std::int32_t id = 0;
+  std::int32_t dev_type = 2;
+  std::string name;
+  std::string file_name;
+};
+
+inline std::vector<std::byte> make_pit(const std::string& cpu_bl_id, const std::vector<FakePart>& parts) {
+  using namespace brokkr::odin::pit;
+  std::vector<std::byte> out(sizeof(PitHeaderWire) + parts.size() * sizeof(PartitionInfoWire));
+
+  PitHeaderWire h{};
+  h.magic = brokkr::core::host_to_le(PIT_MAGIC);
+  h.count = brokkr::core::host_to_le(static_cast<std::int32_t>(parts.size()));
+  std::memcpy(h.cpu_bl_id, cpu_bl_id.data(), std::min(cpu_bl_id.size(), sizeof(h.cpu_bl_id)));
+  std::memcpy(out.data(), &h, sizeof(h));
+
+  for (std::size_t i = 0; i < parts.size(); ++i) {
+    PartitionInfoWire w{};
+    w.id = brokkr::core::host_to_le(parts[i].id);
+    w.devType = brokkr::core::host_to_le(parts[i].dev_type);
+    w.offset = brokkr::core::host_to_le(static_cast<std::int32_t>(i * 0x10000));
+    w.blockLength = brokkr::core::host_to_le(0x10000);
+    std::memcpy(w.name, parts[i].name.data(), std::min(parts[i].name.size(), sizeof(w.name) - 1));
+    std::memcpy(w.fileName, parts[i].file_name.data(), std::min(parts[i].file_name.size(), sizeof(w.fileName) - 1));
+    std::memcpy(out.data() + sizeof(h) + i * sizeof(w), &w, sizeof(w));
+  }
+  return out;
+}
+
+class FakeOdin final : public brokkr::core::IByteTransport {
+ public:
+  struct Written {
+    std::int32_t part_id = 0;
+    std::int64_t size = 0;
+    bool compressed = false;
+    bool last = false;
+  };
+
+  explicit FakeOdin(std::vector<std::byte> pit = {}) : pit_(std::move(pit)) {}
+
+  Kind kind() const noexcept override { return Kind::UsbBulk; }
+  bool connected() const noexcept override { return true; }
+  void set_timeout_ms(int ms) noexcept override { timeout_ms_ = ms; }
+  int timeout_ms() const noexcept override { return timeout_ms_; }
+
+  int send(std::span<const std::uint8_t> data, unsigned = 8) override {
+    std::lock_guard lk(mtx_);
+    if (fail_sends) return -1;
+
+    if (!data_left_ && data.size() == sizeof(brokkr::odin::RequestBox)) {
+      request_(data);
+    } else if (!data_left_ && !pit_upload_ && data.size() >= 4 && data.size() <= 5 &&
+               std::memcmp(data.data(), "ODIN", 4) == 0) {
+      queue_.insert(queue_.end(), {'L', 'O', 'K', 'E'});
+    } else if (pit_upload_) {
+      pit_.assign(reinterpret_cast<const std::byte*>(data.data()),
+                  reinterpret_cast<const std::byte*>(data.data()) + data.size());
+      pit_upload_ = false;
+      respond_(static_cast<std::int32_t>(brokkr::odin::RqtCommandType::RQT_PIT), 0);
+    } else {
+      data_bytes += data.size();
+      data_left_ -= std::min<std::int64_t>(data_left_, static_cast<std::int64_t>(data.size()));
+      if (keep_data) received.insert(received.end(), data.begin(), data.end());
+      if (usb_bytes_per_sec) {
+        const auto us = static_cast<std::int64_t>(data.size() * 1'000'000ull / usb_bytes_per_sec);
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+      }
+      respond_(0, 0);
+    }
+    return static_cast<int>(data.size());
+  }
+
+  int recv(std::span<std::uint8_t> data, unsigned = 8) override {
+    std::lock_guard lk(mtx_);
+    if (queue_.empty()) return -1;
+    const std::size_t n = std::min(data.size(), queue_.size());
+    std::copy_n(queue_.begin(), n, data.begin());
+    queue_.erase(queue_.begin(), queue_.begin() + static_cast<std::ptrdiff_t>(n));
+    return static_cast<int>(n);
+  }
+
+  int recv_zlp(unsigned = 0) override { return 0; }
+
+  // Knobs, set before use.
+  std::int32_t ack_word = 0x00058000; // protocol v5, compressed download
+  std::uint64_t usb_bytes_per_sec = 0;
+  std::chrono::microseconds flush_latency{0};
+  bool keep_data = false;
+  bool fail_sends = false;
+
+  // Observations.
+  std::uint64_t data_bytes = 0;
+  std::vector<std::uint8_t> received;
+  std::vector<Written> written;
+  bool closed = false;
+
+ private:
+  void request_(std::span<const std::uint8_t> raw) {
+    using brokkr::odin::RqtCommandParam;
+    using brokkr::odin::RqtCommandType;
+
+    brokkr::odin::RequestBox rq{};
+    std::memcpy(&rq, raw.data(), sizeof(rq));
+    const auto type = static_cast<RqtCommandType>(brokkr::core::le_to_host(rq.id));
+    const auto param = static_cast<RqtCommandParam>(brokkr::core::le_to_host(rq.data));
+    auto arg = [&](std::size_t i) { return brokkr::core::le_to_host(rq.intData[i]); };
+    const auto id = static_cast<std::int32_t>(type);
+
+    switch (type) {
+      case RqtCommandType::RQT_INIT:
+        respond_(id, param == RqtCommandParam::RQT_INIT_TARGET ? ack_word : 0);
+        return;
+
+      case RqtCommandType::RQT_PIT:
+        if (param == RqtCommandParam::RQT_PIT_SET) {
+          pit_set_ = true;
+          respond_(id, 0);
+        } else if (param == RqtCommandParam::RQT_PIT_GET) {
+          respond_(id, static_cast<std::int32_t>(pit_.size()));
+        } else if (param == RqtCommandParam::RQT_PIT_START && pit_set_) {
+          pit_upload_ = true;
+          respond_(id, 0);
+        } else if (param == RqtCommandParam::RQT_PIT_START) {
+          const auto off = std::min<std::size_t>(static_cast<std::size_t>(arg(0)) * 500, pit_.size());
+          const auto n = std::min<std::size_t>(500, pit_.size() - off);
+          for (std::size_t i = 0; i < n; ++i) queue_.push_back(static_cast<std::uint8_t>(pit_[off + i]));
+        } else {
+          pit_set_ = false;
+          respond_(id, 0);
+        }
+        return;
+
+      case RqtCommandType::RQT_XMIT:
+        if (param == RqtCommandParam::RQT_XMIT_START || param == RqtCommandParam::RQT_XMIT_COMPRESSED_START) {
+          data_left_ = arg(0);
+        } else if (param == RqtCommandParam::RQT_XMIT_COMPLETE ||
+                   param == RqtCommandParam::RQT_XMIT_COMPRESSED_COMPLETE) {
+          if (flush_latency.count()) std::this_thread::sleep_for(flush_latency);
+          written.push_back(Written{.part_id = arg(4),
+                                    .size = arg(1),
+                                    .compressed = param == RqtCommandParam::RQT_XMIT_COMPRESSED_COMPLETE,
+                                    .last = arg(5) != 0});
+        }
+        respond_(id, 0);
+        return;
+
+      case RqtCommandType::RQT_CLOSE:
+        closed = true;
+        respond_(id, 0);
+        return;
+
+      default: respond_(-1, -1);
+    }
+  }
+
+  void respond_(std::int32_t id, std::int32_t ack) {
+    const brokkr::odin::ResponseBox r{brokkr::core::host_to_le(id), brokkr::core::host_to_le(ack)};
+    const auto* p = reinterpret_cast<const std::uint8_t*>(&r);
+    queue_.insert(queue_.end(), p, p + sizeof(r));
+  }
+
+  std::mutex mtx_;
+  std::deque<std::uint8_t> queue_;
+  std::vector<std::byte> pit_;
+  std::int64_t data_left_ = 0;
+  bool pit_set_ = false;
+  bool pit_upload_ = false;
+  int timeout_ms_ = 1000;
+};
+
+} // namespace brokkr::testing
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "platform/linux/block_storage.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using brokkr::linux::StorageKind;
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+// A sysfs-shaped tree whose dev/block/<maj>:<min> entry matches the filesystem holding `file`.
+struct FakeTree {
+  fs::path root;
+  fs::path sys;
+  fs::path file;
+  fs::path link;
+
+  FakeTree() {
+    root = fs::temp_directory_path() / ("brokkr-block-" + std::to_string(::getpid()));
+    fs::remove_all(root);
+    sys = root / "sys";
+    fs::create_directories(sys / "dev" / "block");
+    file = root / "AP.tar.md5";
+    std::ofstream(file) << "x";
+
+    struct stat st {};
+    ::stat(file.c_str(), &st);
+    link = sys / "dev" / "block" / (std::to_string(major(st.st_dev)) + ":" + std::to_string(minor(st.st_dev)));
+  }
+  ~FakeTree() {
+    std::error_code ec;
+    fs::remove_all(root, ec);
+  }
+
+  // `rel` is the disk under sys/devices; with `part`, the entry points at its first partition.
+  void disk(const std::string& rel, const char* rotational, const char* nr_requests, bool part) const {
+    const auto d = sys / "devices" / rel;
+    fs::create_directories(d / "queue");
+    std::ofstream(d / "queue" / "rotational") << rotational << "\n";
+    if (nr_requests) std::ofstream(d / "queue" / "nr_requests") << nr_requests << "\n";
+
+    auto target = d;
+    if (part) {
+      target = d / (d.filename().string() + "1");
+      fs::create_directories(target);
+      std::ofstream(target / "partition") << "1\n";
+    }
+    std::error_code ec;
+    fs::remove(link, ec);
+    fs::create_symlink(target, link);
+  }
+};
+
+static void test_nvme_partition() {
+  FakeTree t;
+  t.disk("pci0000:00/0000:00:1d.0/nvme/nvme0/nvme0n1", "0", "1023", true);
+
+  const auto s = brokkr::linux::storage_info(t.file, t.sys);
+  if (s.kind != StorageKind::Solid) return fail_msg("nvme", "expected solid-state");
+  if (s.name != "nvme0n1" || s.usb || s.queue_depth != 1023) return fail_msg("nvme", "wrong disk: " + s.name);
+  if (!s.device) return fail_msg("nvme", "device id missing");
+  pass();
+}
+
+static void test_usb_rotational() {
+  FakeTree t;
+  t.disk("pci0000:00/0000:00:14.0/usb2/2-1/2-1:1.0/host6/target6:0:0/6:0:0:0/block/sdb", "1", nullptr, false);
+
+  const auto s = brokkr::linux::storage_info(t.file, t.sys);
+  if (s.kind != StorageKind::Rotational || !s.usb) return fail_msg("usb", "expected a USB spinning disk");
+  if (s.name != "sdb" || s.queue_depth != 0) return fail_msg("usb", "wrong disk: " + s.name);
+  pass();
+}
+
+static void test_no_block_device() {
+  FakeTree t;
+
+  const auto s = brokkr::linux::storage_info(t.file, t.sys);
+  if (s.kind != StorageKind::Unknown || !s.name.empty()) return fail_msg("none", "expected unknown storage");
+  if (!s.device) return fail_msg("none", "device id should still be set");
+  if (brokkr::linux::storage_info(t.root / "missing", t.sys).device) return fail_msg("none", "missing file has an id");
+  pass();
+}
+
+int main() {
+  test_nvme_partition();
+  test_usb_rotational();
+  test_no_block_device();
+
+  std::printf("block_storage: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}
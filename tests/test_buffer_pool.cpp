@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "core/buffer_pool.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+static void test_reuse_best_fit() {
+  brokkr::core::BufferPool pool(1u << 20);
+
+  auto small = pool.take(1000);
+  auto big = pool.take(100000);
+  const auto* small_ptr = small.data();
+  const auto* big_ptr = big.data();
+  pool.give(std::move(big));
+  pool.give(std::move(small));
+
+  auto a = pool.take(500);
+  if (a.data() != small_ptr) return fail_msg("best_fit", "small request did not reuse the small buffer");
+  if (!a.empty()) return fail_msg("best_fit", "reused buffer not cleared");
+  auto b = pool.take(50000);
+  if (b.data() != big_ptr) return fail_msg("best_fit", "large request did not reuse the large buffer");
+  if (pool.retained_bytes() != 0) return fail_msg("best_fit", "pool should be empty");
+  pass();
+}
+
+static void test_retention_cap() {
+  brokkr::core::BufferPool pool(150000);
+
+  std::vector<std::vector<std::byte>> bufs;
+  for (int i = 0; i < 3; ++i) bufs.push_back(pool.take(60000));
+  for (auto& b : bufs) pool.give(std::move(b));
+  if (pool.retained_bytes() > 150000) return fail_msg("retention_cap", "cap exceeded");
+  if (pool.retained_bytes() < 120000) return fail_msg("retention_cap", "dropped more than needed");
+
+  pool.give(pool.take(1u << 20));
+  if (pool.retained_bytes() > 150000) return fail_msg("retention_cap", "oversized buffer retained");
+
+  pool.set_max_retained(0);
+  if (pool.retained_bytes() != 0) return fail_msg("retention_cap", "shrinking the cap did not trim");
+  pass();
+}
+
+static void test_pooled_bytes_returns() {
+  auto& pool = brokkr::core::buffer_pool();
+  pool.set_max_retained(1u << 20);
+  const auto before = pool.retained_bytes();
+  {
+    brokkr::core::PooledBytes b(4096);
+    b->resize(4096);
+    brokkr::core::PooledBytes moved = std::move(b);
+    if (moved->size() != 4096) return fail_msg("pooled_bytes", "move lost contents");
+  }
+  if (pool.retained_bytes() < before + 4096) return fail_msg("pooled_bytes", "buffer not returned on destruction");
+  pass();
+}
+
+int main() {
+  test_reuse_best_fit();
+  test_retention_cap();
+  test_pooled_bytes_returns();
+
+  std::printf("buffer_pool: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}
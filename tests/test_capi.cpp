@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "brokkr.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+static std::vector<brokkr_event> drain(brokkr_ctx* ctx) {
+  std::vector<brokkr_event> out;
+  brokkr_event buf[16];
+  for (;;) {
+    const std::size_t n = brokkr_poll(ctx, buf, 16);
+    out.insert(out.end(), buf, buf + n);
+    if (n < 16) return out;
+  }
+}
+
+static const brokkr_event* job_done(const std::vector<brokkr_event>& evs, brokkr_handle job) {
+  for (const auto& e : evs)
+    if (e.job == job && e.type == BROKKR_EVENT_JOB_DONE) return &e;
+  return nullptr;
+}
+
+static void test_prepare_cached(brokkr_ctx* ctx, const fs::path& dir) {
+  const auto img = dir / "boot.img";
+  std::ofstream(img, std::ios::binary) << std::string(4096, 'x');
+  const std::string path = img.string();
+  const char* inputs[] = {path.c_str()};
+
+  brokkr_handle job = 0;
+  if (brokkr_prepare(ctx, inputs, 1, nullptr, &job) != BROKKR_OK || !job)
+    return fail_msg("prepare", "start failed");
+  brokkr_handle pkg = 0;
+  if (brokkr_job_wait(ctx, job, -1, &pkg) != BROKKR_OK || !pkg)
+    return fail_msg("prepare", std::string("job failed: ") + brokkr_last_error());
+
+  const auto evs = drain(ctx);
+  const auto* done = job_done(evs, job);
+  if (!done || done->status != BROKKR_OK || done->a != pkg) return fail_msg("prepare", "missing JOB_DONE event");
+
+  brokkr_handle job2 = 0, pkg2 = 0;
+  if (brokkr_prepare(ctx, inputs, 1, nullptr, &job2) != BROKKR_OK) return fail_msg("prepare", "second start failed");
+  if (brokkr_job_wait(ctx, job2, -1, &pkg2) != BROKKR_OK) return fail_msg("prepare", "second job failed");
+  if (job2 == job || pkg2 != pkg) return fail_msg("prepare", "unchanged package was not reused");
+  drain(ctx);
+
+  std::size_t needed = 0;
+  char small[4];
+  if (brokkr_package_info(ctx, pkg, small, sizeof(small), &needed) != BROKKR_ERR_BUFFER || needed <= sizeof(small))
+    return fail_msg("prepare", "short buffer not reported");
+  std::string info(needed, '\0');
+  if (brokkr_package_info(ctx, pkg, info.data(), info.size(), nullptr) != BROKKR_OK)
+    return fail_msg("prepare", "package_info failed");
+  if (info.find("\"boot.img\"") == std::string::npos || info.find("4096") == std::string::npos)
+    return fail_msg("prepare", "package_info: " + info);
+
+  if (brokkr_package_release(ctx, pkg) != BROKKR_OK) return fail_msg("prepare", "release failed");
+  if (brokkr_package_info(ctx, pkg, info.data(), info.size(), nullptr) != BROKKR_ERR_INVALID)
+    return fail_msg("prepare", "released package still known");
+  pass();
+}
+
+static void test_prepare_missing(brokkr_ctx* ctx, const fs::path& dir) {
+  const std::string path = (dir / "missing.img").string();
+  const char* inputs[] = {path.c_str()};
+
+  brokkr_handle job = 0;
+  if (brokkr_prepare(ctx, inputs, 1, nullptr, &job) != BROKKR_OK) return fail_msg("missing", "start failed");
+  if (brokkr_job_wait(ctx, job, -1, nullptr) != BROKKR_ERR_FAILED) return fail_msg("missing", "job succeeded");
+  if (!*brokkr_last_error()) return fail_msg("missing", "no error message");
+
+  const auto evs = drain(ctx);
+  const auto* done = job_done(evs, job);
+  if (!done || done->status != BROKKR_ERR_FAILED || !done->text[0]) return fail_msg("missing", "bad JOB_DONE event");
+  pass();
+}
+
+static void test_flash_without_device(brokkr_ctx* ctx, const fs::path& dir) {
+  const std::string path = (dir / "boot.img").string();
+  const char* inputs[] = {path.c_str()};
+
+  brokkr_handle job = 0, pkg = 0;
+  if (brokkr_prepare(ctx, inputs, 1, nullptr, &job) != BROKKR_OK || brokkr_job_wait(ctx, job, -1, &pkg) != BROKKR_OK)
+    return fail_msg("flash", "prepare failed");
+
+  brokkr_flash_options opts{};
+  opts.struct_size = sizeof(opts);
+  opts.package = pkg;
+  opts.target = "brokkr-test-nonexistent";
+  if (brokkr_flash(ctx, &opts, &job) != BROKKR_OK) return fail_msg("flash", "start failed");
+  if (brokkr_job_wait(ctx, job, -1, nullptr) != BROKKR_ERR_FAILED) return fail_msg("flash", "flash succeeded");
+
+  opts.package = 0;
+  if (brokkr_flash(ctx, &opts, &job) != BROKKR_ERR_INVALID) return fail_msg("flash", "unknown package accepted");
+  opts.package = pkg;
+  opts.struct_size = 1;
+  if (brokkr_flash(ctx, &opts, &job) != BROKKR_ERR_INVALID) return fail_msg("flash", "short struct accepted");
+  drain(ctx);
+  pass();
+}
+
+static void test_invalid(brokkr_ctx* ctx) {
+  if (brokkr_abi_version() != BROKKR_ABI_VERSION) return fail_msg("invalid", "ABI version mismatch");
+  if (brokkr_job_wait(ctx, 987654, 0, nullptr) != BROKKR_ERR_INVALID) return fail_msg("invalid", "unknown job");
+  brokkr_handle job = 0;
+  if (brokkr_prepare(ctx, nullptr, 0, nullptr, &job) != BROKKR_ERR_INVALID) return fail_msg("invalid", "empty prepare");
+
+  std::size_t needed = 0;
+  if (brokkr_list_devices(ctx, nullptr, 0, &needed) != BROKKR_ERR_BUFFER || needed < 3)
+    return fail_msg("invalid", "list_devices size query");
+  std::string devs(needed, '\0');
+  if (brokkr_list_devices(ctx, devs.data(), devs.size(), nullptr) != BROKKR_OK || devs[0] != '[')
+    return fail_msg("invalid", "list_devices");
+  pass();
+}
+
+int main() {
+  const auto dir = fs::temp_directory_path() / ("brokkr-capi-" + std::to_string(::getpid()));
+  fs::remove_all(dir);
+  fs::create_directories(dir / "cache");
+  ::setenv("XDG_CACHE_HOME", (dir / "cache").c_str(), 1);
+
+  brokkr_set_log_level(6);
+  brokkr_ctx* ctx = brokkr_create(0);
+  if (!ctx) {
+    std::fprintf(stderr, "brokkr_create: %s\n", brokkr_last_error());
+    return 1;
+  }
+
+  test_invalid(ctx);
+  test_prepare_cached(ctx, dir);
+  test_prepare_missing(ctx, dir);
+  test_flash_without_device(ctx, dir);
+
+  brokkr_destroy(ctx);
+
+  std::error_code ec;
+  fs::remove_all(dir, ec);
+
+  std::printf("capi: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app/experiment.hpp"
+#include "core/stats.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using brokkr::app::ExperimentTrial;
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+static bool near(double a, double b, double eps = 1e-3) { return std::fabs(a - b) <= eps; }
+
+constexpr std::string_view kConfig = R"({
+  "name": "pkt/2026",
+  "variants": [
+    {"name": "control"},
+    {"name": "small", "packet_kib": 512, "window_mib": 8, "weight": 3},
+    {"name": "deep", "pipeline_depth": 4, "compression": false}
+  ]
+})";
+
+static void test_parse() {
+  auto e = brokkr::app::parse_experiment(kConfig);
+  if (!e) return fail_msg("parse", e.error());
+  if (e->name != "pkt/2026" || e->variants.size() != 3) return fail_msg("parse", "wrong shape");
+
+  brokkr::odin::Cfg base;
+  base.window_packets = 16;
+  const auto c0 = e->variants[0].apply(base);
+  const auto c1 = e->variants[1].apply(base);
+  const auto c2 = e->variants[2].apply(base);
+  if (c0.pkt_all_v2plus != base.pkt_all_v2plus || c0.window_packets != 16) return fail_msg("parse", "control changed");
+  if (c1.pkt_all_v2plus != 512 * 1024 || c1.buffer_bytes != 8 * 1024 * 1024 || c1.window_packets != 0)
+    return fail_msg("parse", "packet/window not applied");
+  if (c2.pipeline_depth != 4 || c2.compressed_download || c2.pkt_all_v2plus != base.pkt_all_v2plus)
+    return fail_msg("parse", "depth/compression not applied");
+
+  for (const char* bad : {R"({"variants": [{"name": "a"}]})", R"({"name": "x", "variants": []})",
+                          R"({"name": "x", "variants": [{"name": "a"}, {"name": "a"}]})",
+                          R"({"name": "x", "variants": [{"name": "a", "packet_kib": 0}]})",
+                          R"({"name": "x", "variants": [{"name": "a", "weight": -1}]})",
+                          R"({"name": "x", "variants": [{"name": "a", "compression": "no"}]})"}) {
+    if (brokkr::app::parse_experiment(bad)) return fail_msg("parse", std::string("accepted ") + bad);
+  }
+  pass();
+}
+
+static void test_picker() {
+  auto e = brokkr::app::parse_experiment(kConfig);
+  if (!e) return fail_msg("picker", e.error());
+
+  brokkr::app::VariantPicker p1(*e, 42), p2(*e, 42);
+  std::array<int, 3> hits{};
+  for (int i = 0; i < 5000; ++i) {
+    const auto v = p1.pick();
+    if (v != p2.pick()) return fail_msg("picker", "same seed, different assignment");
+    if (v >= hits.size()) return fail_msg("picker", "index out of range");
+    ++hits[v];
+  }
+  // Weights 1:3:1.
+  if (hits[1] < 2700 || hits[1] > 3300 || hits[0] < 800 || hits[2] < 800)
+    return fail_msg("picker", "assignment does not follow the weights");
+  pass();
+}
+
+static void test_stats() {
+  brokkr::core::RunningStats s;
+  for (double x : {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0}) s.add(x);
+  if (s.n != 8 || !near(s.mean, 5.0) || !near(s.variance(), 32.0 / 7.0)) return fail_msg("stats", "welford");
+
+  const auto ci = brokkr::core::mean_ci95(s);
+  const double h = 2.365 * std::sqrt(32.0 / 7.0 / 8.0);
+  if (!near(ci.lo, 5.0 - h) || !near(ci.hi, 5.0 + h)) return fail_msg("stats", "t interval");
+
+  const auto w = brokkr::core::wilson95(0, 20);
+  if (!near(w.lo, 0) || !near(w.hi, 0.1611, 1e-3)) return fail_msg("stats", "wilson at zero");
+  const auto w2 = brokkr::core::wilson95(5, 10);
+  if (!near(w2.lo + w2.hi, 1.0) || w2.lo > 0.24 || w2.lo < 0.23) return fail_msg("stats", "wilson at half");
+  pass();
+}
+
+static void test_store_and_report() {
+  const fs::path dir = fs::temp_directory_path() / ("brokkr-experiment-" + std::to_string(::getpid()));
+  const auto file = brokkr::app::experiment_results_file(dir, "pkt/2026");
+  if (file.filename() != "pkt_2026.jsonl") return fail_msg("store", "name not made file-safe");
+
+  auto e = brokkr::app::parse_experiment(kConfig);
+  if (!e) return fail_msg("store", e.error());
+
+  // control: 40 MB/s +-1; small: 30 MB/s +-1 with one failure; deep: one session only.
+  std::vector<ExperimentTrial> in;
+  for (int i = 0; i < 6; ++i) {
+    const double mbps = 40 + (i % 2 ? 1 : -1);
+    in.push_back({.time = i, .variant = "control", .cpu_bl_id = i < 3 ? "S911B" : "A546B", .ok = true,
+                  .bytes = 100'000'000, .seconds = 100.0 / mbps, .batch_devices = 1});
+  }
+  for (int i = 0; i < 6; ++i) {
+    const double mbps = 30 + (i % 2 ? 1 : -1);
+    in.push_back({.time = i, .variant = "small", .cpu_bl_id = "S911B", .ok = i != 5, .bytes = 100'000'000,
+                  .seconds = 100.0 / mbps, .batch_devices = 2});
+  }
+  in.push_back({.time = 9, .variant = "deep", .cpu_bl_id = "S911B", .ok = true, .bytes = 1, .seconds = 1});
+  in.push_back({.time = 9, .variant = "gone", .cpu_bl_id = "S911B", .ok = false});
+
+  for (const auto& t : in) {
+    if (auto st = brokkr::app::append_experiment_trial(file, t); !st) return fail_msg("store", st.error());
+  }
+  {
+    std::ofstream torn(file, std::ios::app);
+    torn << "{\"t\": 10, \"variant\": \"con";
+  }
+
+  auto out = brokkr::app::load_experiment_trials(file);
+  std::error_code ec;
+  fs::remove_all(dir, ec);
+  if (!out) return fail_msg("store", out.error());
+  if (out->size() != in.size()) return fail_msg("store", "wrong number of trials read back");
+  if ((*out)[7].cpu_bl_id != "S911B" || (*out)[7].batch_devices != 2 || (*out)[7].ok != true ||
+      !near((*out)[7].seconds, in[7].seconds, 1e-9))
+    return fail_msg("store", "trial fields not round-tripped");
+
+  const auto rows = brokkr::app::summarize_experiment(*e, *out);
+  if (rows.size() != 3) return fail_msg("report", "one row per variant expected");
+  if (rows[0].sessions != 6 || rows[0].failures || !near(rows[0].mbps.mean, 40.0, 1e-6))
+    return fail_msg("report", "control row");
+  if (rows[1].sessions != 6 || rows[1].failures != 1 || rows[1].mbps.n != 5) return fail_msg("report", "small row");
+  if (!rows[1].vs_control || rows[1].vs_control->hi >= 0) return fail_msg("report", "slower arm not flagged slower");
+  if (rows[2].vs_control) return fail_msg("report", "difference from a single sample");
+  if (rows[0].mbps_ci.lo >= 40 || rows[0].mbps_ci.hi <= 40) return fail_msg("report", "CI does not cover the mean");
+
+  const auto bl = brokkr::app::summarize_experiment(*e, *out, "A546B");
+  if (bl[0].sessions != 3 || bl[1].sessions != 0) return fail_msg("report", "cpu_bl_id filter");
+
+  const auto text = brokkr::app::format_experiment_report(*e, *out);
+  for (const char* want : {"control", "small", "deep", "cpu_bl_id A546B", "cpu_bl_id S911B", "(control)"}) {
+    if (text.find(want) == std::string::npos) return fail_msg("report", std::string("missing ") + want);
+  }
+  if (text.find("gone") != std::string::npos) return fail_msg("report", "reported a variant not in the config");
+  pass();
+}
+
+int main() {
+  test_parse();
+  test_picker();
+  test_stats();
+  test_store_and_report();
+
+  std::printf("experiment: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app/flush_fingerprint.hpp"
+#include "fake_odin.hpp"
+#include "protocol/odin/flash.hpp"
+#include "protocol/odin/group_flasher.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using brokkr::odin::PartFlush;
+using brokkr::testing::FakeOdin;
+using namespace std::chrono_literals;
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+constexpr std::size_t kImageBytes = 3 * 1024 * 1024 + 12345;
+constexpr std::uint64_t kMiB = 1024 * 1024;
+
+// end_download after each 1 MiB window sleeps flush_latency on the slow device: four windows, four flushes.
+static void test_measure(const fs::path& dir) {
+  const auto pit = brokkr::testing::make_pit("FLUSH", {{.id = 7, .name = "SYSTEM", .file_name = "system.img"}});
+  {
+    std::ofstream out(dir / "system.img", std::ios::binary);
+    for (std::size_t i = 0; i < kImageBytes; ++i) out.put(static_cast<char>(i * 7));
+  }
+  auto specs = brokkr::odin::expand_inputs_tar_or_raw({dir / "system.img"});
+  if (!specs) return fail_msg("measure", specs.error());
+
+  FakeOdin slow(pit), fast(pit);
+  slow.flush_latency = 20ms;
+  brokkr::odin::Target a{.id = "slow", .link = &slow}, b{.id = "fast", .link = &fast};
+  std::vector<brokkr::odin::Target*> devs{&a, &b};
+
+  brokkr::odin::Cfg cfg;
+  cfg.reboot_after = false;
+  cfg.buffer_bytes = kMiB;
+
+  auto g = brokkr::odin::prepare_flash(devs, *specs, nullptr, cfg, {});
+  if (!g) return fail_msg("measure", g.error());
+  if (auto st = brokkr::odin::flash_prepared(*g, cfg, {}); !st) return fail_msg("measure", st.error());
+
+  if (g->flush.size() != 2 || g->flush[0].size() != 1 || g->flush[1].size() != 1)
+    return fail_msg("measure", "one entry per device and partition expected");
+  const auto& s = g->flush[0][0];
+  const auto& f = g->flush[1][0];
+  if (s.part_name != "SYSTEM" || s.part_id != 7) return fail_msg("measure", "partition not named");
+  if (s.bytes != kImageBytes || s.windows != 4 || s.wire_bytes < s.bytes)
+    return fail_msg("measure", "bytes/windows not accounted");
+  if (s.flush < 80ms) return fail_msg("measure", "flush latency not captured");
+  if (f.flush >= s.flush) return fail_msg("measure", "fast device flushed no faster");
+  if (s.write_mbps() <= 0 || s.write_mbps() > kImageBytes / 0.08 / 1e6)
+    return fail_msg("measure", "write MB/s inconsistent with flush time");
+  pass();
+}
+
+static std::vector<PartFlush> device(double mbps, std::uint64_t bytes = 512 * kMiB) {
+  PartFlush big{.part_id = 1, .part_name = "SUPER", .bytes = bytes, .wire_bytes = bytes / 2, .windows = 17};
+  big.flush = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(static_cast<double>(bytes) / (mbps * 1e6)));
+  // Too small to count: its flush is almost all ACK round trip.
+  PartFlush tiny{.part_id = 2, .part_name = "BOOT", .bytes = kMiB, .wire_bytes = kMiB, .windows = 1, .flush = 1s};
+  return {big, tiny};
+}
+
+static void test_score() {
+  brokkr::app::FlushBaseline b;
+
+  auto v = brokkr::app::score_flush(b, "S911B", device(5.0, 2 * kMiB));
+  if (v.measured || !b.by_cpu_bl_id.empty()) return fail_msg("score", "small partitions were measured");
+
+  for (int i = 0; i < 9; ++i) {
+    v = brokkr::app::score_flush(b, "S911B", device(i % 2 ? 95 : 105));
+    if (v.outlier) return fail_msg("score", "flagged before the baseline was large enough");
+  }
+  v = brokkr::app::score_flush(b, "S911B", device(100));
+  if (!v.measured || std::fabs(v.mbps - 100) > 0.1) return fail_msg("score", "tiny partition not excluded");
+  if (v.baseline_n != 9 || std::fabs(v.baseline_mbps - 100) > 2 || std::fabs(v.z) > 1)
+    return fail_msg("score", "baseline stats");
+
+  v = brokkr::app::score_flush(b, "S911B", device(40));
+  if (!v.outlier || v.z >= -3) return fail_msg("score", "slow device not flagged");
+  if (b.by_cpu_bl_id["S911B"].n != 10) return fail_msg("score", "outlier folded into the baseline");
+
+  v = brokkr::app::score_flush(b, "S911B", device(300));
+  if (v.outlier) return fail_msg("score", "fast device flagged");
+  v = brokkr::app::score_flush(b, "A546B", device(40));
+  if (v.outlier || v.baseline_n) return fail_msg("score", "compared across cpu_bl_ids");
+  v = brokkr::app::score_flush(b, "", device(40));
+  if (!v.measured || v.baseline_n || b.by_cpu_bl_id.contains("")) return fail_msg("score", "unknown bootloader");
+
+  if (brokkr::app::describe_flush(brokkr::app::score_flush(b, "S911B", device(30)), "S911B").find("OUTLIER") ==
+      std::string::npos)
+    return fail_msg("score", "report does not show the outlier");
+  pass();
+}
+
+static void test_store(const fs::path& dir) {
+  const auto file = brokkr::app::flush_baseline_file(dir);
+  auto empty = brokkr::app::load_flush_baseline(file);
+  if (!empty || !empty->by_cpu_bl_id.empty()) return fail_msg("store", "missing file is not an empty baseline");
+
+  brokkr::app::FlushBaseline b;
+  for (double x : {90.0, 100.0, 110.0}) brokkr::app::score_flush(b, "S911B", device(x));
+  if (auto st = brokkr::app::save_flush_baseline(file, b); !st) return fail_msg("store", st.error());
+
+  auto back = brokkr::app::load_flush_baseline(file);
+  if (!back) return fail_msg("store", back.error());
+  const auto& want = b.by_cpu_bl_id["S911B"];
+  const auto& got = back->by_cpu_bl_id["S911B"];
+  if (got.n != 3 || std::fabs(got.mean - want.mean) > 1e-9 || std::fabs(got.m2 - want.m2) > 1e-9)
+    return fail_msg("store", "baseline not round-tripped");
+
+  {
+    std::ofstream out(file, std::ios::trunc);
+    out << "{\"cpu_bl_id\": {";
+  }
+  if (brokkr::app::load_flush_baseline(file)) return fail_msg("store", "corrupt baseline accepted");
+  pass();
+}
+
+int main() {
+  const fs::path dir = fs::temp_directory_path() / ("brokkr-flush-" + std::to_string(::getpid()));
+  fs::create_directories(dir);
+
+  test_measure(dir);
+  test_score();
+  test_store(dir);
+
+  std::error_code ec;
+  fs::remove_all(dir, ec);
+  std::printf("flush_fingerprint: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}
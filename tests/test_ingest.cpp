@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app/md5_verify.hpp"
+#include "io/tar.hpp"
+#include "protocol/odin/flash.hpp"
+#include "third_party/md5/md5.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+static void put_member(std::string& out, std::string_view name, const std::string& bytes) {
+  char h[512]{};
+  std::memcpy(h, name.data(), std::min<std::size_t>(name.size(), 100));
+  std::snprintf(h + 100, 8, "%07o", 0644);
+  std::snprintf(h + 108, 8, "%07o", 0);
+  std::snprintf(h + 116, 8, "%07o", 0);
+  std::snprintf(h + 124, 12, "%011llo", static_cast<unsigned long long>(bytes.size()));
+  std::snprintf(h + 136, 12, "%011o", 0);
+  h[156] = '0';
+  std::memcpy(h + 257, "ustar\0" "00", 8);
+  std::memset(h + 148, ' ', 8);
+  unsigned sum = 0;
+  for (unsigned char c : h) sum += c;
+  std::snprintf(h + 148, 8, "%06o", sum);
+
+  out.append(h, sizeof(h));
+  out += bytes;
+  out.append((512 - bytes.size() % 512) % 512, '\0');
+}
+
+// One stored block; only the frame header matters for expansion.
+static std::string lz4_frame(std::uint32_t content_size) {
+  std::string f("\x04\x22\x4d\x18\x68\x40", 6);
+  for (int i = 0; i < 4; ++i) f.push_back(static_cast<char>((content_size >> (8 * i)) & 0xff));
+  f.append(4, '\0');
+  f.push_back('\0');
+  const std::uint32_t blk = content_size | 0x80000000u;
+  for (int i = 0; i < 4; ++i) f.push_back(static_cast<char>((blk >> (8 * i)) & 0xff));
+  f.append(content_size, 'b');
+  f.append(4, '\0');
+  return f;
+}
+
+// AP-style package: download list, an LZ4 image and a raw one, then the Odin MD5 trailer.
+static fs::path write_package(const fs::path& dir, const char* name, bool good_md5) {
+  std::string tar;
+  put_member(tar, "meta-data/download-list.txt", "boot.img\nsystem.img\n");
+  put_member(tar, "boot.img.lz4", lz4_frame(4096));
+  put_member(tar, "system.img", std::string(70000, 's'));
+  tar.append(1024, '\0');
+
+  MD5_CTX ctx;
+  md5_init(&ctx);
+  md5_update(&ctx, reinterpret_cast<const MD5_BYTE*>(tar.data()), tar.size());
+  unsigned char digest[16];
+  md5_final(&ctx, digest);
+  if (!good_md5) digest[0] ^= 0xff;
+
+  char hex[33];
+  for (int i = 0; i < 16; ++i) std::snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+
+  const auto p = dir / name;
+  std::ofstream(p, std::ios::binary) << tar << hex << "  " << name << "\n";
+  return p;
+}
+
+// Clobbers the first tar header but keeps size and mtime, so only a remembered index still sees the members.
+static void clobber_keep_identity(const fs::path& p) {
+  const auto t = fs::last_write_time(p);
+  {
+    std::fstream f(p, std::ios::binary | std::ios::in | std::ios::out);
+    const std::string junk(512, 'Z');
+    f.write(junk.data(), static_cast<std::streamsize>(junk.size()));
+  }
+  fs::last_write_time(p, t);
+}
+
+static brokkr::core::Status verify(const fs::path& p) {
+  BRK_TRYV(jobs, brokkr::app::md5_jobs({p}));
+  if (jobs.size() != 1) return brokkr::core::fail("no MD5 job");
+  return brokkr::app::md5_verify(jobs, brokkr::odin::Ui{});
+}
+
+static void test_expand_from_ingest(const fs::path& dir) {
+  const auto p = write_package(dir, "AP_ingest.tar.md5", true);
+  if (auto st = verify(p); !st) return fail_msg("ingest", st.error());
+
+  clobber_keep_identity(p);
+  auto specs = brokkr::odin::expand_inputs_tar_or_raw({p});
+  if (!specs) return fail_msg("ingest", specs.error());
+  if (specs->size() != 2) return fail_msg("ingest", "expected boot.img and system.img from the ingested index");
+  const auto& boot = (*specs)[0];
+  if (boot.basename != "boot.img" || !boot.lz4 || boot.size != 4096) return fail_msg("ingest", "boot.img header");
+  if ((*specs)[1].basename != "system.img" || (*specs)[1].size != 70000) return fail_msg("ingest", "system.img");
+  pass();
+
+  // A newer mtime means a different file: the index is dropped and the clobbered header is seen.
+  fs::last_write_time(p, fs::last_write_time(p) + std::chrono::seconds(5));
+  specs = brokkr::odin::expand_inputs_tar_or_raw({p});
+  if (!specs || specs->size() != 1 || (*specs)[0].kind != brokkr::odin::ImageSpec::Kind::RawFile)
+    return fail_msg("ingest", "stale index was reused");
+  pass();
+}
+
+static void test_mismatch_not_remembered(const fs::path& dir) {
+  const auto p = write_package(dir, "AP_bad.tar.md5", false);
+  if (verify(p)) return fail_msg("mismatch", "bad MD5 was accepted");
+
+  clobber_keep_identity(p);
+  if (brokkr::io::TarArchive::is_tar_file(p.string())) return fail_msg("mismatch", "unverified index was kept");
+  pass();
+}
+
+int main() {
+  const auto dir = fs::temp_directory_path() / ("brokkr-ingest-" + std::to_string(::getpid()));
+  fs::remove_all(dir);
+  fs::create_directories(dir / "cache");
+  ::setenv("XDG_CACHE_HOME", (dir / "cache").c_str(), 1);
+
+  test_expand_from_ingest(dir);
+  test_mismatch_not_remembered(dir);
+
+  std::error_code ec;
+  fs::remove_all(dir, ec);
+
+  std::printf("ingest: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "core/json.hpp"
+
+#include <cstdio>
+#include <string>
+
+using brokkr::core::Json;
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+static void test_parse_rpc_request() {
+  auto r = Json::parse(R"({"jsonrpc":"2.0","id":7,"method":"flash","params":{"inputs":["/a.tar","/b.tar.md5"],
+                          "no_reboot":true,"pit":null}})");
+  if (!r) return fail_msg("parse_rpc_request", r.error());
+
+  const Json* params = r->find("params");
+  if (!params || !params->is_object()) return fail_msg("parse_rpc_request", "missing params");
+  if (r->find("id")->as_int() != 7) return fail_msg("parse_rpc_request", "id mismatch");
+  if (r->find("method")->as_string() != "flash") return fail_msg("parse_rpc_request", "method mismatch");
+
+  const auto& inputs = params->find("inputs")->array();
+  if (inputs.size() != 2 || inputs[1].as_string() != "/b.tar.md5") return fail_msg("parse_rpc_request", "inputs");
+  if (!params->find("no_reboot")->as_bool()) return fail_msg("parse_rpc_request", "no_reboot");
+  if (!params->find("pit")->is_null()) return fail_msg("parse_rpc_request", "pit should be null");
+  pass();
+}
+
+static void test_roundtrip_escapes() {
+  Json j;
+  j["text"] = "quote\" back\\ nl\n tab\t ctl\x01";
+  j["big"] = std::uint64_t{1} << 40;
+  j["neg"] = -2.5;
+  j["list"].push_back(true);
+  j["list"].push_back(nullptr);
+
+  auto back = Json::parse(j.dump());
+  if (!back) return fail_msg("roundtrip_escapes", back.error());
+  if (back->find("text")->as_string() != j.find("text")->as_string()) return fail_msg("roundtrip_escapes", "text");
+  if (back->find("big")->as_int() != (std::int64_t{1} << 40)) return fail_msg("roundtrip_escapes", "big");
+  if (back->find("neg")->as_number() != -2.5) return fail_msg("roundtrip_escapes", "neg");
+  if (back->find("list")->array().size() != 2) return fail_msg("roundtrip_escapes", "list");
+  if (j.dump().find("\"big\":1099511627776") == std::string::npos) return fail_msg("roundtrip_escapes", "int form");
+  pass();
+}
+
+static void test_unicode_escape() {
+  auto r = Json::parse(R"("café 😀")");
+  if (!r) return fail_msg("unicode_escape", r.error());
+  if (r->as_string() != "caf\xC3\xA9 \xF0\x9F\x98\x80") return fail_msg("unicode_escape", "decoded mismatch");
+  pass();
+}
+
+static void test_rejects_malformed() {
+  const char* bad[] = {"", "{", "{\"a\" 1}", "[1,]x", "\"unterminated", "tru", "{\"a\":1}}", "\"\x01\""};
+  for (const char* s : bad) {
+    if (Json::parse(s)) return fail_msg("rejects_malformed", std::string("accepted: ") + s);
+  }
+
+  std::string deep(200, '[');
+  deep += std::string(200, ']');
+  if (Json::parse(deep)) return fail_msg("rejects_malformed", "accepted excessive nesting");
+  pass();
+}
+
+int main() {
+  test_parse_rpc_request();
+  test_roundtrip_escapes();
+  test_unicode_escape();
+  test_rejects_malformed();
+
+  std::fprintf(stdout, "json: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}
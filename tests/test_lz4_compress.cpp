@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "io/lz4_compress.hpp"
+#include "third_party/lz4/lz4.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+static std::vector<std::byte> pattern(std::size_t n, std::uint32_t seed, unsigned alphabet) {
+  std::vector<std::byte> out(n);
+  std::uint32_t x = seed ? seed : 1;
+  for (auto& b : out) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    b = static_cast<std::byte>(alphabet ? (x % alphabet) : (x & 0xFF));
+  }
+  return out;
+}
+
+static bool roundtrip(const char* label, const std::vector<std::byte>& in, std::size_t* comp_size = nullptr) {
+  std::vector<std::byte> comp(brokkr::io::lz4_compress_bound(in.size()));
+  const std::size_t c = brokkr::io::lz4_compress_block(in, comp);
+  if (!c) {
+    fail_msg(label, "compress returned 0");
+    return false;
+  }
+
+  std::vector<std::byte> out(in.size() + 1);
+  const int d = LZ4_decompress_safe(reinterpret_cast<const char*>(comp.data()), reinterpret_cast<char*>(out.data()),
+                                    static_cast<int>(c), static_cast<int>(out.size()));
+  if (d != static_cast<int>(in.size()) || std::memcmp(out.data(), in.data(), in.size()) != 0) {
+    fail_msg(label, "decoded mismatch for size " + std::to_string(in.size()));
+    return false;
+  }
+  if (comp_size) *comp_size = c;
+  return true;
+}
+
+static void test_small_sizes() {
+  for (std::size_t n = 0; n < 64; ++n) {
+    if (!roundtrip("small_sizes", pattern(n, static_cast<std::uint32_t>(n + 7), 3))) return;
+  }
+  pass();
+}
+
+static void test_zero_block_compresses() {
+  const std::vector<std::byte> zeros(1u << 20);
+  std::size_t c = 0;
+  if (!roundtrip("zero_block", zeros, &c)) return;
+  if (c > 8192) return fail_msg("zero_block", "1 MiB of zeros compressed to " + std::to_string(c));
+  pass();
+}
+
+static void test_mixed_content() {
+  auto v = pattern(3u << 20, 42, 0);
+  std::memset(v.data() + 100000, 0, 700000);
+  const auto text = pattern(500000, 9, 12);
+  std::memcpy(v.data() + 1500000, text.data(), text.size());
+  std::memcpy(v.data() + 2200000, text.data(), text.size());
+  if (!roundtrip("mixed_content", v)) return;
+  pass();
+}
+
+static void test_incompressible_fits_bound() {
+  if (!roundtrip("incompressible", pattern(1u << 20, 1234, 0))) return;
+  pass();
+}
+
+static void test_small_dst_fails_cleanly() {
+  const auto in = pattern(4096, 5, 0);
+  std::vector<std::byte> comp(1024);
+  if (brokkr::io::lz4_compress_block(in, comp) != 0) return fail_msg("small_dst", "expected 0 for short output");
+  pass();
+}
+
+static void test_frame_blocks() {
+  const auto noise = pattern(1u << 20, 99, 0);
+  const auto text = pattern(300000, 7, 4);
+
+  std::vector<std::byte> stream;
+  brokkr::io::lz4_append_zero_block(1u << 20, stream);
+  const std::size_t zero_sz = stream.size();
+  brokkr::io::lz4_append_zero_block(1u << 20, stream);
+  brokkr::io::lz4_append_frame_block(noise, stream);
+  brokkr::io::lz4_append_frame_block(text, stream);
+  brokkr::io::lz4_append_zero_block(1000, stream);
+
+  if (zero_sz > 8192) return fail_msg("frame_blocks", "zero block too large: " + std::to_string(zero_sz));
+
+  const std::vector<std::size_t> sizes{1u << 20, 1u << 20, 1u << 20, 300000, 1000};
+  std::size_t pos = 0;
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    std::uint32_t hdr = 0;
+    std::memcpy(&hdr, stream.data() + pos, 4);
+    pos += 4;
+    const std::size_t payload = hdr & 0x7FFFFFFFu;
+
+    std::vector<std::byte> out(sizes[i]);
+    if (hdr & 0x80000000u) {
+      if (payload != sizes[i]) return fail_msg("frame_blocks", "stored block has wrong size");
+      std::memcpy(out.data(), stream.data() + pos, payload);
+    } else {
+      const int d = LZ4_decompress_safe(reinterpret_cast<const char*>(stream.data() + pos),
+                                        reinterpret_cast<char*>(out.data()), static_cast<int>(payload),
+                                        static_cast<int>(out.size()));
+      if (d != static_cast<int>(sizes[i])) return fail_msg("frame_blocks", "block " + std::to_string(i) + " bad size");
+    }
+    pos += payload;
+
+    const std::vector<std::byte>* want = i == 2 ? &noise : i == 3 ? &text : nullptr;
+    const bool ok =
+        want ? out == *want : std::all_of(out.begin(), out.end(), [](std::byte b) { return b == std::byte{0}; });
+    if (!ok) return fail_msg("frame_blocks", "block " + std::to_string(i) + " content mismatch");
+    if (i == 2 && !(hdr & 0x80000000u)) return fail_msg("frame_blocks", "incompressible block not stored raw");
+  }
+  if (pos != stream.size()) return fail_msg("frame_blocks", "trailing bytes");
+  pass();
+}
+
+int main() {
+  test_small_sizes();
+  test_zero_block_compresses();
+  test_mixed_content();
+  test_incompressible_fits_bound();
+  test_small_dst_fails_cleanly();
+  test_frame_blocks();
+
+  std::fprintf(stdout, "lz4_compress: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}
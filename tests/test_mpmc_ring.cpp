@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "core/mpmc_ring.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+static void test_fifo_and_bounds() {
+  brokkr::core::MpmcRing<int> ring(3);
+  if (ring.capacity() != 4) return fail_msg("fifo", "capacity not rounded up to a power of two");
+
+  for (int i = 0; i < 4; ++i)
+    if (!ring.try_push(i)) return fail_msg("fifo", "push into a non-full ring failed");
+  if (ring.try_push(4)) return fail_msg("fifo", "push into a full ring succeeded");
+
+  for (int i = 0; i < 4; ++i) {
+    const auto v = ring.try_pop();
+    if (!v || *v != i) return fail_msg("fifo", "values out of order");
+  }
+  if (ring.try_pop()) return fail_msg("fifo", "pop from an empty ring returned a value");
+
+  // Wrap around a few laps.
+  for (int i = 0; i < 100; ++i) {
+    if (!ring.try_push(i)) return fail_msg("fifo", "push after wrap failed");
+    const auto v = ring.try_pop();
+    if (!v || *v != i) return fail_msg("fifo", "value lost after wrap");
+  }
+  pass();
+}
+
+// Every value pushed by any producer is popped exactly once by some consumer.
+static void test_concurrent() {
+  constexpr int kProducers = 4;
+  constexpr int kConsumers = 4;
+  constexpr std::uint64_t kPerProducer = 100000;
+
+  brokkr::core::MpmcRing<std::uint64_t> ring(256);
+  std::vector<std::atomic<std::uint8_t>> seen(kProducers * kPerProducer);
+  std::atomic<std::uint64_t> popped{0};
+  std::atomic<bool> dup{false};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < kProducers; ++p)
+    threads.emplace_back([&, p] {
+      for (std::uint64_t i = 0; i < kPerProducer; ++i) {
+        const std::uint64_t v = p * kPerProducer + i;
+        while (!ring.try_push(v)) std::this_thread::yield();
+      }
+    });
+  for (int c = 0; c < kConsumers; ++c)
+    threads.emplace_back([&] {
+      while (popped.load(std::memory_order_relaxed) < kProducers * kPerProducer) {
+        const auto v = ring.try_pop();
+        if (!v) {
+          std::this_thread::yield();
+          continue;
+        }
+        if (seen[*v].fetch_add(1, std::memory_order_relaxed) != 0) dup.store(true);
+        popped.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  for (auto& t : threads) t.join();
+
+  if (dup.load()) return fail_msg("concurrent", "a value was popped twice");
+  for (const auto& s : seen)
+    if (s.load() != 1) return fail_msg("concurrent", "a value was lost");
+  if (ring.try_pop()) return fail_msg("concurrent", "ring not drained");
+  pass();
+}
+
+int main() {
+  test_fifo_and_bounds();
+  test_concurrent();
+
+  std::printf("mpmc_ring: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "core/pipeline.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using brokkr::core::Pipeline;
+using brokkr::core::Result;
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+static auto counter(int n) {
+  return [i = 0, n](std::stop_token) mutable -> Result<std::optional<int>> {
+    if (i >= n) return std::optional<int>{};
+    return std::optional<int>{i++};
+  };
+}
+
+static void test_order_with_workers() {
+  auto p = Pipeline<int>::source(counter(200), 4)
+               .then(4,
+                     [](int v) -> Result<int> {
+                       // Uneven work so later items regularly finish first.
+                       std::this_thread::sleep_for(std::chrono::microseconds((v * 7919) % 300));
+                       return v * 2;
+                     })
+               .then(1, [](int v) -> Result<std::string> { return std::to_string(v); });
+
+  std::vector<std::string> got;
+  while (auto v = p.next()) got.push_back(std::move(*v));
+
+  if (!p.status()) return fail_msg("order", p.status().error());
+  if (got.size() != 200) return fail_msg("order", "expected 200 items, got " + std::to_string(got.size()));
+  for (int i = 0; i < 200; ++i)
+    if (got[static_cast<std::size_t>(i)] != std::to_string(i * 2)) return fail_msg("order", "item out of order");
+  pass();
+}
+
+static void test_error_propagates() {
+  auto p = Pipeline<int>::source(counter(1000)).then(3, [](int v) -> Result<int> {
+    if (v == 17) return brokkr::core::fail("bad item 17");
+    return v;
+  });
+
+  int seen = 0;
+  while (auto v = p.next()) {
+    if (*v != seen) return fail_msg("error", "item out of order before failure");
+    ++seen;
+  }
+
+  if (p.status()) return fail_msg("error", "stage error not reported");
+  if (p.status().error() != "bad item 17") return fail_msg("error", "wrong error: " + p.status().error());
+  if (seen > 17) return fail_msg("error", "items past the failure were delivered");
+  pass();
+}
+
+static void test_source_error() {
+  auto p = Pipeline<int>::source([i = 0](std::stop_token) mutable -> Result<std::optional<int>> {
+             if (i == 3) return brokkr::core::fail("read failed");
+             return std::optional<int>{i++};
+           }).then(2, [](int v) -> Result<int> { return v; });
+
+  while (p.next()) {
+  }
+  if (p.status()) return fail_msg("source_error", "source error not reported");
+  pass();
+}
+
+static void test_early_destroy() {
+  std::atomic_int produced{0};
+  {
+    auto p = Pipeline<int>::source([&](std::stop_token) -> Result<std::optional<int>> {
+               return std::optional<int>{produced.fetch_add(1)};
+             }).then(2, [](int v) -> Result<int> { return v; });
+
+    for (int i = 0; i < 5; ++i)
+      if (!p.next()) return fail_msg("early_destroy", "infinite source ended");
+  }
+  // Bounded queues keep the producer from running away before the stop.
+  if (produced.load() > 16) return fail_msg("early_destroy", "producer ran ahead: " + std::to_string(produced.load()));
+  pass();
+}
+
+static void test_move_only_items() {
+  auto p = Pipeline<std::unique_ptr<int>>::source([i = 0](std::stop_token) mutable
+                                                  -> Result<std::optional<std::unique_ptr<int>>> {
+             if (i == 10) return std::optional<std::unique_ptr<int>>{};
+             return std::optional<std::unique_ptr<int>>{std::make_unique<int>(i++)};
+           }).then(2, [](std::unique_ptr<int> v) -> Result<std::unique_ptr<int>> {
+    *v += 1;
+    return v;
+  });
+
+  int sum = 0;
+  while (auto v = p.next()) sum += **v;
+  if (!p.status() || sum != 55) return fail_msg("move_only", "unexpected sum " + std::to_string(sum));
+  pass();
+}
+
+int main() {
+  test_order_with_workers();
+  test_error_propagates();
+  test_source_error();
+  test_early_destroy();
+  test_move_only_items();
+
+  std::printf("pipeline: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fake_odin.hpp"
+#include "platform/platform_all.hpp"
+#include "protocol/odin/odin_cmd.hpp"
+#include "protocol/relay/relay_server.hpp"
+#include "protocol/relay/remote_transport.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+struct Agent {
+  brokkr::platform::TcpListener listener;
+  std::uint16_t port = 0;
+  std::shared_ptr<brokkr::testing::FakeOdin> dev = std::make_shared<brokkr::testing::FakeOdin>();
+  std::jthread thread;
+
+  bool start(int sessions) {
+    for (std::uint16_t p = 23580; p < 23680 && !port; ++p)
+      if (listener.bind_and_listen("127.0.0.1", p)) port = p;
+    if (!port) return false;
+
+    thread = std::jthread([this, sessions] {
+      const brokkr::relay::RelayHooks hooks{
+          .list = [] { return std::vector<std::string>{"/dev/fake\tfake-1"}; },
+          .open = [this](const std::string& devnode)
+              -> brokkr::core::Result<std::shared_ptr<brokkr::core::IByteTransport>> {
+            if (devnode != "/dev/fake") return brokkr::core::fail("no such device");
+            return std::shared_ptr<brokkr::core::IByteTransport>(dev);
+          },
+      };
+      for (int served = 0; served < sessions;) {
+        auto c = listener.accept_one();
+        if (!c) continue;
+        c->set_timeout_ms(200);
+        (void)brokkr::relay::serve_relay_session(*c, hooks);
+        ++served;
+      }
+    });
+    return true;
+  }
+};
+
+static std::vector<std::uint8_t> text_payload(std::size_t n) {
+  std::vector<std::uint8_t> out(n);
+  for (std::size_t i = 0; i < n; ++i) out[i] = static_cast<std::uint8_t>("brokkr relay payload "[i % 21]);
+  return out;
+}
+
+static std::vector<std::uint8_t> noise_payload(std::size_t n) {
+  std::vector<std::uint8_t> out(n);
+  std::uint32_t x = 0x9E3779B9u;
+  for (auto& b : out) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    b = static_cast<std::uint8_t>(x);
+  }
+  return out;
+}
+
+static void test_list_and_open(std::uint16_t port) {
+  auto devs = brokkr::relay::list_remote_devices("127.0.0.1", port);
+  if (!devs) return fail_msg("list", devs.error());
+  if (devs->size() != 1 || (*devs)[0].devnode != "/dev/fake" || (*devs)[0].sysname != "fake-1")
+    return fail_msg("list", "unexpected device list");
+
+  auto bad = brokkr::relay::RemoteTransport::open("127.0.0.1", port, "/dev/other");
+  if (bad) return fail_msg("open_unknown", "expected failure");
+  pass();
+}
+
+static void test_odin_session(std::uint16_t port, brokkr::testing::FakeOdin& dev) {
+  auto rt = brokkr::relay::RemoteTransport::open("127.0.0.1", port, "/dev/fake", true);
+  if (!rt) return fail_msg("session", rt.error());
+
+  brokkr::odin::OdinCommands odin(*rt);
+  if (auto st = odin.handshake(); !st) return fail_msg("session", st.error());
+  auto info = odin.get_version();
+  if (!info) return fail_msg("session", info.error());
+  if (!info->supports_compressed_download()) return fail_msg("session", "ack word mangled");
+
+  std::vector<std::uint8_t> expect;
+  for (const auto& pkt : {text_payload(1u << 20), noise_payload(1u << 20), text_payload(100)}) {
+    if (rt->send(pkt) != static_cast<int>(pkt.size())) return fail_msg("session", "send failed");
+    if (auto r = odin.recv_checked_response(0); !r) return fail_msg("session", r.error());
+    expect.insert(expect.end(), pkt.begin(), pkt.end());
+  }
+  if (dev.received != expect) return fail_msg("session", "device saw different bytes");
+  pass();
+}
+
+static void test_deferred_send_error(std::uint16_t port, brokkr::testing::FakeOdin& dev) {
+  auto rt = brokkr::relay::RemoteTransport::open("127.0.0.1", port, "/dev/fake");
+  if (!rt) return fail_msg("deferred_error", rt.error());
+
+  dev.fail_sends = true;
+  const auto pkt = text_payload(4096);
+  // The send itself is pipelined; the failure surfaces on the next receive.
+  if (rt->send(pkt) != static_cast<int>(pkt.size())) return fail_msg("deferred_error", "send not pipelined");
+  std::uint8_t buf[8];
+  if (rt->recv(buf) >= 0) return fail_msg("deferred_error", "recv should report the USB failure");
+  pass();
+}
+
+int main() {
+  Agent agent;
+  agent.dev->keep_data = true;
+  if (!agent.start(4)) {
+    std::fprintf(stderr, "cannot bind a loopback port\n");
+    return 1;
+  }
+
+  test_list_and_open(agent.port);
+  test_odin_session(agent.port, *agent.dev);
+  test_deferred_send_error(agent.port, *agent.dev);
+
+  std::printf("relay: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "fake_odin.hpp"
+#include "protocol/odin/flash.hpp"
+#include "protocol/odin/group_flasher.hpp"
+#include "protocol/odin/station.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using brokkr::testing::FakeOdin;
+using Clock = std::chrono::steady_clock;
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+constexpr std::size_t kImageBytes = 3 * 1024 * 1024 + 12345;
+
+struct Fixture {
+  fs::path dir;
+  std::vector<brokkr::odin::ImageSpec> specs;
+  std::vector<std::byte> pit = brokkr::testing::make_pit("STATION", {{.id = 7, .name = "SYSTEM", .file_name = "system.img"}});
+
+  Fixture() {
+    dir = fs::temp_directory_path() / ("brokkr-station-" + std::to_string(::getpid()));
+    fs::create_directories(dir);
+    std::ofstream out(dir / "system.img", std::ios::binary);
+    for (std::size_t i = 0; i < kImageBytes; ++i) out.put(static_cast<char>((i * 131) >> 3));
+    out.close();
+    if (auto s = brokkr::odin::expand_inputs_tar_or_raw({dir / "system.img"})) specs = std::move(*s);
+  }
+  ~Fixture() {
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+  }
+};
+
+struct Device {
+  std::unique_ptr<FakeOdin> link;
+  brokkr::odin::Target target;
+
+  Device(const Fixture& fx, std::string id, std::uint64_t bytes_per_sec = 0)
+      : link(std::make_unique<FakeOdin>(fx.pit)), target{.id = std::move(id), .link = link.get()} {
+    link->usb_bytes_per_sec = bytes_per_sec;
+  }
+
+  bool flashed() const { return link->data_bytes >= kImageBytes && link->closed; }
+};
+
+static brokkr::odin::Cfg quiet_cfg() {
+  brokkr::odin::Cfg cfg;
+  cfg.reboot_after = false;
+  cfg.buffer_bytes = 1024 * 1024;
+  return cfg;
+}
+
+static void test_prepare_then_flash(const Fixture& fx) {
+  Device a(fx, "a"), b(fx, "b");
+  std::vector<brokkr::odin::Target*> devs{&a.target, &b.target};
+
+  auto g = brokkr::odin::prepare_flash(devs, fx.specs, nullptr, quiet_cfg(), {});
+  if (!g) return fail_msg("prepare", g.error());
+  if (g->items.size() != 1 || g->total != kImageBytes) return fail_msg("prepare", "unexpected plan");
+  if (a.link->data_bytes || b.link->data_bytes) return fail_msg("prepare", "image data sent before the data phase");
+
+  bool done = false;
+  brokkr::odin::Ui ui;
+  ui.on_done = [&] { done = true; };
+  if (auto st = brokkr::odin::flash_prepared(*g, quiet_cfg(), ui); !st) return fail_msg("flash_prepared", st.error());
+  if (!done || !a.flashed() || !b.flashed()) return fail_msg("flash_prepared", "devices not fully flashed");
+  pass();
+}
+
+static void test_merge(const Fixture& fx) {
+  Device a(fx, "a"), b(fx, "b"), c(fx, "c");
+  std::vector<brokkr::odin::Target*> first{&a.target}, second{&b.target, &c.target};
+
+  auto g1 = brokkr::odin::prepare_flash(first, fx.specs, nullptr, quiet_cfg(), {});
+  auto g2 = brokkr::odin::prepare_flash(second, fx.specs, nullptr, quiet_cfg(), {});
+  if (!g1 || !g2) return fail_msg("merge", "prepare failed");
+
+  Device d(fx, "d");
+  std::vector<brokkr::odin::Target*> third{&d.target};
+  const auto other_pit = std::make_shared<const std::vector<std::byte>>(fx.pit);
+  auto g3 = brokkr::odin::prepare_flash(third, fx.specs, other_pit, quiet_cfg(), {});
+  if (!g3) return fail_msg("merge", g3.error());
+  if (brokkr::odin::merge_prepared(*g1, std::move(*g3))) return fail_msg("merge", "merged groups with different PITs");
+
+  if (!brokkr::odin::merge_prepared(*g1, std::move(*g2))) return fail_msg("merge", "matching groups not merged");
+  if (g1->active.size() != 3 || g1->active_idx != std::vector<std::size_t>{0, 1, 2})
+    return fail_msg("merge", "device indices not continued");
+
+  if (auto st = brokkr::odin::flash_prepared(*g1, quiet_cfg(), {}); !st) return fail_msg("merge", st.error());
+  if (!a.flashed() || !b.flashed() || !c.flashed()) return fail_msg("merge", "merged devices not flashed");
+  pass();
+}
+
+// A and B stream slowly. B arrives during A's data phase and must be prepared before A is done; C and D
+// arrive one poll apart during B's and must share one data phase after it.
+static void test_station_overlap(const Fixture& fx) {
+  Device a(fx, "a", 8 * 1024 * 1024), b(fx, "b", 8 * 1024 * 1024);
+  Device c(fx, "c"), d(fx, "d");
+
+  std::mutex m;
+  std::vector<std::string> events;
+  auto log = [&](std::string e) {
+    std::lock_guard lk(m);
+    events.push_back(std::move(e));
+  };
+
+  std::stop_source stop;
+  std::atomic_int polls{0};
+  std::vector<std::size_t> batch_sizes;
+
+  brokkr::odin::StationHooks hooks;
+  std::size_t late = 0;
+  hooks.poll = [&]() -> std::vector<brokkr::odin::Target*> {
+    const int n = polls++;
+    if (n == 0) return {&a.target};
+    if (n == 2) return {&b.target};
+
+    bool a_done = false;
+    {
+      std::lock_guard lk(m);
+      for (const auto& e : events) a_done |= (e == "done a");
+    }
+    if (!a_done || late >= 2) return {};
+    return {late++ == 0 ? &c.target : &d.target};
+  };
+  hooks.ui_for = [&](const std::vector<brokkr::odin::Target*>& devs) {
+    brokkr::odin::Ui ui;
+    const std::string who = devs.front()->id;
+    ui.on_plan = [&, who](const std::vector<brokkr::odin::PlanItem>&, std::uint64_t) { log("prepared " + who); };
+    return ui;
+  };
+  hooks.on_batch_done = [&](const std::vector<brokkr::odin::Target*>& devs, const brokkr::core::Status& st) {
+    if (!st) fail_msg("station", st.error());
+    log("done " + devs.front()->id);
+    batch_sizes.push_back(devs.size());
+    std::size_t total = 0;
+    for (auto n : batch_sizes) total += n;
+    if (total == 4) stop.request_stop();
+  };
+
+  brokkr::odin::StationCfg scfg{.poll_interval = std::chrono::milliseconds(20)};
+  std::jthread watchdog([&](std::stop_token st) {
+    const auto until = Clock::now() + std::chrono::seconds(20);
+    while (!st.stop_requested() && Clock::now() < until) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    stop.request_stop();
+  });
+  const auto stats = brokkr::odin::run_station(fx.specs, nullptr, quiet_cfg(), scfg, hooks, stop.get_token());
+  watchdog.request_stop();
+
+  if (stats.devices != 4 || stats.failed != 0) return fail_msg("station", "not every device was flashed");
+  if (!a.flashed() || !b.flashed() || !c.flashed() || !d.flashed()) return fail_msg("station", "device missing data");
+
+  auto pos = [&](const std::string& e) {
+    for (std::size_t i = 0; i < events.size(); ++i)
+      if (events[i] == e) return i;
+    return events.size();
+  };
+  if (pos("prepared b") > pos("done a")) return fail_msg("station", "B was not prepared during A's data phase");
+  if (batch_sizes != std::vector<std::size_t>{1, 1, 2}) return fail_msg("station", "C and D were not merged");
+  pass();
+}
+
+// Each device gets its own arm: arms never share a data phase, every device is reported once with the
+// arm it ran under, and a device that fails is reported as failed while its batch mate still succeeds.
+static void test_station_variants(const Fixture& fx) {
+  Device a(fx, "a"), b(fx, "b"), c(fx, "c");
+  c.link->fail_sends = true;
+
+  brokkr::odin::StationCfg scfg{.poll_interval = std::chrono::milliseconds(20)};
+  scfg.variants = {quiet_cfg(), quiet_cfg()};
+  scfg.variants[1].pipeline_depth = 4;
+  scfg.variants[1].compressed_download = false;
+
+  std::stop_source stop;
+  std::atomic_int polls{0};
+  std::vector<std::size_t> batch_sizes;
+  std::vector<brokkr::odin::DeviceOutcome> outcomes;
+
+  brokkr::odin::StationHooks hooks;
+  hooks.poll = [&]() -> std::vector<brokkr::odin::Target*> {
+    if (polls++ == 0) return {&a.target, &b.target, &c.target};
+    return {};
+  };
+  hooks.variant = [](const brokkr::odin::Target& t) -> std::size_t { return t.id == "b" ? 1 : 0; };
+  hooks.on_device_done = [&](const brokkr::odin::DeviceOutcome& o) { outcomes.push_back(o); };
+  hooks.on_batch_done = [&](const std::vector<brokkr::odin::Target*>& devs, const brokkr::core::Status&) {
+    batch_sizes.push_back(devs.size());
+    if (outcomes.size() == 3) stop.request_stop();
+  };
+
+  std::jthread watchdog([&](std::stop_token st) {
+    const auto until = Clock::now() + std::chrono::seconds(20);
+    while (!st.stop_requested() && Clock::now() < until) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    stop.request_stop();
+  });
+  brokkr::odin::run_station(fx.specs, nullptr, quiet_cfg(), scfg, hooks, stop.get_token());
+  watchdog.request_stop();
+
+  if (batch_sizes.size() != 2) return fail_msg("variants", "arms were merged into one data phase");
+  if (outcomes.size() != 3) return fail_msg("variants", "not every device was reported");
+  for (const auto& o : outcomes) {
+    const std::size_t want = o.dev == &b.target ? 1 : 0;
+    if (o.variant != want) return fail_msg("variants", o.dev->id + " reported under the wrong arm");
+    if (o.ok != (o.dev != &c.target)) return fail_msg("variants", o.dev->id + " has the wrong outcome");
+    if (o.ok && (o.bytes != kImageBytes || o.data_time.count() <= 0))
+      return fail_msg("variants", o.dev->id + " has no data phase timing");
+    if (o.ok && (o.flush.size() != 1 || o.flush[0].bytes != kImageBytes))
+      return fail_msg("variants", o.dev->id + " has no storage flush timing");
+  }
+  if (!a.flashed() || !b.flashed()) return fail_msg("variants", "device missing data");
+  pass();
+}
+
+int main() {
+  const Fixture fx;
+  if (fx.specs.size() != 1) {
+    std::fprintf(stderr, "fixture: cannot build image spec\n");
+    return 1;
+  }
+
+  test_prepare_then_flash(fx);
+  test_merge(fx);
+  test_station_overlap(fx);
+  test_station_variants(fx);
+
+  std::printf("station: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}
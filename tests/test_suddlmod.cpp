@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "platform/linux/sysfs_usb.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using brokkr::linux::SerialScanRoots;
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+struct Pty {
+  int master = -1;
+  std::string slave;
+
+  Pty() {
+    master = ::posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || ::grantpt(master) != 0 || ::unlockpt(master) != 0) return;
+    slave = ::ptsname(master);
+  }
+  ~Pty() {
+    if (master >= 0) ::close(master);
+  }
+  Pty(const Pty&) = delete;
+  Pty& operator=(const Pty&) = delete;
+
+  std::string drain(int wait_ms) const {
+    std::string out;
+    pollfd p{.fd = master, .events = POLLIN, .revents = 0};
+    while (::poll(&p, 1, wait_ms) > 0 && (p.revents & POLLIN)) {
+      char buf[256];
+      const ssize_t n = ::read(master, buf, sizeof(buf));
+      if (n <= 0) break;
+      out.append(buf, static_cast<std::size_t>(n));
+      wait_ms = 50;
+    }
+    return out;
+  }
+};
+
+// A sysfs-shaped tree: class/tty/<tty>/device -> devices/usb1/<dev>/<dev>:1.<n>, with the ids on <dev>.
+struct FakeTree {
+  fs::path root;
+  SerialScanRoots roots;
+
+  FakeTree() {
+    root = fs::temp_directory_path() / ("brokkr-suddlmod-" + std::to_string(::getpid()));
+    fs::remove_all(root);
+    roots.sys = root / "sys";
+    roots.dev = root / "dev";
+    fs::create_directories(roots.sys / "class" / "tty");
+    fs::create_directories(roots.dev);
+  }
+  ~FakeTree() {
+    std::error_code ec;
+    fs::remove_all(root, ec);
+  }
+
+  void usb_device(const std::string& dev, const char* vid, const char* pid) const {
+    const auto d = roots.sys / "devices" / "usb1" / dev;
+    fs::create_directories(d);
+    std::ofstream(d / "idVendor") << vid << "\n";
+    std::ofstream(d / "idProduct") << pid << "\n";
+  }
+
+  void acm(const std::string& tty, const std::string& dev, int iface, const std::string& node) const {
+    const auto i = roots.sys / "devices" / "usb1" / dev / (dev + ":1." + std::to_string(iface));
+    fs::create_directories(i);
+    fs::create_directories(roots.sys / "class" / "tty" / tty);
+    fs::create_symlink(i, roots.sys / "class" / "tty" / tty / "device");
+    if (!node.empty()) fs::create_symlink(node, roots.dev / tty);
+  }
+};
+
+static void test_enumerate_and_send() {
+  FakeTree t;
+  Pty phone1, phone1_second, odin, other, phone2;
+  if (phone1.slave.empty() || phone2.slave.empty()) return fail_msg("send", "no ptys available");
+
+  t.usb_device("1-1", "04e8", "6860");
+  t.usb_device("1-2", "04e8", "685d");
+  t.usb_device("1-3", "1234", "5678");
+  t.usb_device("1-4", "04e8", "6860");
+  t.usb_device("1-5", "04e8", "6860");
+  t.acm("ttyACM0", "1-1", 1, phone1.slave);
+  t.acm("ttyACM1", "1-1", 3, phone1_second.slave);
+  t.acm("ttyACM2", "1-2", 0, odin.slave);
+  t.acm("ttyACM3", "1-3", 0, other.slave);
+  t.acm("ttyACM4", "1-4", 0, ""); // unplugged between scan and open
+  t.acm("ttyACM10", "1-5", 0, phone2.slave);
+  fs::create_directories(t.roots.sys / "class" / "tty" / "ttyS0");
+
+  const auto ports = brokkr::linux::enumerate_cdc_acm_ports(0x04E8, t.roots);
+  const std::vector<std::string> want = {"ttyACM0", "ttyACM1", "ttyACM2", "ttyACM4", "ttyACM10"};
+  if (ports.size() != want.size()) return fail_msg("enumerate", "got " + std::to_string(ports.size()) + " ports");
+  for (std::size_t i = 0; i < want.size(); ++i) {
+    if (ports[i].tty != want[i]) return fail_msg("enumerate", "order: " + ports[i].tty + " at " + std::to_string(i));
+  }
+  if (ports[0].usb_sysname != "1-1" || ports[0].product != 0x6860) return fail_msg("enumerate", "wrong device info");
+  pass();
+
+  const auto r = brokkr::linux::send_suddlmod_to_samsung_serial(0x04E8, -1, t.roots, std::chrono::milliseconds(500));
+  if (r.ports_seen != 3) return fail_msg("send", "ports_seen=" + std::to_string(r.ports_seen));
+  if (r.sent_ok != 2) return fail_msg("send", "sent_ok=" + std::to_string(r.sent_ok));
+  if (r.failures.size() != 1 || r.failures[0].find("ttyACM4 (1-4)") != 0)
+    return fail_msg("send", "expected a single ttyACM4 failure");
+
+  const std::string cmd = "AT+SUDDLMOD=0,0\r";
+  if (phone1.drain(500) != cmd) return fail_msg("send", "phone 1 did not get the command");
+  if (phone2.drain(500) != cmd) return fail_msg("send", "phone 2 did not get the command");
+  if (!phone1_second.drain(50).empty()) return fail_msg("send", "second ACM port of phone 1 was written");
+  if (!odin.drain(50).empty()) return fail_msg("send", "device already in Odin mode was written");
+  if (!other.drain(50).empty()) return fail_msg("send", "non-Samsung port was written");
+  pass();
+
+  const auto one = brokkr::linux::send_suddlmod_to_samsung_serial(0x04E8, 1, t.roots, std::chrono::milliseconds(500));
+  if (one.ports_seen != 1 || one.sent_ok != 1) return fail_msg("max_targets", "limit not applied");
+  if (phone1.drain(500) != cmd) return fail_msg("max_targets", "first port not chosen");
+  pass();
+}
+
+static void test_stalled_port_times_out() {
+  FakeTree t;
+  Pty stalled, ok;
+  if (stalled.slave.empty() || ok.slave.empty()) return fail_msg("stalled", "no ptys available");
+
+  // Output suspended on the line: the command sits in the queue and never drains.
+  const int hold = ::open(stalled.slave.c_str(), O_RDWR | O_NOCTTY);
+  if (hold < 0 || ::tcflow(hold, TCOOFF) != 0) return fail_msg("stalled", "cannot suspend pty output");
+
+  t.usb_device("1-1", "04e8", "6860");
+  t.usb_device("1-2", "04e8", "6860");
+  t.acm("ttyACM0", "1-1", 0, stalled.slave);
+  t.acm("ttyACM1", "1-2", 0, ok.slave);
+
+  const auto t0 = std::chrono::steady_clock::now();
+  const auto r = brokkr::linux::send_suddlmod_to_samsung_serial(0x04E8, -1, t.roots, std::chrono::milliseconds(200));
+  const auto took = std::chrono::steady_clock::now() - t0;
+  ::close(hold);
+
+  if (took > std::chrono::seconds(2)) return fail_msg("stalled", "the stalled port held up the batch");
+  if (r.sent_ok != 1 || r.failures.size() != 1 || r.failures[0].find("ttyACM0") != 0)
+    return fail_msg("stalled", "expected ttyACM0 to fail and ttyACM1 to succeed");
+  if (ok.drain(500) != "AT+SUDDLMOD=0,0\r") return fail_msg("stalled", "healthy port did not get the command");
+  pass();
+}
+
+int main() {
+  test_enumerate_and_send();
+  test_stalled_port_times_out();
+
+  std::printf("suddlmod: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}
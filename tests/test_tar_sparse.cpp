@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "io/source.hpp"
+#include "io/tar.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using brokkr::io::SparseExtent;
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+// Minimal writer for the header variants GNU tar emits with -S.
+class TarWriter {
+ public:
+  void header(std::string_view name, char type, std::uint64_t size, bool gnu,
+              const std::function<void(char*)>& extra = {}) {
+    char h[512]{};
+    std::memcpy(h, name.data(), std::min<std::size_t>(name.size(), 100));
+    std::snprintf(h + 100, 8, "%07o", 0644);
+    std::snprintf(h + 108, 8, "%07o", 0);
+    std::snprintf(h + 116, 8, "%07o", 0);
+    std::snprintf(h + 124, 12, "%011llo", static_cast<unsigned long long>(size));
+    std::snprintf(h + 136, 12, "%011o", 0);
+    h[156] = type;
+    std::memcpy(h + 257, gnu ? "ustar  " : "ustar\0" "00", 8);
+    if (extra) extra(h);
+
+    std::memset(h + 148, ' ', 8);
+    unsigned sum = 0;
+    for (unsigned char c : h) sum += c;
+    std::snprintf(h + 148, 8, "%06o", sum);
+    out_.append(h, sizeof(h));
+  }
+
+  void data(const std::string& bytes) {
+    out_ += bytes;
+    out_.append((512 - bytes.size() % 512) % 512, '\0');
+  }
+
+  void pax(const std::vector<std::pair<std::string, std::string>>& kv) {
+    std::string body;
+    for (const auto& [k, v] : kv) {
+      const std::string rec = " " + k + "=" + v + "\n";
+      std::size_t len = rec.size() + 1;
+      while (std::to_string(len).size() + rec.size() != len) ++len;
+      body += std::to_string(len) + rec;
+    }
+    header("PaxHeaders/x", 'x', body.size(), false);
+    data(body);
+  }
+
+  void regular(std::string_view name, const std::string& bytes) {
+    header(name, '0', bytes.size(), false);
+    data(bytes);
+  }
+
+  bool save(const std::filesystem::path& p) {
+    out_.append(1024, '\0');
+    std::ofstream f(p, std::ios::binary);
+    f.write(out_.data(), static_cast<std::streamsize>(out_.size()));
+    return static_cast<bool>(f);
+  }
+
+ private:
+  std::string out_;
+};
+
+struct Image {
+  std::uint64_t real_size = 0;
+  std::vector<SparseExtent> map;
+  std::string stored;
+  std::string logical;
+};
+
+static Image make_image(std::uint64_t real_size, std::size_t extents) {
+  Image im;
+  im.real_size = real_size;
+  im.logical.assign(static_cast<std::size_t>(real_size), '\0');
+  const std::uint64_t stride = real_size / (extents + 1);
+  for (std::size_t i = 0; i < extents; ++i) {
+    const SparseExtent x{i * stride + 123 * (i + 1), 1000 + i * 517};
+    im.map.push_back(x);
+    for (std::uint64_t j = 0; j < x.size; ++j) {
+      const char c = static_cast<char>('a' + (i + j) % 26);
+      im.logical[static_cast<std::size_t>(x.offset + j)] = c;
+      im.stored.push_back(c);
+    }
+  }
+  return im;
+}
+
+static void octal12(char* p, std::uint64_t v) { std::snprintf(p, 12, "%011llo", static_cast<unsigned long long>(v)); }
+
+static void write_old_gnu(TarWriter& w, const Image& im) {
+  w.header("old.img", 'S', im.stored.size(), true, [&](char* h) {
+    for (std::size_t i = 0; i < std::min<std::size_t>(4, im.map.size()); ++i) {
+      octal12(h + 386 + i * 24, im.map[i].offset);
+      octal12(h + 386 + i * 24 + 12, im.map[i].size);
+    }
+    h[482] = im.map.size() > 4 ? 1 : 0;
+    octal12(h + 483, im.real_size);
+  });
+  for (std::size_t base = 4; base < im.map.size(); base += 21) {
+    char ext[512]{};
+    for (std::size_t i = 0; i < 21 && base + i < im.map.size(); ++i) {
+      octal12(ext + i * 24, im.map[base + i].offset);
+      octal12(ext + i * 24 + 12, im.map[base + i].size);
+    }
+    ext[504] = base + 21 < im.map.size() ? 1 : 0;
+    w.data(std::string(ext, sizeof(ext)));
+  }
+  w.data(im.stored);
+}
+
+static void write_pax_00(TarWriter& w, const Image& im) {
+  std::vector<std::pair<std::string, std::string>> kv{{"GNU.sparse.size", std::to_string(im.real_size)},
+                                                      {"GNU.sparse.numblocks", std::to_string(im.map.size())}};
+  for (const auto& x : im.map) {
+    kv.emplace_back("GNU.sparse.offset", std::to_string(x.offset));
+    kv.emplace_back("GNU.sparse.numbytes", std::to_string(x.size));
+  }
+  w.pax(kv);
+  w.header("p00.img", '0', im.stored.size(), false);
+  w.data(im.stored);
+}
+
+static void write_pax_01(TarWriter& w, const Image& im) {
+  std::string map;
+  for (const auto& x : im.map)
+    map += (map.empty() ? "" : ",") + std::to_string(x.offset) + "," + std::to_string(x.size);
+  w.pax({{"GNU.sparse.size", std::to_string(im.real_size)},
+         {"GNU.sparse.numblocks", std::to_string(im.map.size())},
+         {"GNU.sparse.name", "p01.img"},
+         {"GNU.sparse.map", map}});
+  w.header("GNUSparseFile.0/p01.img", '0', im.stored.size(), false);
+  w.data(im.stored);
+}
+
+static void write_pax_10(TarWriter& w, const Image& im) {
+  std::string map = std::to_string(im.map.size()) + "\n";
+  for (const auto& x : im.map) map += std::to_string(x.offset) + "\n" + std::to_string(x.size) + "\n";
+  map.append((512 - map.size() % 512) % 512, '\0');
+
+  w.pax({{"GNU.sparse.major", "1"},
+         {"GNU.sparse.minor", "0"},
+         {"GNU.sparse.name", "p10.img"},
+         {"GNU.sparse.realsize", std::to_string(im.real_size)}});
+  w.header("GNUSparseFile.0/p10.img", '0', map.size() + im.stored.size(), false);
+  w.data(map + im.stored);
+}
+
+static std::string read_all(brokkr::io::ByteSource& src) {
+  std::string out(static_cast<std::size_t>(src.size()), '\0');
+  std::size_t n = 0;
+  while (n < out.size()) {
+    const std::size_t step = std::min<std::size_t>(out.size() - n, 70001);
+    const std::size_t got = src.read({reinterpret_cast<std::byte*>(out.data() + n), step});
+    if (!got) break;
+    n += got;
+  }
+  out.resize(n);
+  return out;
+}
+
+static void test_formats(const std::filesystem::path& dir) {
+  const Image im = make_image(6 * 1048576 + 4321, 30);
+
+  TarWriter w;
+  write_old_gnu(w, im);
+  w.regular("after_old.txt", "hello");
+  write_pax_00(w, im);
+  write_pax_01(w, im);
+  write_pax_10(w, im);
+  w.regular("tail.txt", "bye");
+  const auto path = dir / "sparse.tar";
+  if (!w.save(path)) return fail_msg("formats", "cannot write archive");
+
+  auto tar = brokkr::io::TarArchive::open(path.string());
+  if (!tar) return fail_msg("formats", tar.error());
+
+  const std::vector<std::string> names{"old.img", "after_old.txt", "p00.img", "p01.img", "p10.img", "tail.txt"};
+  if (tar->entries().size() != names.size()) return fail_msg("formats", "wrong entry count");
+
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    const auto& e = tar->entries()[i];
+    const std::string label = "formats/" + names[i];
+    if (e.name != names[i]) return fail_msg(label.c_str(), "name " + e.name);
+
+    auto src = brokkr::io::open_tar_entry(path, e);
+    if (!src) return fail_msg(label.c_str(), src.error());
+    const std::string got = read_all(**src);
+
+    if (names[i].ends_with(".txt")) {
+      if (e.is_sparse() || got != (i == 1 ? "hello" : "bye")) return fail_msg(label.c_str(), "regular member broken");
+      continue;
+    }
+    if (!e.is_sparse() || e.size != im.real_size) return fail_msg(label.c_str(), "not recognised as sparse");
+    if (e.sparse.size() != im.map.size() + 1) return fail_msg(label.c_str(), "unexpected map length");
+    if (got != im.logical) return fail_msg(label.c_str(), "expanded content mismatch");
+  }
+  pass();
+}
+
+static void test_hole_queries(const std::filesystem::path& dir) {
+  const Image im = make_image(3 * 1048576, 2);
+
+  TarWriter w;
+  write_pax_01(w, im);
+  const auto path = dir / "holes.tar";
+  if (!w.save(path)) return fail_msg("holes", "cannot write archive");
+
+  auto tar = brokkr::io::TarArchive::open(path.string());
+  if (!tar || tar->entries().empty()) return fail_msg("holes", "open failed");
+
+  auto sp = brokkr::io::SparseTarEntrySource::open(path, tar->entries()[0]);
+  if (!sp) return fail_msg("holes", sp.error());
+  auto& s = **sp;
+
+  if (!s.hole_ahead(123)) return fail_msg("holes", "leading hole not reported");
+  if (s.hole_ahead(124)) return fail_msg("holes", "first extent missed");
+  s.skip(1048576);
+  if (!s.hole_ahead(123 * 2) || s.hole_ahead(123 * 2 + 1)) return fail_msg("holes", "second extent edge wrong");
+  s.skip(1048576);
+  if (!s.hole_ahead(1048576)) return fail_msg("holes", "trailing hole not reported");
+
+  std::string tail(1048576, 'x');
+  if (s.read({reinterpret_cast<std::byte*>(tail.data()), tail.size()}) != tail.size())
+    return fail_msg("holes", "short read in trailing hole");
+  if (tail.find_first_not_of('\0') != std::string::npos) return fail_msg("holes", "hole not zero-filled");
+  if (s.read({reinterpret_cast<std::byte*>(tail.data()), 1}) != 0) return fail_msg("holes", "read past end");
+  pass();
+}
+
+static void test_bad_map_rejected(const std::filesystem::path& dir) {
+  Image im = make_image(2 * 1048576, 2);
+  im.map[1].offset = im.map[0].offset + 10;
+
+  TarWriter w;
+  write_pax_01(w, im);
+  const auto path = dir / "bad.tar";
+  if (!w.save(path)) return fail_msg("bad_map", "cannot write archive");
+
+  if (brokkr::io::TarArchive::open(path.string())) return fail_msg("bad_map", "overlapping map accepted");
+  pass();
+}
+
+int main() {
+  const auto dir = std::filesystem::temp_directory_path() / "brokkr_test_tar_sparse";
+  std::filesystem::create_directories(dir);
+
+  test_formats(dir);
+  test_hole_queries(dir);
+  test_bad_map_rejected(dir);
+
+  std::filesystem::remove_all(dir);
+  std::printf("tar_sparse: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}
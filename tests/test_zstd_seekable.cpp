@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2026 Gabriel2392
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "io/source.hpp"
+#include "io/tar.hpp"
+#include "io/zstd_seekable.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(BROKKR_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+#include "third_party/xxhash/xxhash_vendor.h"
+
+namespace fs = std::filesystem;
+using brokkr::io::ZstdSeekableReader;
+using brokkr::io::ZstdSeekTable;
+
+static int g_pass = 0;
+static int g_fail = 0;
+
+static void fail_msg(const char* label, const std::string& msg) {
+  std::fprintf(stderr, "FAIL %s: %s\n", label, msg.c_str());
+  ++g_fail;
+}
+
+static void pass() { ++g_pass; }
+
+static void put_le32(std::string& out, std::uint32_t v) {
+  for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
+
+struct FrameDesc {
+  std::string compressed;
+  std::uint32_t d_size = 0;
+  std::uint32_t checksum = 0;
+};
+
+// Frames back to back, then the seek table in a skippable frame.
+static std::string seekable_file(const std::vector<FrameDesc>& frames, bool checksums) {
+  std::string out;
+  for (const auto& f : frames) out += f.compressed;
+
+  std::string table;
+  for (const auto& f : frames) {
+    put_le32(table, static_cast<std::uint32_t>(f.compressed.size()));
+    put_le32(table, f.d_size);
+    if (checksums) put_le32(table, f.checksum);
+  }
+  put_le32(table, static_cast<std::uint32_t>(frames.size()));
+  table.push_back(static_cast<char>(checksums ? 0x80 : 0));
+  put_le32(table, 0x8F92EAB1u);
+
+  put_le32(out, 0x184D2A5Eu);
+  put_le32(out, static_cast<std::uint32_t>(table.size()));
+  return out + table;
+}
+
+static bool save(const fs::path& p, const std::string& bytes) {
+  std::ofstream f(p, std::ios::binary | std::ios::trunc);
+  f.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  return static_cast<bool>(f);
+}
+
+static std::string tar_header(std::string_view name, std::uint64_t size) {
+  char h[512]{};
+  std::memcpy(h, name.data(), std::min<std::size_t>(name.size(), 100));
+  std::snprintf(h + 100, 8, "%07o", 0644);
+  std::snprintf(h + 108, 8, "%07o", 0);
+  std::snprintf(h + 116, 8, "%07o", 0);
+  std::snprintf(h + 124, 12, "%011llo", static_cast<unsigned long long>(size));
+  std::snprintf(h + 136, 12, "%011o", 0);
+  h[156] = '0';
+  std::memcpy(h + 257, "ustar\0" "00", 8);
+  std::memset(h + 148, ' ', 8);
+  unsigned sum = 0;
+  for (unsigned char c : h) sum += c;
+  std::snprintf(h + 148, 8, "%06o", sum);
+  return std::string(h, sizeof(h));
+}
+
+static void test_table_parse(const fs::path& dir) {
+  const char* label = "table_parse";
+  const fs::path p = dir / "fake.tar.zst";
+
+  // Payloads are never decoded here, so only the frame magic has to be real.
+  std::string first("\x28\xB5\x2F\xFD", 4);
+  first += std::string(96, 'x');
+  const std::vector<FrameDesc> frames{{first, 1000, 1}, {std::string(200, 'y'), 0, 2}, {std::string(50, 'z'), 3000, 3}};
+  if (!save(p, seekable_file(frames, true))) return fail_msg(label, "write failed");
+
+  if (!brokkr::io::is_seekable_zstd(p)) return fail_msg(label, "not detected as seekable zstd");
+
+  auto t = ZstdSeekTable::read(p);
+  if (!t) return fail_msg(label, t.error());
+  if (t->frames().size() != 3) return fail_msg(label, "frame count");
+  if (t->decompressed_size() != 4000 || t->max_frame_size() != 3000) return fail_msg(label, "sizes");
+  if (t->frames()[2].c_offset != 300 || t->frames()[2].d_offset != 1000) return fail_msg(label, "offsets");
+  if (t->frames()[1].checksum != 2u) return fail_msg(label, "checksum");
+  if (t->frame_at(0) != 0 || t->frame_at(999) != 0 || t->frame_at(1000) != 2 || t->frame_at(4000) != 3)
+    return fail_msg(label, "frame_at");
+
+  // Frame sizes that do not add up to where the table starts are rejected.
+  std::string bytes = seekable_file(frames, true);
+  bytes.insert(0, "extra");
+  if (!save(p, bytes)) return fail_msg(label, "write failed");
+  if (ZstdSeekTable::read(p)) return fail_msg(label, "mismatched table accepted");
+
+  const fs::path plain = dir / "plain.tar";
+  if (!save(plain, tar_header("a.img", 0) + std::string(1024, '\0'))) return fail_msg(label, "write failed");
+  if (brokkr::io::is_seekable_zstd(plain)) return fail_msg(label, "plain tar detected as zstd");
+  if (ZstdSeekTable::read(plain)) return fail_msg(label, "plain tar has a seek table");
+
+  pass();
+}
+
+#if defined(BROKKR_HAVE_ZSTD)
+
+static std::string pattern(std::size_t n, std::uint32_t seed) {
+  std::string s(n, '\0');
+  std::uint32_t x = seed;
+  for (auto& c : s) {
+    x = x * 1664525u + 1013904223u;
+    c = static_cast<char>((x >> 24) % 7 + 'a'); // compressible, not trivially so
+  }
+  return s;
+}
+
+static std::string compress_seekable(const std::string& data, std::size_t frame_bytes, bool checksums) {
+  std::vector<FrameDesc> frames;
+  for (std::size_t off = 0; off < data.size(); off += frame_bytes) {
+    const std::size_t n = std::min(frame_bytes, data.size() - off);
+    std::string c(ZSTD_compressBound(n), '\0');
+    const std::size_t got = ZSTD_compress(c.data(), c.size(), data.data() + off, n, 3);
+    c.resize(ZSTD_isError(got) ? 0 : got);
+    frames.push_back({c, static_cast<std::uint32_t>(n), static_cast<std::uint32_t>(XXH64(data.data() + off, n, 0))});
+  }
+  return seekable_file(frames, checksums);
+}
+
+struct Member {
+  std::string name;
+  std::string data;
+};
+
+static std::string make_tar(const std::vector<Member>& members) {
+  std::string out;
+  for (const auto& m : members) {
+    out += tar_header(m.name, m.data.size());
+    out += m.data;
+    out.append((512 - m.data.size() % 512) % 512, '\0');
+  }
+  out.append(1024, '\0');
+  return out;
+}
+
+static void test_tar_members(const fs::path& dir) {
+  const char* label = "tar_members";
+  const std::vector<Member> members{{"boot.img", pattern(70000, 1)},
+                                    {"download-list.txt", "boot.img\nsystem.img\n"},
+                                    {"system.img", pattern(300000, 2)}};
+  const fs::path p = dir / "AP.tar.zst";
+  if (!save(p, compress_seekable(make_tar(members), 16 * 1024, true))) return fail_msg(label, "write failed");
+
+  if (!brokkr::io::TarArchive::is_tar_file(p.string())) return fail_msg(label, "not recognised as tar");
+  auto tar = brokkr::io::TarArchive::open(p.string());
+  if (!tar) return fail_msg(label, tar.error());
+  if (tar->entries().size() != members.size()) return fail_msg(label, "entry count");
+
+  for (std::size_t i = 0; i < members.size(); ++i) {
+    const auto& e = tar->entries()[i];
+    if (e.name != members[i].name || e.size != members[i].data.size()) return fail_msg(label, "entry " + e.name);
+
+    auto src = brokkr::io::open_tar_entry(p, e);
+    if (!src) return fail_msg(label, src.error());
+
+    std::string got;
+    std::vector<std::byte> buf(4096 + 7 * i);
+    for (;;) {
+      const auto n = (*src)->read(buf);
+      if (!n) break;
+      got.append(reinterpret_cast<const char*>(buf.data()), n);
+    }
+    if (!(*src)->status()) return fail_msg(label, (*src)->status().error());
+    if (got != members[i].data) return fail_msg(label, "content of " + e.name);
+  }
+  pass();
+}
+
+static void test_random_access(const fs::path& dir) {
+  const char* label = "random_access";
+  const std::string data = pattern(500000, 3);
+  const fs::path p = dir / "blob.zst";
+  if (!save(p, compress_seekable(data, 10000, false))) return fail_msg(label, "write failed");
+
+  auto z = ZstdSeekableReader::open(p, 4);
+  if (!z) return fail_msg(label, z.error());
+  if ((*z)->size() != data.size() || (*z)->lanes() != 4) return fail_msg(label, "size or lanes");
+
+  const std::uint64_t offsets[] = {0, 9999, 10000, 123457, 499990, 250000, 5};
+  for (const auto off : offsets) {
+    if (!(*z)->seek(off)) return fail_msg(label, "seek");
+    std::vector<std::byte> buf(25000);
+    auto n = (*z)->read(buf);
+    if (!n) return fail_msg(label, n.error());
+    const auto want = std::min<std::size_t>(buf.size(), data.size() - off);
+    if (*n != want || std::memcmp(buf.data(), data.data() + off, want) != 0)
+      return fail_msg(label, "bytes at " + std::to_string(off));
+  }
+  if ((*z)->seek(data.size() + 1)) return fail_msg(label, "seek past end accepted");
+  pass();
+}
+
+static void test_checksum_mismatch(const fs::path& dir) {
+  const char* label = "checksum_mismatch";
+  const std::vector<Member> members{{"cache.img", pattern(40000, 4)}};
+  std::string bytes = compress_seekable(make_tar(members), 8192, true);
+
+  // Flip the checksum of the third frame: entries start after the 8-byte skippable header.
+  const std::size_t frames = (make_tar(members).size() + 8191) / 8192;
+  const std::size_t entry = bytes.size() - 9 - frames * 12 + 2 * 12 + 8;
+  bytes[entry] = static_cast<char>(bytes[entry] ^ 0x5A);
+
+  const fs::path p = dir / "bad.tar.zst";
+  if (!save(p, bytes)) return fail_msg(label, "write failed");
+
+  auto tar = brokkr::io::TarArchive::open(p.string());
+  if (!tar) return fail_msg(label, tar.error());
+  auto src = brokkr::io::open_tar_entry(p, tar->entries().at(0));
+  if (!src) return fail_msg(label, src.error());
+
+  std::vector<std::byte> buf(4096);
+  while ((*src)->read(buf)) {
+  }
+  if ((*src)->status()) return fail_msg(label, "corrupt frame read without error");
+  pass();
+}
+
+#else
+
+static void test_without_zstd(const fs::path& dir) {
+  const char* label = "without_zstd";
+  if (brokkr::io::zstd_decode_available()) return fail_msg(label, "decoder reported available");
+
+  std::string first("\x28\xB5\x2F\xFD", 4);
+  first += std::string(60, 'x');
+  const fs::path p = dir / "nozstd.tar.zst";
+  if (!save(p, seekable_file({{first, 512, 0}}, false))) return fail_msg(label, "write failed");
+
+  if (ZstdSeekableReader::open(p)) return fail_msg(label, "reader opened without zstd");
+  if (brokkr::io::TarArchive::open(p.string())) return fail_msg(label, "archive opened without zstd");
+  pass();
+}
+
+#endif
+
+int main() {
+  const fs::path dir = fs::temp_directory_path() / "brokkr_test_zstd_seekable";
+  std::error_code ec;
+  fs::remove_all(dir, ec);
+  fs::create_directories(dir);
+
+  test_table_parse(dir);
+#if defined(BROKKR_HAVE_ZSTD)
+  test_tar_members(dir);
+  test_random_access(dir);
+  test_checksum_mismatch(dir);
+#else
+  test_without_zstd(dir);
+#endif
+
+  fs::remove_all(dir, ec);
+  std::printf("zstd_seekable: %d passed, %d failed\n", g_pass, g_fail);
+  return g_fail ? 1 : 0;
+}